@@ -34,6 +34,7 @@ namespace ngcomp
     shared_ptr<BaseMatrix> inv_coarse;
     string inversetype;   //sparsecholesky or pardiso or ....
     string coarsetype;    //general precond.. (e.g. AMG)
+    int agglomeration = 0;  // ranks per group for the coarse solve, 0 .. master inverse
 
     BaseVector * tmp;
     BaseVector * tmp2;
@@ -63,6 +64,12 @@ namespace ngcomp
       hypre = ahypre;
 
       local = flags.GetDefineFlag("local");
+
+      string coarsesolver = flags.GetStringFlag("coarsesolver", "master");
+      if (coarsesolver == "agglomerate")
+        agglomeration = int(flags.GetNumFlag("coarsegroupsize", 64));
+      else if (coarsesolver != "master")
+        throw Exception ("BDDC: unknown coarsesolver '" + coarsesolver + "', use 'master' or 'agglomerate'");
       
       // pwbmat = NULL;
       inv = NULL;
@@ -393,7 +400,9 @@ namespace ngcomp
 	    {
 	      shared_ptr<ParallelDofs> pardofs = bfa->GetFESpace()->GetParallelDofs();
 
-	      pwbmat = make_shared<ParallelMatrix> (pwbmat, pardofs);
+	      auto parwbmat = make_shared<ParallelMatrix> (pwbmat, pardofs);
+	      parwbmat -> SetAgglomeration (agglomeration);
+	      pwbmat = parwbmat;
 	      pwbmat -> SetInverseType (inversetype);
 
 #ifdef HYPRE
@@ -99,7 +99,9 @@ namespace ngcomp
     precompute = flags.GetDefineFlag ("precompute");
     checksum = flags.GetDefineFlag ("checksum");
     spd = flags.GetDefineFlag ("spd");
+    compress_indices = flags.GetDefineFlag ("compress_indices");
     geom_free = flags.GetDefineFlag("geom_free");    
+    batch_assembly = flags.GetDefineFlag ("batch_assembly");
     if (spd) symmetric = true;
     SetCheckUnused (!flags.GetDefineFlagX("check_unused").IsFalse());
   }
@@ -154,6 +156,8 @@ namespace ngcomp
                      !flags.GetDefineFlag ("nokeep_internal"));
     if (flags.GetDefineFlag ("store_inner")) SetStoreInner (1);
     geom_free = flags.GetDefineFlag("geom_free");
+    compress_indices = flags.GetDefineFlag ("compress_indices");
+    batch_assembly = flags.GetDefineFlag ("batch_assembly");
     
     precompute = flags.GetDefineFlag ("precompute");
     checksum = flags.GetDefineFlag ("checksum");
@@ -559,6 +563,16 @@ namespace ngcomp
   }
 
 
+  // after assembling, the matrix-vector product reads the 16-bit column offsets only
+  static void CompressMatrixIndices (shared_ptr<BaseMatrix> mat)
+  {
+    if (auto pmat = dynamic_pointer_cast<ParallelMatrix> (mat))
+      mat = pmat->GetMatrix();
+    if (auto spmat = dynamic_pointer_cast<BaseSparseMatrix> (mat))
+      spmat->CompressColumnIndices();
+  }
+
+
 
 
 
@@ -686,6 +700,8 @@ namespace ngcomp
 
 
     DoAssemble(lh);
+    if (compress_indices)
+      CompressMatrixIndices (mats.Last());
 
 
     if (timing)
@@ -843,6 +859,8 @@ namespace ngcomp
 
     GetMatrix() = 0.0;
     DoAssemble(lh);
+    if (compress_indices)
+      CompressMatrixIndices (mats.Last());
 
     if (galerkin)
       GalerkinProjection();
@@ -963,6 +981,158 @@ namespace ngcomp
 
 
 
+  template <class SCAL>
+  void S_BilinearForm<SCAL> :: AssembleBatched (VorB vb, BitArray & batched,
+                                                Array<bool> & useddof, LocalHeap & clh)
+  {
+    static Timer t("Matrix assembling batched");
+    static Timer tclass("Matrix assembling batched, classify");
+    RegionTimer reg(t);
+    HeapReset hr(clh);
+
+    size_t ne = ma->GetNE(vb);
+    batched.SetSize (ne);
+    batched.Clear();
+
+    // static condensation and element matrix output stay element by element
+    if (printelmat || elmat_ev || eliminate_internal || eliminate_hidden) return;
+    if (vb != VOL || ma->GetDimension() < 2) return;
+    if (fespace->GetDimension() != 1 || fespace->VarOrder()) return;
+
+    Array<shared_ptr<SymbolicBilinearFormIntegrator>> sbfis;
+    for (auto & bfi : VB_parts[vb])
+      {
+        auto sbfi = dynamic_pointer_cast<SymbolicBilinearFormIntegrator> (bfi);
+        if (!sbfi) return;
+        sbfis.Append (sbfi);
+      }
+
+    // class = material index and vertex ordering of the simplex,
+    // all elements of one class share the same finite element
+    constexpr int maxclass = 24;
+    ELEMENT_TYPE simplex = (ma->GetDimension() == 2) ? ET_TRIG : ET_TET;
+    Array<int> classnr(ne);
+    tclass.Start();
+    ParallelFor (ne, [&] (size_t i)
+      {
+        ElementId ei(vb, i);
+        classnr[i] = -1;
+        if (!fespace->DefinedOn(ei)) return;
+        Ngs_Element ngel = ma->GetElement(ei);
+        if (ngel.GetType() != simplex) return;
+
+        bool has_integrator = false;
+        for (auto & bfi : sbfis)
+          if (bfi->DefinedOn (ngel.GetIndex()))
+            {
+              if (!bfi->DefinedOnElement (i)) return;
+              has_integrator = true;
+            }
+        if (!has_integrator) return;
+
+        classnr[i] = maxclass * ngel.GetIndex() +
+          SwitchET<ET_TRIG,ET_TET>
+          (simplex, [&ngel] (auto et) { return ET_trait<et.ElementType()>::GetClassNr(ngel.Vertices()); });
+      });
+    tclass.Stop();
+
+    int nclasses = 0;
+    for (int c : classnr)
+      nclasses = max2(nclasses, c+1);
+
+    // reference shapes are computed once per class
+    size_t nbfi = sbfis.Size();
+    FlatArray<const FiniteElement*> classfel(nclasses, clh);
+    FlatArray<FlatMatrix<>> refshapes(nclasses*nbfi, clh);
+    classfel = nullptr;
+    for (size_t i = 0; i < ne; i++)
+      {
+        int cl = classnr[i];
+        if (cl < 0 || classfel[cl]) continue;
+
+        ElementId ei(vb, i);
+        const FiniteElement & fel = fespace->GetFE (ei, clh);
+        bool supported = true;
+        for (auto & bfi : sbfis)
+          if (bfi->DefinedOn (ma->GetElIndex(ei)))
+            supported &= bfi->SupportsBatchAssembly (fel);
+
+        classfel[cl] = &fel;
+        for (size_t k = 0; k < nbfi; k++)
+          new (&refshapes[cl*nbfi+k])
+            FlatMatrix<> (supported ? sbfis[k]->CalcBatchShapes (fel, clh) : FlatMatrix<> (0, 0, nullptr));
+      }
+
+    auto batchable = [&] (int cl)
+      { return cl >= 0 && refshapes[cl*nbfi].Height() > 0; };
+
+    constexpr size_t W = SIMD<double>::Size();
+    for (FlatArray<int> els_of_col : fespace->ElementColoring(vb))
+      {
+        TableCreator<int> creator(nclasses);
+        for ( ; !creator.Done(); creator++)
+          for (int i : els_of_col)
+            if (batchable(classnr[i]))
+              creator.Add (classnr[i], i);
+        Table<int> classels = creator.MoveTable();
+
+        Array<FlatArray<int>> batches;
+        for (auto els : classels)
+          for (size_t first = 0; first < els.Size(); first += W)
+            batches.Append (els.Range(first, min(first+W, els.Size())));
+
+        ParallelForRange
+          (batches.Size(), [&] (IntRange r)
+           {
+             LocalHeap lh = clh.Split();
+             Array<DofId> dnums;
+             for (size_t b : r)
+               {
+                 HeapReset hr(lh);
+                 FlatArray<int> els = batches[b];
+                 int cl = classnr[els[0]];
+                 const FiniteElement & fel = *classfel[cl];
+                 size_t ndof = fel.GetNDof();
+                 int index = ma->GetElIndex (ElementId(vb, els[0]));
+
+                 FlatArray<const ElementTransformation*> trafos(els.Size(), lh);
+                 for (size_t i : Range(els))
+                   trafos[i] = &ma->GetTrafo (ElementId(vb, els[i]), lh);
+
+                 FlatMatrix<SIMD<double>> elmats(ndof, ndof, lh);
+                 elmats = SIMD<double>(0.0);
+                 for (size_t k : Range(nbfi))
+                   if (sbfis[k]->DefinedOn (index))
+                     sbfis[k]->CalcElementMatrixBatchAdd (fel, refshapes[cl*nbfi+k], trafos, elmats, lh);
+
+                 FlatMatrix<SCAL> sum_elmat(ndof, lh);
+                 for (size_t i : Range(els))
+                   {
+                     ElementId ei(vb, els[i]);
+                     fespace->GetDofNrs (ei, dnums);
+                     for (size_t j = 0; j < ndof; j++)
+                       for (size_t k = 0; k < ndof; k++)
+                         sum_elmat(j,k) = elmats(j,k)[i];
+
+                     fespace->TransformMat (ei, sum_elmat, TRANSFORM_MAT_LEFT_RIGHT);
+                     AddElementMatrix (dnums, dnums, sum_elmat, ei, lh);
+                     for (auto pre : preconditioners)
+                       pre -> AddElementMatrix (dnums, sum_elmat, ei, lh);
+
+                     if (check_unused)
+                       for (auto d : dnums)
+                         if (IsRegularDof(d)) useddof[d] = true;
+                   }
+               }
+           });
+
+        for (auto els : batches)
+          for (int i : els)
+            batched.SetBit (i);
+      }
+  }
+
+
   template <class SCAL>
   void S_BilinearForm<SCAL> :: DoAssemble (LocalHeap & clh)
   {
@@ -975,12 +1145,8 @@ namespace ngcomp
                                    Timer("Matrix assembling bound"),
                                    Timer("Matrix assembling co dim 2") };
     
-    static mutex addelemfacbnd_mutex;
-    static mutex addelemfacin_mutex;
     static mutex printelmat_mutex;
-    static mutex printmatasstatus2_mutex;
     static mutex printmatspecel_mutex;
-    static mutex printmatspecel2_mutex;
 
     RegionTimer reg (mattimer);
 
@@ -1043,6 +1209,9 @@ namespace ngcomp
             
 	    if (facetwise_skeleton_parts[BND].Size())
 	      loopsteps += ma->GetNSE();
+
+	    if (elementwise_skeleton_parts.Size())
+	      loopsteps += ma->GetNE(VOL);
             
 	    if (specialelements.Size())
 	      loopsteps += specialelements.Size(); 
@@ -1152,6 +1321,10 @@ namespace ngcomp
                           innermatrix = make_shared<ElementByElementMatrix<SCAL>>(ndof, ne);
                       }
                     */
+                    BitArray batched;
+                    if (batch_assembly && vb == VOL)
+                      AssembleBatched (vb, batched, useddof, clh);
+
                     IterateElements
                       (*fespace, vb, clh,  [&] (FESpace::Element el, LocalHeap & lh)
                        {
@@ -1159,6 +1332,7 @@ namespace ngcomp
                            *testout << " Assemble Element " << el.Nr() << endl;  
                          
                          progress.Update ();
+                         if (batched.Size() && batched.Test(el.Nr())) return;
 			 
                          const FiniteElement & fel = fespace->GetFE (el, lh);
                          const ElementTransformation & eltrans = ma->GetTrafo (el, lh);
@@ -1901,16 +2075,18 @@ namespace ngcomp
             // if (has_element_wise)
             if (elementwise_skeleton_parts.Size())
               {
-                int cnt = 0;
-                int ne = ma->GetNE(VOL);
+                ProgressOutput progress (ma, "assemble inner facet element", ma->GetNE(VOL));
+                // elements of one color and their neighbours share no dofs
+                for (FlatArray<int> els_of_col : fespace->ElementSkeletonColoring())
                 ParallelForRange
-                  (IntRange(ne), [&] ( IntRange r )
+                  (IntRange(els_of_col.Size()), [&] ( IntRange r )
                    {
                      LocalHeap lh = clh.Split();
                      
                      Array<int> dnums, dnums1, dnums2, elnums, elnums_per, fnums1, fnums2, vnums1, vnums2;
-                     for (int el1 : r)
+                     for (int el1 : els_of_col.Range(r.First(), r.Next()))
                        {
+                         progress.Update();
                          ElementId ei1(VOL, el1);
                          fnums1 = ma->GetElFacets(ei1);
                          for (int facnr1 : Range(fnums1))
@@ -1989,10 +2165,7 @@ namespace ngcomp
                                          (*testout) << "elmat = " << endl << elmat << endl;
                                        }
                                      
-                                     {
-                                       lock_guard<mutex> guard(addelemfacbnd_mutex);
-                                       AddElementMatrix (dnums, dnums, elmat, ElementId(VOL,el1), lh);
-                                     }
+                                     AddElementMatrix (dnums, dnums, elmat, ElementId(VOL,el1), lh);
                                    } //end for (numintegrators)
                                  continue;
                                } // end if boundary facet
@@ -2004,15 +2177,6 @@ namespace ngcomp
                              fnums2 = ma->GetElFacets(ei2);
                              int facnr2 = fnums2.Pos(facet2);
                              
-                             {
-                               lock_guard<mutex> guard(printmatasstatus2_mutex);
-                               cnt++;
-                               gcnt++;
-                               if (cnt % 10 == 0)
-                                 cout << IM(3) << "\rassemble inner facet element " << cnt << "/" << nf << flush;
-                               ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
-                             }
-                             
                              const FiniteElement & fel1 = fespace->GetFE (ei1, lh);
                              const FiniteElement & fel2 = fespace->GetFE (ei2, lh);
                              
@@ -2160,40 +2324,32 @@ namespace ngcomp
                                        for (int dj = 0; dj < dim; ++dj)
                                          compressed_elmat(dim*dnums_to_compressed[i]+di,dim*dnums_to_compressed[j]+dj) += elmat(i*dim+di,j*dim+dj);
 
-                                 {
-                                   lock_guard<mutex> guard(addelemfacin_mutex);
-                                   AddElementMatrix (compressed_dnums, compressed_dnums, compressed_elmat,
-                                                     ElementId(BND,el1), lh);
-                                 }
+                                 AddElementMatrix (compressed_dnums, compressed_dnums, compressed_elmat,
+                                                   ElementId(BND,el1), lh);
                                }
                            }
                        }                             
                    });
-                cout << IM(3) << "\rassemble inner facet element " << nf << "/" << nf << endl;
+                progress.Done();
+                gcnt += ma->GetNE(VOL);
               } // if (elementwise_skeleton_parts.Size())
                 
             if (facetwise_skeleton_parts[BND].Size())
               {
                 // cout << "check bnd" << endl;
-                int cnt = 0;
                 int ne = ma->GetNE(BND);
+                ProgressOutput progress (ma, "assemble facet surface element", ne);
+                // surface elements of one color have volume neighbours without common dofs
+                for (FlatArray<int> els_of_col : fespace->BoundaryFacetColoring())
                 ParallelForRange
-                  ( IntRange(ne), [&] ( IntRange r )
+                  ( IntRange(els_of_col.Size()), [&] ( IntRange r )
                     {
                       LocalHeap lh = clh.Split();
                       Array<int> fnums, elnums, vnums, svnums, dnums;
                       
-                      for (int i : r)
+                      for (int i : els_of_col.Range(r.First(), r.Next()))
                         {
-                          {
-                            lock_guard<mutex> guard(printmatasstatus2_mutex);
-                            cnt++;
-                            gcnt++;
-                            // if (cnt % 10 == 0)
-                              // cout << "\rassemble facet surface element " << cnt << "/" << ne << flush;
-                            ma->SetThreadPercentage ( 100.0*(gcnt) / (loopsteps) );
-                          }
-                          
+                          progress.Update();
                           HeapReset hr(lh);
                           ElementId sei(BND, i);
                               
@@ -2283,13 +2439,12 @@ namespace ngcomp
                               //                    for(int k=0; k<elmat.Height(); k++)
                               //                      if(fabs(elmat(k,k)) < 1e-7 && dnums[k] != -1)
                               //                        cout << "dnums " << dnums << " elmat " << elmat << endl; 
-                              {
-                                lock_guard<mutex> guard(addelemfacbnd_mutex);
-                                AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
-                              }
+                              AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
                             }//end for (numintegrators)
                         }//end for nse                  
                     });//end of parallel
+                progress.Done();
+                gcnt += ne;
                 // cout << "\rassemble facet surface element " << ne << "/" << ne << endl;  
               } // if facetwise_skeleton_parts[BND].size
             
@@ -2311,12 +2466,23 @@ namespace ngcomp
             
             
             int nspecel = 0;
-            ParallelForRange( IntRange(specialelements.Size()), [&] ( IntRange r )
+            Table<int> specel_coloring = ComputeColoring
+              (specialelements.Size(), ndof,
+               [&] (size_t i, Array<DofId> & dnums)
+               {
+                 specialelements[i]->GetDofNrs (dnums);
+                 for (int j = dnums.Size()-1; j >= 0; j--)
+                   if (!IsRegularDof(dnums[j])) dnums.DeleteElement(j);
+                 return true;
+               });
+
+            for (FlatArray<int> els_of_col : specel_coloring)
+            ParallelForRange( IntRange(els_of_col.Size()), [&] ( IntRange r )
                               {
               LocalHeap lh = clh.Split();
               Array<int> dnums;
               
-              for (int i : r)
+              for (int i : els_of_col.Range(r.First(), r.Next()))
                 {
                   {
                     lock_guard<mutex> guard(printmatspecel_mutex);
@@ -2334,15 +2500,12 @@ namespace ngcomp
                   FlatMatrix<SCAL> elmat(dnums.Size(), lh);
                   el.CalcElementMatrix (elmat, lh);
                   
-                  {
-                    lock_guard<mutex> guard(printmatspecel2_mutex);
-                    if (check_unused)
-                      for (int j = 0; j < dnums.Size(); j++)
-                        if (IsRegularDof(dnums[j]))
-                          useddof[dnums[j]] = true;
+                  if (check_unused)
+                    for (int j = 0; j < dnums.Size(); j++)
+                      if (IsRegularDof(dnums[j]))
+                        useddof[dnums[j]] = true;
                     
-                    AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
-                  }
+                  AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
                   
                   assembledspecialelements = true;
                   lh.CleanUp();
@@ -3148,13 +3311,14 @@ namespace ngcomp
             
             ProgressOutput progress (ma, "assemble skeleton element", ne);
             
+            for (FlatArray<int> els_of_col : fespace->BoundaryFacetColoring())
             ParallelForRange
-              ( IntRange(ne), [&] ( IntRange r )
+              ( IntRange(els_of_col.Size()), [&] ( IntRange r )
                 {
                   LocalHeap lh = clh.Split();
                   Array<int> fnums, elnums, vnums, svnums, dnums;
                   
-                  for (int i : r)
+                  for (int i : els_of_col.Range(r.First(), r.Next()))
                     {
                       progress.Update();                      
                       HeapReset hr(lh);
@@ -3248,10 +3412,7 @@ namespace ngcomp
                           //                    for(int k=0; k<elmat.Height(); k++)
                           //                      if(fabs(elmat(k,k)) < 1e-7 && dnums[k] != -1)
                           //                        cout << "dnums " << dnums << " elmat " << elmat << endl; 
-                          {
-                            lock_guard<mutex> guard(addelmatboundary1_mutex);                            
-                            AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
-                          }
+                          AddElementMatrix (dnums, dnums, elmat, ElementId(BND,i), lh);
                         }//end for (numintegrators)
                     }//end for nse                  
                 });//end of parallel
@@ -44,6 +44,10 @@ namespace ngcomp
     bool symmetric;
     /// bilinear form is symmetric and positive definite (experimental)
     bool spd;
+    /// store column indices of the matrix graph as 16-bit offsets
+    bool compress_indices = false;
+    /// assemble element matrices of equal elements in SIMD batches
+    bool batch_assembly = false;
     /// add epsilon for regularization
     double eps_regularization; 
     /// diagonal value for unused dofs
@@ -556,6 +560,8 @@ namespace ngcomp
 
     ///
     virtual void DoAssemble (LocalHeap & lh);
+    /// element matrices of equal elements in SIMD batches, marks batched elements
+    void AssembleBatched (VorB vb, BitArray & batched, Array<bool> & useddof, LocalHeap & lh);
     ///
     // virtual void DoAssembleIndependent (BitArray & useddof, LocalHeap & lh);
     ///
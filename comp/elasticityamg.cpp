@@ -0,0 +1,460 @@
+#include <elasticityamg.hpp>
+
+#include <comp.hpp>
+using namespace ngcomp;
+
+
+namespace ngcomp
+{
+
+  ElasticityAMG_Matrix :: ElasticityAMG_Matrix (shared_ptr<SparseMatrixTM<double>> amat,
+                                                shared_ptr<BitArray> freedofs,
+                                                Table<int> && nodes,
+                                                Matrix<double> && nullspace,
+                                                size_t level, double theta,
+                                                bool chebyshev)
+    : mat(amat)
+  {
+    static Timer t("ElasticityAMG"); RegionTimer reg(t);
+    static Timer tgraph("ElasticityAMG - strength graph");
+    static Timer tagg("ElasticityAMG - aggregation");
+    static Timer tprol("ElasticityAMG - prolongation");
+
+    size = mat->Height();
+    size_t num_nodes = nodes.Size();
+    size_t nmodes = nullspace.Width();
+
+    cout << IM(3) << "ElasticityAMG: level = " << level << ", ndof = " << size
+         << ", num_nodes = " << num_nodes << endl;
+
+    auto isfree = [&freedofs] (size_t dof) { return !freedofs || freedofs->Test(dof); };
+
+    // symmetric matrices store the lower triangle only, visit every entry of the full matrix
+    bool symmetric = dynamic_cast<SparseMatrixSymmetric<double>*> (mat.get()) != nullptr;
+    auto IterateEntries = [&] (auto func)
+      {
+        for (size_t r = 0; r < size; r++)
+          {
+            auto cols = mat->GetRowIndices(r);
+            auto vals = mat->GetRowValues(r);
+            for (size_t k = 0; k < cols.Size(); k++)
+              {
+                func (r, size_t(cols[k]), vals[k]);
+                if (symmetric && size_t(cols[k]) != r)
+                  func (size_t(cols[k]), r, vals[k]);
+              }
+          }
+      };
+
+    Array<int> dof2node(size);
+    dof2node = -1;
+    for (auto i : Range(num_nodes))
+      for (auto d : nodes[i])
+        if (isfree(d))
+          dof2node[d] = i;
+
+
+    // node graph with block-norms || A_ij ||_F^2
+    tgraph.Start();
+    TableCreator<int> graph_creator(num_nodes);
+    for ( ; !graph_creator.Done(); graph_creator++)
+      IterateEntries ([&] (size_t r, size_t c, double val)
+                      {
+                        int ni = dof2node[r], nj = dof2node[c];
+                        if (ni != -1 && nj != -1 && ni != nj)
+                          graph_creator.Add (ni, nj);
+                      });
+    Table<int> graph_dup = graph_creator.MoveTable();
+
+    ParallelFor (num_nodes, [&] (size_t i) { QuickSort (graph_dup[i]); });
+
+    TableCreator<int> ugraph_creator(num_nodes);
+    for ( ; !ugraph_creator.Done(); ugraph_creator++)
+      for (auto i : Range(num_nodes))
+        {
+          auto row = graph_dup[i];
+          for (size_t k = 0; k < row.Size(); k++)
+            if (k == 0 || row[k] != row[k-1])
+              ugraph_creator.Add (i, row[k]);
+        }
+    Table<int> graph = ugraph_creator.MoveTable();
+    graph_dup = Table<int>();
+
+    Array<int> cnt(num_nodes);
+    for (auto i : Range(num_nodes))
+      cnt[i] = graph[i].Size();
+    Table<double> blocknorm(cnt);
+    for (auto i : Range(num_nodes))
+      blocknorm[i] = 0.0;
+    Array<double> diagnorm(num_nodes);
+    diagnorm = 0.0;
+
+    IterateEntries ([&] (size_t r, size_t c, double val)
+                    {
+                      int ni = dof2node[r], nj = dof2node[c];
+                      if (ni == -1 || nj == -1) return;
+                      if (ni == nj)
+                        diagnorm[ni] += val*val;
+                      else
+                        {
+                          auto row = graph[ni];
+                          size_t pos = std::lower_bound (row.Data(), row.Data()+row.Size(), nj) - row.Data();
+                          blocknorm[ni][pos] += val*val;
+                        }
+                    });
+
+    // strongly coupled: || A_ij || >= theta * sqrt (|| A_ii || || A_jj ||)
+    TableCreator<int> strong_creator(num_nodes);
+    for ( ; !strong_creator.Done(); strong_creator++)
+      ParallelFor (num_nodes, [&] (size_t i)
+                   {
+                     auto row = graph[i];
+                     for (size_t k = 0; k < row.Size(); k++)
+                       if (blocknorm[i][k] >= sqr(theta) * sqrt (diagnorm[i]*diagnorm[row[k]]))
+                         strong_creator.Add (i, row[k]);
+                   });
+    Table<int> strong = strong_creator.MoveTable();
+    tgraph.Stop();
+
+
+    // greedy aggregation in three phases
+    tagg.Start();
+    Array<int> node2agg(num_nodes);
+    node2agg = -1;
+    size_t num_aggs = 0;
+
+    // phase 1: nodes with all strong neighbours free seed an aggregate
+    for (auto i : Range(num_nodes))
+      {
+        if (node2agg[i] != -1 || strong[i].Size() == 0) continue;
+        bool allfree = true;
+        for (auto j : strong[i])
+          if (node2agg[j] != -1) allfree = false;
+        if (!allfree) continue;
+
+        node2agg[i] = num_aggs;
+        for (auto j : strong[i])
+          node2agg[j] = num_aggs;
+        num_aggs++;
+      }
+
+    // phase 2: attach remaining nodes to the strongest aggregated neighbour
+    Array<int> node2agg1 (node2agg);
+    for (auto i : Range(num_nodes))
+      {
+        if (node2agg[i] != -1) continue;
+        double maxstrength = 0;
+        auto row = graph[i];
+        for (size_t k = 0; k < row.Size(); k++)
+          if (node2agg1[row[k]] != -1 && blocknorm[i][k] > maxstrength &&
+              blocknorm[i][k] >= sqr(theta) * sqrt (diagnorm[i]*diagnorm[row[k]]))
+            {
+              maxstrength = blocknorm[i][k];
+              node2agg[i] = node2agg1[row[k]];
+            }
+      }
+
+    // phase 3: leftovers form aggregates of their own
+    for (auto i : Range(num_nodes))
+      {
+        if (node2agg[i] != -1 || strong[i].Size() == 0) continue;
+        node2agg[i] = num_aggs;
+        for (auto j : strong[i])
+          if (node2agg[j] == -1)
+            node2agg[j] = num_aggs;
+        num_aggs++;
+      }
+    tagg.Stop();
+
+    TableCreator<int> agg_creator(num_aggs);
+    for ( ; !agg_creator.Done(); agg_creator++)
+      for (auto i : Range(num_nodes))
+        if (node2agg[i] != -1)
+          for (auto d : nodes[i])
+            if (isfree(d))
+              agg_creator.Add (node2agg[i], d);
+    Table<int> aggdofs = agg_creator.MoveTable();
+
+
+    // build smoother on node blocks, dofs outside of nodes are single blocks
+    TableCreator<int> smoothing_blocks_creator;
+    for ( ; !smoothing_blocks_creator.Done(); smoothing_blocks_creator++)
+      {
+        size_t nr = 0;
+        for (auto i : Range(num_nodes))
+          {
+            bool any = false;
+            for (auto d : nodes[i])
+              if (isfree(d))
+                {
+                  smoothing_blocks_creator.Add (nr, d);
+                  any = true;
+                }
+            if (any) nr++;
+          }
+        for (auto d : Range(size))
+          if (dof2node[d] == -1 && isfree(d))
+            smoothing_blocks_creator.Add (nr++, d);
+      }
+    auto blocks = make_shared<Table<int>> (smoothing_blocks_creator.MoveTable());
+    smoother = mat->CreateBlockJacobiPrecond(blocks);
+    if (chebyshev)
+      chebsmoother = make_shared<ChebyshevJacobi> (mat, smoother);
+
+
+    // tentative prolongation: QR-factorization of the nullspace on each aggregate
+    tprol.Start();
+    Array<Matrix<double>> qs(num_aggs), rs(num_aggs);
+    Array<int> rank(num_aggs);
+    ParallelFor (num_aggs, [&] (size_t a)
+                 {
+                   auto dofs = aggdofs[a];
+                   Matrix<double> q(dofs.Size(), nmodes);
+                   Matrix<double> r(nmodes, nmodes);
+                   r = 0.0;
+                   for (auto k : Range(dofs))
+                     q.Row(k) = nullspace.Row(dofs[k]);
+
+                   // modified Gram-Schmidt with re-orthogonalization, drops dependent modes
+                   int cnt = 0;
+                   for (size_t j = 0; j < nmodes; j++)
+                     {
+                       Vector<double> v = q.Col(j);
+                       double norm0 = L2Norm(v);
+                       for (int pass = 0; pass < 2; pass++)
+                         for (int k = 0; k < cnt; k++)
+                           {
+                             double h = InnerProduct (q.Col(k), v);
+                             r(k,j) += h;
+                             v -= h * q.Col(k);
+                           }
+                       double norm = L2Norm(v);
+                       if (norm > 1e-8 * norm0)
+                         {
+                           q.Col(cnt) = (1/norm) * v;
+                           r(cnt,j) = norm;
+                           cnt++;
+                         }
+                     }
+                   rank[a] = cnt;
+                   qs[a] = move(q);
+                   rs[a] = move(r);
+                 });
+
+    Array<int> firstcdof(num_aggs+1);
+    firstcdof[0] = 0;
+    for (auto a : Range(num_aggs))
+      firstcdof[a+1] = firstcdof[a] + rank[a];
+    size_t num_coarse = firstcdof[num_aggs];
+
+    Array<int> nne(size);
+    nne = 0;
+    for (auto a : Range(num_aggs))
+      for (auto d : aggdofs[a])
+        nne[d] = rank[a];
+
+    auto tentprol = make_shared<SparseMatrix<double>> (nne, num_coarse);
+    ParallelFor (num_aggs, [&] (size_t a)
+                 {
+                   auto dofs = aggdofs[a];
+                   for (auto k : Range(dofs))
+                     for (int j = 0; j < rank[a]; j++)
+                       (*tentprol)(dofs[k], firstcdof[a]+j) = qs[a](k,j);
+                 });
+
+    Matrix<double> coarse_nullspace(num_coarse, nmodes);
+    TableCreator<int> coarse_nodes_creator(num_aggs);
+    for ( ; !coarse_nodes_creator.Done(); coarse_nodes_creator++)
+      for (auto a : Range(num_aggs))
+        for (int j = 0; j < rank[a]; j++)
+          coarse_nodes_creator.Add (a, firstcdof[a]+j);
+    for (auto a : Range(num_aggs))
+      for (int j = 0; j < rank[a]; j++)
+        coarse_nullspace.Row(firstcdof[a]+j) = rs[a].Row(j);
+    qs = Array<Matrix<double>>();
+    rs = Array<Matrix<double>>();
+
+
+    // smoothed prolongation P = (I - omega D^-1 A) P_tent, omega = 4/3 / lambda_max(D^-1 A)
+    auto jacobi = mat->CreateJacobiPrecond(freedofs);
+    EigenSystem eigen (*mat, *jacobi);
+    eigen.SetMaxSteps (10);
+    eigen.SetPrecision (1e-2);
+    eigen.Calc();
+    double omega = 4.0/3.0 / (1.1 * eigen.MaxEigenValue());
+
+    const SparseMatrixTM<double> & cmat = *mat;
+    Array<double> diag(size);
+    for (auto i : Range(size))
+      diag[i] = isfree(i) ? cmat(i,i) : 0;
+
+    nne = 0;
+    IterateEntries ([&] (size_t r, size_t c, double val)
+                    {
+                      if (isfree(r) && isfree(c)) nne[r]++;
+                    });
+    auto smoothmat = make_shared<SparseMatrix<double>> (nne, size);
+    IterateEntries ([&] (size_t r, size_t c, double val)
+                    {
+                      if (isfree(r) && isfree(c))
+                        (*smoothmat)(r,c) = -omega * val / diag[r];
+                    });
+    for (auto i : Range(size))
+      if (isfree(i))
+        (*smoothmat)(i,i) += 1;
+
+    prolongation = MatMult (*smoothmat, *tentprol);
+    restriction = TransposeMatrix (*prolongation);
+    tprol.Stop();
+
+    auto coarsemat = mat -> Restrict (*prolongation);
+
+    auto coarse_freedofs = make_shared<BitArray> (num_coarse);
+    coarse_freedofs->Set();
+
+    if (num_coarse < 100 || num_coarse > 0.8 * size)
+      {
+        coarsemat->SetInverseType(SPARSECHOLESKY);
+        coarse_precond = coarsemat->InverseMatrix(coarse_freedofs);
+      }
+    else
+      coarse_precond = make_shared<ElasticityAMG_Matrix> (dynamic_pointer_cast<SparseMatrixTM<double>> (coarsemat),
+                                                          coarse_freedofs,
+                                                          coarse_nodes_creator.MoveTable(),
+                                                          move(coarse_nullspace),
+                                                          level+1, theta, chebyshev);
+  }
+
+
+  void ElasticityAMG_Matrix :: Mult (const BaseVector & b, BaseVector & x) const
+  {
+    static Timer t("ElasticityAMG::Mult"); RegionTimer reg(t);
+    x = 0;
+
+    if (chebsmoother)
+      chebsmoother->Smooth(x, b, smoothing_steps);
+    else
+      smoother->GSSmooth(x, b, smoothing_steps);
+    auto residuum = b.CreateVector();
+    residuum = b - (*mat) * x;
+
+    auto coarse_residuum = coarse_precond->CreateColVector();
+    auto coarse_x = coarse_precond->CreateColVector();
+
+    coarse_residuum = *restriction * residuum;
+    coarse_precond->Mult(coarse_residuum, coarse_x);
+
+    x += *prolongation * coarse_x;
+    if (chebsmoother)
+      chebsmoother->Smooth(x, b, smoothing_steps);
+    else
+      smoother->GSSmoothBack (x, b, smoothing_steps);
+  }
+
+
+  /*
+    Preconditioner for VectorH1 spaces, the near-nullspace is spanned by
+    the rigid body modes evaluated at the mesh vertices.
+    Dofs not located at vertices (higher order) are only smoothed.
+   */
+  class ElasticityAMG_Preconditioner : public Preconditioner
+  {
+    shared_ptr<BilinearForm> bfa;
+    shared_ptr<BitArray> freedofs;
+    shared_ptr<ElasticityAMG_Matrix> mat;
+
+  public:
+
+    ElasticityAMG_Preconditioner (shared_ptr<BilinearForm> abfa, const Flags & aflags,
+                                  const string aname = "ElasticityAMG_cprecond")
+      : Preconditioner (abfa, aflags, aname), bfa(abfa)
+    {
+      cout << IM(5) << "Create ElasticityAMG" << endl;
+      if (!dynamic_pointer_cast<VectorH1FESpace> (bfa->GetFESpace()))
+        throw Exception ("ElasticityAMG needs a VectorH1 space, got "
+                         + bfa->GetFESpace()->GetClassName());
+    }
+
+    ElasticityAMG_Preconditioner (const PDE & pde, const Flags & aflags, const string & aname)
+      : ElasticityAMG_Preconditioner (pde.GetBilinearForm (aflags.GetStringFlag ("bilinearform")),
+                                      aflags, aname)
+    { ; }
+
+
+    virtual void InitLevel (shared_ptr<BitArray> _freedofs) override
+    {
+      freedofs = _freedofs;
+    }
+
+    virtual void FinalizeLevel (const BaseMatrix * matrix) override
+    {
+      auto smat = dynamic_pointer_cast<SparseMatrixTM<double>> (const_cast<BaseMatrix*>(matrix)->shared_from_this());
+      if (!smat)
+        throw Exception ("ElasticityAMG needs a real sparse matrix");
+
+      auto fes = bfa->GetFESpace();
+      auto ma = fes->GetMeshAccess();
+      int dim = ma->GetDimension();
+      size_t nmodes = (dim == 3) ? 6 : 3;
+      size_t nv = ma->GetNV();
+
+      TableCreator<int> nodes_creator(nv);
+      Array<DofId> dnums;
+      for ( ; !nodes_creator.Done(); nodes_creator++)
+        for (auto v : Range(nv))
+          {
+            fes->GetDofNrs (NodeId(NT_VERTEX, v), dnums);
+            for (auto d : dnums)
+              if (IsRegularDof(d))
+                nodes_creator.Add (v, d);
+          }
+      Table<int> nodes = nodes_creator.MoveTable();
+
+      // rigid body modes: translations, then rotations
+      Matrix<double> nullspace(smat->Height(), nmodes);
+      nullspace = 0.0;
+      for (auto v : Range(nv))
+        {
+          auto dofs = nodes[v];
+          if (dofs.Size() != size_t(dim)) continue;
+          Vec<3> p = ma->GetPoint<3> (v);
+          for (int c = 0; c < dim; c++)
+            nullspace(dofs[c], c) = 1;
+          if (dim == 3)
+            {
+              nullspace(dofs[0], 3) = -p(1);  nullspace(dofs[1], 3) = p(0);
+              nullspace(dofs[1], 4) = -p(2);  nullspace(dofs[2], 4) = p(1);
+              nullspace(dofs[2], 5) = -p(0);  nullspace(dofs[0], 5) = p(2);
+            }
+          else
+            {
+              nullspace(dofs[0], 2) = -p(1);  nullspace(dofs[1], 2) = p(0);
+            }
+        }
+
+      bool chebyshev = flags.GetStringFlag ("smoother", "gs") == "chebyshev";
+      double theta = flags.GetNumFlag ("theta", 0.08);
+      mat = make_shared<ElasticityAMG_Matrix> (smat, freedofs, move(nodes), move(nullspace), 0,
+                                               theta, chebyshev);
+    }
+
+    virtual void Update () override { ; }
+
+    virtual const BaseMatrix & GetAMatrix() const override
+    {
+      return bfa->GetMatrix();
+    }
+
+    virtual const BaseMatrix & GetMatrix() const override
+    {
+      if (!mat)
+        ThrowPreconditionerNotReady();
+      return *mat;
+    }
+
+    virtual const char * ClassName() const override
+    { return "ElasticityAMG Preconditioner"; }
+  };
+
+  static RegisterPreconditioner<ElasticityAMG_Preconditioner> initpre ("elasticityamg");
+}
@@ -0,0 +1,47 @@
+#ifndef ELASTICITYAMG_HPP_
+#define ELASTICITYAMG_HPP_
+
+#include <comp.hpp>
+
+namespace ngcomp
+{
+  /*
+    Smoothed aggregation AMG for vector valued problems.
+
+    The near-nullspace (rigid body modes on the finest level) is
+    given as a dense matrix with one column per mode. Nodes group the
+    dofs belonging together (the components of a vertex), aggregates
+    are formed from strongly coupled nodes, and the tentative
+    prolongation is obtained by QR factorization of the nullspace
+    restricted to the aggregates.
+   */
+  class NGS_DLL_HEADER ElasticityAMG_Matrix : public ngla::BaseMatrix
+  {
+    size_t size;
+    std::shared_ptr<ngla::SparseMatrixTM<double>> mat;
+    std::shared_ptr<ngla::BaseBlockJacobiPrecond> smoother;
+    std::shared_ptr<ngla::ChebyshevJacobi> chebsmoother;
+    std::shared_ptr<ngla::SparseMatrixTM<double>> prolongation, restriction;
+    std::shared_ptr<ngla::BaseMatrix> coarse_precond;
+    int smoothing_steps = 1;
+
+  public:
+    /// nodes ... dofs of a node, nullspace ... size x nmodes
+    ElasticityAMG_Matrix (std::shared_ptr<ngla::SparseMatrixTM<double>> amat,
+                          std::shared_ptr<ngcore::BitArray> freedofs,
+                          ngcore::Table<int> && nodes,
+                          ngbla::Matrix<double> && nullspace,
+                          size_t level, double theta = 0.08,
+                          bool chebyshev = false);
+
+    virtual int VHeight() const override { return size; }
+    virtual int VWidth() const override { return size; }
+
+    virtual AutoVector CreateRowVector () const override { return mat->CreateColVector(); }
+    virtual AutoVector CreateColVector () const override { return mat->CreateRowVector(); }
+
+    virtual void Mult (const ngla::BaseVector & b, ngla::BaseVector & x) const override;
+  };
+}
+
+#endif // ELASTICITYAMG_HPP_
@@ -571,291 +571,286 @@ lot of new non-zero entries in the matrix!\n" << endl;
       }
     else
       {
-        // tcolmutex.Start();
-      Array<MyMutex> locks(GetNDof());
-      // tcolmutex.Stop();
-      
       for (auto vb : { VOL, BND, BBND, BBBND })
       {
-        /*
-        tcol.Start();
-        Array<int> col(ma->GetNE(vb));
-        col = -1;
-
-        int maxcolor = 0;
-        
-        int basecol = 0;
-        Array<unsigned int> mask(GetNDof());
-
-        size_t cnt = 0, found = 0;
-        for (ElementId el : Elements(vb)) { cnt++; (void)el; } // no warning 
-
-        do
-          {
-            mask = 0;
-
-            Array<DofId> dofs;
-            // for (auto el : Elements(vb))
-            for (auto el : ma->Elements(vb))
-              {
-                if (!DefinedOn(el)) continue;
-                if (col[el.Nr()] >= 0) continue;
-
-                unsigned check = 0;
-                GetDofNrs(el, dofs);
-                for (auto d : dofs) // el.GetDofs())
-                  if (d != -1) check |= mask[d];
-
-                if (check != UINT_MAX) // 0xFFFFFFFF)
-                  {
-                    found++;
-                    unsigned checkbit = 1;
-                    int color = basecol;
-                    while (check & checkbit)
-                      {
-                        color++;
-                        checkbit *= 2;
-                      }
-
-                    col[el.Nr()] = color;
-                    if (color > maxcolor) maxcolor = color;
-
-                    if (HasAtomicDofs())
-                      {
-                        for (auto d : dofs) // el.GetDofs())
-                          if (d != -1 && !IsAtomicDof(d)) mask[d] |= checkbit;
-                      }
-                    else
-                      {
-                        for (auto d : dofs) // el.GetDofs())
-                          if (d != -1) mask[d] |= checkbit;
-                      }
-                  }
-              }
-            
-            basecol += 8*sizeof(unsigned int); // 32;
-          }
-        while (found < cnt);
-
-        tcol.Stop();
-
-        Array<int> cntcol(maxcolor+1);
-        cntcol = 0;
-
-        for (ElementId el : Elements(vb))
-          cntcol[col[el.Nr()]]++;
+        element_coloring[vb] = ComputeColoring
+          (ma->GetNE(vb), GetNDof(),
+           [&] (size_t nr, Array<DofId> & dofs)
+           {
+             ElementId el = { vb, nr };
+             if (!DefinedOn(el)) return false;
+             GetDofNrs(el, dofs);
+             for (int i = dofs.Size()-1; i >= 0; i--)
+               if (!IsRegularDof(dofs[i]) || (HasAtomicDofs() && IsAtomicDof(dofs[i])))
+                 dofs.DeleteElement(i);
+             return true;
+           });
         
-        Table<int> & coloring = element_coloring[vb];
-        coloring = Table<int> (cntcol);
-
-	cntcol = 0;
-        for (ElementId el : Elements(vb))
-          coloring[col[el.Nr()]][cntcol[col[el.Nr()]]++] = el.Nr();
-        */
-
-
+        if (print)
+          *testout << "needed " << element_coloring[vb].Size() << " colors" 
+                   << " for " << ((vb == VOL) ? "vol" : "bnd") << endl;
+      }
+      }
+    
+    // invalidate facet_coloring
+    facet_coloring = Table<int>();
+    element_skeleton_coloring = Table<int>();
+    boundary_facet_coloring = Table<int>();
+       
+    level_updated = ma->GetNLevels();
+    if (timing) Timing();
+    updateSignal.Emit();
+    // CheckCouplingTypes();
+  }
 
-        // tcol.Start();
-        Array<int> col(ma->GetNE(vb));
-        col = -1;
+  const Table<int> & FESpace :: FacetColoring() const
+  {
+    if (facet_coloring.Size()) return facet_coloring;
 
-        int maxcolor = 0;
-        
-        int basecol = 0;
-        Array<unsigned int> mask(GetNDof());
+    const_cast<Table<int>&> (facet_coloring) = ComputeColoring
+      (ma->GetNFacets(), GetNDof(),
+       [&] (size_t f, Array<DofId> & dofs)
+       {
+         ArrayMem<int,2> elnums, elnums_per;
+         ArrayMem<DofId,100> dofs1;
+         ma->GetFacetElements(f,elnums);
+         if (elnums.Size() == 1)
+           {
+             size_t f2 = ma->GetPeriodicFacet(f);
+             if (f2 != f) // color both, left and right facet
+               {
+                 ma->GetFacetElements (f2, elnums_per);
+                 // if the facet is identified across subdomain
+                 // boundary, we only have the surface element
+                 // and not the other volume element!
+                 // that case does not impact coloring
+                 if (elnums_per.Size())
+                   elnums.Append(elnums_per[0]);
+               }
+           }
+         dofs.SetSize0();
+         for (auto el : elnums)
+           {
+             GetDofNrs(ElementId(VOL, el), dofs1);
+             for (auto d : dofs1)
+               if (IsRegularDof(d)) dofs.Append(d);
+           }
+         return true;
+       });
 
-        atomic<int> found(0);
-        size_t cnt = 0;
-        for (ElementId el : Elements(vb)) { cnt++; (void)el; } // no warning 
+    if (print)
+      *testout << "needed " << facet_coloring.Size() << " colors for facet-coloring" << endl;
 
-        while (found < cnt)
-          {
-            // mask = 0   | tasks;
+    return facet_coloring;
+  }
 
-            ParallelForRange
-              (mask.Size(),
-               [&] (IntRange myrange) { mask[myrange] = 0; });
 
-            size_t ne = ma->GetNE(vb);
+  const Table<int> & FESpace :: ElementSkeletonColoring() const
+  {
+    if (element_skeleton_coloring.Size()) return element_skeleton_coloring;
 
-            ParallelForRange
-              (ne, [&] (IntRange myrange)
+    const_cast<Table<int>&> (element_skeleton_coloring) = ComputeColoring
+      (ma->GetNE(VOL), GetNDof(),
+       [&] (size_t nr, Array<DofId> & dofs)
+       {
+         ElementId ei(VOL, nr);
+         if (!DefinedOn(ei)) return false;
+         ArrayMem<int,2> elnums, elnums_per;
+         ArrayMem<DofId,100> dofs1;
+         GetDofNrs(ei, dofs);
+         for (auto f : ma->GetElFacets(ei))
+           {
+             ma->GetFacetElements(f, elnums);
+             if (elnums.Size() < 2)
                {
-                 Array<DofId> dofs;
-                 size_t myfound = 0;
-                 
-                 for (size_t nr : myrange)
+                 size_t f2 = ma->GetPeriodicFacet(f);
+                 if (f2 != f)
                    {
-                     ElementId el = { vb, nr };
-                     if (!DefinedOn(el)) continue;
-                     if (col[el.Nr()] >= 0) continue;
-                     
-                     unsigned check = 0;
-                     GetDofNrs(el, dofs);
-                     
-                     if (HasAtomicDofs())
-                       {
-                         for (int i = dofs.Size()-1; i >= 0; i--)
-                           if (!IsRegularDof(dofs[i]) || IsAtomicDof(dofs[i])) dofs.DeleteElement(i);
-                       }
-                     else
-                       for (int i = dofs.Size()-1; i >= 0; i--)
-                         if (!IsRegularDof(dofs[i])) dofs.DeleteElement(i);
-                     QuickSort (dofs);   // sort to avoid dead-locks
-                     
-                     for (auto d : dofs) 
-                       locks[d].lock();
-                     
-                     for (auto d : dofs) 
-                       check |= mask[d];
-                     
-                     if (check != UINT_MAX) // 0xFFFFFFFF)
-                       {
-                         myfound++;
-                         unsigned checkbit = 1;
-                         int color = basecol;
-                         while (check & checkbit)
-                           {
-                             color++;
-                             checkbit *= 2;
-                           }
-                         
-                         col[el.Nr()] = color;
-                         if (color > maxcolor) maxcolor = color;
-                         
-                         for (auto d : dofs) // el.GetDofs())
-                           mask[d] |= checkbit;
-                       }
-                     
-                     for (auto d : dofs) 
-                       locks[d].unlock();
+                     ma->GetFacetElements (f2, elnums_per);
+                     if (elnums_per.Size())
+                       elnums.Append(elnums_per[0]);
                    }
-                 found += myfound;
-               });
-                 
-            basecol += 8*sizeof(unsigned int); // 32;
-          }
+               }
+             for (auto el : elnums)
+               if (size_t(el) != nr)
+                 {
+                   GetDofNrs(ElementId(VOL, el), dofs1);
+                   dofs += dofs1;
+                 }
+           }
+         for (int i = dofs.Size()-1; i >= 0; i--)
+           if (!IsRegularDof(dofs[i])) dofs.DeleteElement(i);
+         QuickSort (dofs);
+         // remove duplicates
+         size_t n = 0;
+         for (size_t i = 0; i < dofs.Size(); i++)
+           if (i == 0 || dofs[i] != dofs[i-1])
+             dofs[n++] = dofs[i];
+         dofs.SetSize(n);
+         return true;
+       });
+    
+    if (print)
+      *testout << "needed " << element_skeleton_coloring.Size() << " colors for element-skeleton-coloring" << endl;
 
-        // tcol.Stop();
+    return element_skeleton_coloring;
+  }
 
-        Array<int> cntcol(maxcolor+1);
-        cntcol = 0;
 
-        for (ElementId el : Elements(vb))
-          cntcol[col[el.Nr()]]++;
-        
-        Table<int> & coloring = element_coloring[vb];
-        coloring = Table<int> (cntcol);
+  const Table<int> & FESpace :: BoundaryFacetColoring() const
+  {
+    if (boundary_facet_coloring.Size()) return boundary_facet_coloring;
 
-	cntcol = 0;
-        for (ElementId el : Elements(vb))
-          coloring[col[el.Nr()]][cntcol[col[el.Nr()]]++] = el.Nr();
-        
-        if (print)
-          *testout << "needed " << maxcolor+1 << " colors" 
-                   << " for " << ((vb == VOL) ? "vol" : "bnd") << endl;
-      }
-      }
+    const_cast<Table<int>&> (boundary_facet_coloring) = ComputeColoring
+      (ma->GetNE(BND), GetNDof(),
+       [&] (size_t nr, Array<DofId> & dofs)
+       {
+         ArrayMem<int,2> elnums;
+         auto fnums = ma->GetElFacets(ElementId(BND, nr));
+         ma->GetFacetElements(fnums[0], elnums);
+         dofs.SetSize0();
+         if (elnums.Size())
+           GetDofNrs(ElementId(VOL, elnums[0]), dofs);
+         for (int i = dofs.Size()-1; i >= 0; i--)
+           if (!IsRegularDof(dofs[i])) dofs.DeleteElement(i);
+         return true;
+       });
     
-    // invalidate facet_coloring
-    facet_coloring = Table<int>();
-       
-    level_updated = ma->GetNLevels();
-    if (timing) Timing();
-    updateSignal.Emit();
-    // CheckCouplingTypes();
+    return boundary_facet_coloring;
   }
 
-  const Table<int> & FESpace :: FacetColoring() const
+
+  Table<int> ComputeColoring (size_t nitems, size_t ndof,
+                              const function<bool(size_t,Array<DofId>&)> & getdofs)
   {
-    if (facet_coloring.Size()) return facet_coloring;
+    static Timer t("ComputeColoring");
+    static Timer tdofs("ComputeColoring - dofs");
+    RegionTimer reg(t);
+
+    // dofs of the items, items without dofs are colored in the first round
+    tdofs.Start();
+    Array<int> cnt(nitems);
+    Array<int8_t> state(nitems);   // 0 .. to color, 1 .. colored, 2 .. next block, -1 .. skip
+    ParallelForRange
+      (nitems, [&] (IntRange r)
+       {
+         Array<DofId> dofs;
+         for (auto i : r)
+           {
+             bool use = getdofs(i, dofs);
+             state[i] = use ? 0 : -1;
+             cnt[i] = use ? dofs.Size() : 0;
+           }
+       });
+    Table<DofId> itemdofs(cnt);
+    ParallelForRange
+      (nitems, [&] (IntRange r)
+       {
+         Array<DofId> dofs;
+         for (auto i : r)
+           if (state[i] == 0)
+             {
+               getdofs(i, dofs);
+               itemdofs[i] = dofs;
+             }
+       });
+    tdofs.Stop();
 
-    size_t nf = ma->GetNFacets();
-    Array<int> col(nf);
+    // unique pseudo-random priorities
+    auto key = [] (size_t i) -> size_t
+      { return (size_t(uint32_t(i * 2654435761u)) << 32) + i + 1; };
+
+    Array<int> col(nitems);
     col = -1;
+    Array<size_t> prio(ndof);
+    Array<uint64_t> mask(ndof);
     
-    int maxcolor = 0;
-    int basecol = 0;
-    Array<unsigned int> mask(GetNDof());
-
-    size_t cnt = nf, found = 0;
-    Array<DofId> dofs, dofs1;
-    Array<int> elnums, elnums_per;
+    Array<int> todo;
+    for (auto i : Range(nitems))
+      if (state[i] == 0) todo.Append(i);
     
-    do
+    int basecol = 0;
+    int maxcolor = -1;
+    while (todo.Size())
       {
-        mask = 0;
-        for (size_t f = 0; f < nf; f++)
+        ParallelForRange (ndof, [&] (IntRange r) { mask[r] = 0; });
+
+        while (todo.Size())
           {
-            if (col[f] >= 0) continue;
+            ParallelFor (todo.Size(), [&] (size_t j)
+              {
+                for (auto d : itemdofs[todo[j]])
+                  AsAtomic(prio[d]).store(0, memory_order_relaxed);
+              });
             
-            ma->GetFacetElements(f,elnums);
-            dofs.SetSize0();
-
-            if (elnums.Size() == 1)
+            ParallelFor (todo.Size(), [&] (size_t j)
               {
-                size_t f2 = ma->GetPeriodicFacet(f);
-                // if (f2 < f) continue;
-                if (f2 != f) // color both, left and right facet
+                size_t k = key(todo[j]);
+                for (auto d : itemdofs[todo[j]])
                   {
-                    ma->GetFacetElements (f2, elnums_per);
-		    // if the facet is identified across subdomain
-		    // boundary, we only have the surface element
-		    // and not the other volume element!
-		    // that case does not impact coloring
-		    if (elnums_per.Size())
-		      elnums.Append(elnums_per[0]);
+                    auto & p = AsAtomic(prio[d]);
+                    size_t old = p.load(memory_order_relaxed);
+                    while (old < k && !p.compare_exchange_weak(old, k, memory_order_relaxed)) ;
                   }
-              }
-            for (auto el : elnums)
-              {
-                GetDofNrs(ElementId(VOL, el), dofs1);
-                dofs += dofs1;
-              }
-            
-            unsigned check = 0;
-            for (auto d : dofs)
-              if (IsRegularDof(d)) check |= mask[d];
-            
-            if (check != UINT_MAX) // 0xFFFFFFFF)
+              });
+
+            // local maxima are dof-disjoint: no locks for mask
+            ParallelFor (todo.Size(), [&] (size_t j)
               {
-                found++;
-                unsigned checkbit = 1;
-                int color = basecol;
-                while (check & checkbit)
+                size_t i = todo[j];
+                size_t k = key(i);
+                for (auto d : itemdofs[i])
+                  if (prio[d] != k) return;
+
+                uint64_t used = 0;
+                for (auto d : itemdofs[i])
+                  used |= mask[d];
+                if (used == ~uint64_t(0))
                   {
-                    color++;
-                    checkbit *= 2;
+                    state[i] = 2;
+                    return;
                   }
-                
-                col[f] = color;
-                if (color > maxcolor) maxcolor = color;
-		
-                for (auto d : dofs)
-                  if (IsRegularDof(d)) mask[d] |= checkbit;
+                int bit = 0;
+                while (used & (uint64_t(1) << bit)) bit++;
+                for (auto d : itemdofs[i])
+                  mask[d] |= uint64_t(1) << bit;
+                col[i] = basecol + bit;
+                state[i] = 1;
+              });
+
+            size_t n = 0;
+            for (auto i : todo)
+              {
+                if (state[i] == 0)
+                  todo[n++] = i;
+                if (state[i] == 1)
+                  maxcolor = max2(maxcolor, col[i]);
               }
+            todo.SetSize(n);
           }
-        
-        basecol += 8*sizeof(unsigned int); // 32;
+
+        // items which found no free color in this block
+        for (auto i : Range(nitems))
+          if (state[i] == 2)
+            {
+              state[i] = 0;
+              todo.Append(i);
+            }
+        basecol += 8*sizeof(uint64_t);
       }
-    while (found < cnt);
 
     Array<int> cntcol(maxcolor+1);
     cntcol = 0;
-    
-    for (auto f : Range(nf))
-      cntcol[col[f]]++;
-    
-    const_cast<Table<int>&> (facet_coloring) = Table<int> (cntcol);
-    
-    cntcol = 0;
-    for (auto f : Range(nf))          
-      facet_coloring[col[f]][cntcol[col[f]]++] = f;
+    for (auto i : Range(nitems))
+      if (col[i] >= 0)
+        cntcol[col[i]]++;
 
-    if (print)
-      *testout << "needed " << maxcolor+1 << " colors for facet-coloring" << endl;
-
-    return facet_coloring;
+    Table<int> coloring(cntcol);
+    cntcol = 0;
+    for (auto i : Range(nitems))
+      if (col[i] >= 0)
+        coloring[col[i]][cntcol[col[i]]++] = i;
+    return coloring;
   }
   
 
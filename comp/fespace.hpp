@@ -186,6 +186,8 @@ ANY                  1 1 1 1 | 15
     
     Table<int> element_coloring[4]; 
     Table<int> facet_coloring;  // elements on facet in own colors (DG)
+    Table<int> element_skeleton_coloring;  // elements with facet-neighbours in own colors
+    Table<int> boundary_facet_coloring;    // boundary elements with volume neighbour in own colors
     Array<COUPLING_TYPE> ctofdof;
 
     shared_ptr<ParallelDofs> paralleldofs;
@@ -246,6 +248,12 @@ ANY                  1 1 1 1 | 15
     { return element_coloring[vb]; }
 
     const Table<int> & FacetColoring() const;
+
+    /// volume elements, no dof-conflicts of elements and their facet-neighbours within a color
+    const Table<int> & ElementSkeletonColoring() const;
+
+    /// boundary elements, colored by the dofs of the adjacent volume element
+    const Table<int> & BoundaryFacetColoring() const;
     
     /// print report to stream
     virtual void PrintReport (ostream & ost) const override;
@@ -848,6 +856,18 @@ ANY                  1 1 1 1 | 15
 
 
 
+  /**
+     Colors items such that items of the same color share no dof.
+     getdofs returns false for items which are not colored.
+     Lock-free parallel Jones-Plassmann: in each round, the items of
+     maximal random priority among their uncolored neighbours take the
+     smallest color free at their dofs. These items share no dofs, so
+     the used-colors masks are updated without locks.
+  */
+  extern NGS_DLL_HEADER Table<int>
+  ComputeColoring (size_t nitems, size_t ndof,
+                   const function<bool(size_t,Array<DofId>&)> & getdofs);
+
   extern NGS_DLL_HEADER void IterateElements (const FESpace & fes,
 			       VorB vb, 
 			       LocalHeap & clh, 
@@ -7,6 +7,13 @@
 #include <parallelngs.hpp>
 #include <stdlib.h>
 
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace ngcomp; 
 
 
@@ -825,6 +832,377 @@ namespace ngcomp
 
 
 
+  /*
+    Checkpoint files. All offsets are in bytes from the beginning of the file:
+
+      CheckpointHeader, ChunkHeader[nchunks]         padded to a page
+      for every chunk (one per rank, page aligned):
+        NodeEntry[nnodes[nt]] for nt = vertex, edge, face, cell
+        int64 dofnrs[ndofnrs]                        local dofs of the nodes
+        multidim raw vectors                         page aligned
+
+    Restarting on the same distribution maps the vectors directly,
+    otherwise the values are found via the global node numbers.
+  */
+  namespace checkpoint
+  {
+    constexpr size_t page_size = 4096;
+    inline size_t PageAlign (size_t n) { return (n + page_size-1) / page_size * page_size; }
+
+    const char magic[8] = { 'N', 'G', 'S', 'C', 'K', 'P', 'T', '1' };
+
+    struct CheckpointHeader
+    {
+      char magic[8];
+      uint64_t scalsize;    // 8 for double, 16 for complex
+      uint64_t entrysize;   // scalars per dof
+      uint64_t multidim;
+      uint64_t nchunks;
+    };
+
+    struct ChunkHeader
+    {
+      uint64_t ndof;
+      uint64_t nnodes[4];
+      uint64_t node_offset[4];
+      uint64_t ndofnrs;
+      uint64_t dofnr_offset;
+      uint64_t data_offset;
+      uint64_t size;        // of the whole chunk
+    };
+
+    struct NodeEntry
+    {
+      int64_t globnr;
+      int64_t first;        // into dofnrs
+      int64_t cnt;
+    };
+
+    inline size_t HeaderSize (size_t nchunks)
+    { return PageAlign (sizeof(CheckpointHeader) + nchunks * sizeof(ChunkHeader)); }
+
+    /// file contents, either mapped (private, copy on write) or read into memory
+    class MappedFile
+    {
+      char * data = nullptr;
+      size_t size = 0;
+      bool mapped = false;
+      Array<char> buffer;
+    public:
+      MappedFile (const string & filename, bool use_mmap)
+      {
+#ifndef WIN32
+        if (use_mmap)
+          {
+            int fd = open (filename.c_str(), O_RDONLY);
+            if (fd < 0)
+              throw Exception ("cannot open checkpoint file '" + filename + "'");
+            struct stat st;
+            fstat (fd, &st);
+            size = st.st_size;
+            void * p = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            close (fd);
+            if (p == MAP_FAILED)
+              throw Exception ("cannot map checkpoint file '" + filename + "'");
+            data = static_cast<char*> (p);
+            mapped = true;
+            return;
+          }
+#endif
+        ifstream ist (filename, ios::binary | ios::ate);
+        if (!ist)
+          throw Exception ("cannot open checkpoint file '" + filename + "'");
+        size = ist.tellg();
+        ist.seekg (0);
+        buffer.SetSize (size);
+        ist.read (buffer.Data(), size);
+        data = buffer.Data();
+      }
+
+      ~MappedFile ()
+      {
+#ifndef WIN32
+        if (mapped) munmap (data, size);
+#endif
+      }
+
+      char * Data () const { return data; }
+      size_t Size () const { return size; }
+      bool IsMapped () const { return mapped; }
+    };
+
+    /// nodes carrying dofs, keyed by global node number
+    static void NodeTables (const MeshAccess & ma, const FESpace & fes,
+                            Array<Array<NodeEntry>> & nodes, Array<int64_t> & dofnrs)
+    {
+      bool parallel = ma.GetCommunicator().Size() > 1;
+      Array<DofId> dnums;
+      nodes.SetSize (4);
+      dofnrs.SetSize0 ();
+      for (NODE_TYPE nt : { NT_VERTEX, NT_EDGE, NT_FACE, NT_CELL })
+        {
+          auto & tab = nodes[int(nt)];
+          tab.SetSize0 ();
+          for (size_t i = 0; i < ma.GetNNodes (nt); i++)
+            {
+              fes.GetDofNrs (NodeId(nt, i), dnums);
+              if (dnums.Size() == 0) continue;
+              int64_t globnr = parallel ? ma.GetGlobalNodeNum (NodeId(nt, i)) : i;
+              tab.Append (NodeEntry { globnr, int64_t(dofnrs.Size()), int64_t(dnums.Size()) });
+              for (auto d : dnums)
+                dofnrs.Append (d);
+            }
+        }
+    }
+  }
+
+
+  template <class SCAL>
+  void S_GridFunction<SCAL> :: SaveCheckpoint (const string & filename) const
+  {
+    using namespace checkpoint;
+    static Timer t("GridFunction::SaveCheckpoint"); RegionTimer reg(t);
+
+    auto comm = ma->GetCommunicator();
+    int id = comm.Rank();
+    int ntasks = comm.Size();
+
+    size_t ndof = vec[0]->Size();
+    size_t es = vec[0]->EntrySize() * sizeof(double) / sizeof(SCAL);
+    size_t vecbytes = ndof * es * sizeof(SCAL);
+
+    Array<Array<NodeEntry>> nodes;
+    Array<int64_t> dofnrs;
+    NodeTables (*ma, *GetFESpace(), nodes, dofnrs);
+
+    // layout of my chunk, relative to its beginning
+    ChunkHeader chunk;
+    size_t pos = 0;
+    chunk.ndof = ndof;
+    for (int nt = 0; nt < 4; nt++)
+      {
+        chunk.nnodes[nt] = nodes[nt].Size();
+        chunk.node_offset[nt] = pos;
+        pos += nodes[nt].Size() * sizeof(NodeEntry);
+      }
+    chunk.ndofnrs = dofnrs.Size();
+    chunk.dofnr_offset = pos;
+    pos += dofnrs.Size() * sizeof(int64_t);
+    chunk.data_offset = PageAlign (pos);
+    chunk.size = PageAlign (chunk.data_offset + multidim * vecbytes);
+
+    Array<ChunkHeader> chunks(ntasks);
+#ifdef PARALLEL
+    if (ntasks > 1)
+      MPI_Allgather (&chunk, sizeof(ChunkHeader), MPI_BYTE,
+                     chunks.Data(), sizeof(ChunkHeader), MPI_BYTE, comm);
+    else
+#endif
+      chunks[0] = chunk;
+
+    // written to a temporary file, which replaces the checkpoint at the end.
+    // Vectors loaded from the old file keep their (copy on write) mapping
+    // of the old contents, also when we save over it.
+    string tmpname = filename + ".tmp";
+
+    size_t offset = HeaderSize (ntasks);
+    for (auto & c : chunks)
+      {
+        for (int nt = 0; nt < 4; nt++)
+          c.node_offset[nt] += offset;
+        c.dofnr_offset += offset;
+        c.data_offset += offset;
+        offset += c.size;
+      }
+
+    if (id == 0)
+      {
+        CheckpointHeader header;
+        memcpy (header.magic, magic, sizeof(magic));
+        header.scalsize = sizeof(SCAL);
+        header.entrysize = es;
+        header.multidim = multidim;
+        header.nchunks = ntasks;
+
+        Array<char> buffer(HeaderSize(ntasks));
+        buffer = 0;
+        memcpy (buffer.Data(), &header, sizeof(header));
+        memcpy (buffer.Data()+sizeof(header), chunks.Data(), ntasks*sizeof(ChunkHeader));
+
+        ofstream ost (tmpname, ios::binary | ios::trunc);
+        ost.write (buffer.Data(), buffer.Size());
+        if (!ost)
+          throw Exception ("cannot write checkpoint file '" + tmpname + "'");
+      }
+#ifdef PARALLEL
+    if (ntasks > 1)
+      {
+        for (int i = 0; i < multidim; i++)
+          vec[i]->Cumulate();
+        comm.Barrier();
+      }
+#endif
+
+    // every rank writes its chunk with a few large writes
+    const ChunkHeader & mychunk = chunks[id];
+    fstream ost (tmpname, ios::binary | ios::in | ios::out);
+    ost.seekp (mychunk.node_offset[0]);
+    for (int nt = 0; nt < 4; nt++)
+      ost.write (reinterpret_cast<char*> (nodes[nt].Data()), nodes[nt].Size()*sizeof(NodeEntry));
+    ost.write (reinterpret_cast<char*> (dofnrs.Data()), dofnrs.Size()*sizeof(int64_t));
+    ost.seekp (mychunk.data_offset);
+    for (int i = 0; i < multidim; i++)
+      ost.write (static_cast<char*> (vec[i]->Memory()), vecbytes);
+    if (!ost)
+      throw Exception ("cannot write checkpoint file '" + tmpname + "'");
+    ost.close();
+
+#ifdef PARALLEL
+    if (ntasks > 1)
+      comm.Barrier();
+#endif
+    if (id == 0 && rename (tmpname.c_str(), filename.c_str()) != 0)
+      throw Exception ("cannot rename '" + tmpname + "' to checkpoint file '" + filename + "'");
+#ifdef PARALLEL
+    if (ntasks > 1)
+      comm.Barrier();
+#endif
+  }
+
+
+  template <class SCAL>
+  void S_GridFunction<SCAL> :: LoadCheckpoint (const string & filename, bool use_mmap)
+  {
+    using namespace checkpoint;
+    static Timer t("GridFunction::LoadCheckpoint"); RegionTimer reg(t);
+
+    auto comm = ma->GetCommunicator();
+    int id = comm.Rank();
+    int ntasks = comm.Size();
+
+    auto file = make_shared<MappedFile> (filename, use_mmap);
+    char * base = file->Data();
+    if (file->Size() < sizeof(CheckpointHeader) || memcmp (base, magic, sizeof(magic)) != 0)
+      throw Exception ("'" + filename + "' is not a GridFunction checkpoint");
+
+    const CheckpointHeader & header = *reinterpret_cast<CheckpointHeader*> (base);
+    size_t filesize = file->Size();
+    if (header.nchunks == 0 || header.nchunks > (filesize-sizeof(CheckpointHeader)) / sizeof(ChunkHeader))
+      throw Exception ("checkpoint '" + filename + "' is truncated or corrupt");
+    FlatArray<ChunkHeader> chunks (header.nchunks, reinterpret_cast<ChunkHeader*> (base+sizeof(CheckpointHeader)));
+
+    size_t ndof = vec[0]->Size();
+    size_t es = vec[0]->EntrySize() * sizeof(double) / sizeof(SCAL);
+    size_t vecbytes = ndof * es * sizeof(SCAL);
+    if (header.scalsize != sizeof(SCAL) || header.entrysize != es || header.multidim != size_t(multidim))
+      throw Exception ("checkpoint '" + filename + "' does not fit to GridFunction " + this->name
+                       + " (scalar type, dimension or multidim differ)");
+
+    // all tables and vectors of the chunks must be inside the file
+    auto Inside = [filesize] (uint64_t offset, uint64_t n, size_t itemsize)
+      { return offset <= filesize && n <= (filesize-offset) / itemsize; };
+    for (auto & c : chunks)
+      {
+        bool ok = Inside (c.dofnr_offset, c.ndofnrs, sizeof(int64_t))
+          && Inside (c.data_offset, c.ndof, multidim * es * sizeof(SCAL));
+        for (int nt = 0; nt < 4; nt++)
+          ok = ok && Inside (c.node_offset[nt], c.nnodes[nt], sizeof(NodeEntry));
+        if (!ok)
+          throw Exception ("checkpoint '" + filename + "' is truncated or corrupt");
+      }
+
+    auto NodeTable = [&] (const ChunkHeader & c, int nt)
+      { return FlatArray<NodeEntry> (c.nnodes[nt], reinterpret_cast<NodeEntry*> (base+c.node_offset[nt])); };
+    auto DofNrs = [&] (const ChunkHeader & c)
+      { return FlatArray<int64_t> (c.ndofnrs, reinterpret_cast<int64_t*> (base+c.dofnr_offset)); };
+    
+    Array<Array<NodeEntry>> nodes;
+    Array<int64_t> dofnrs;
+    NodeTables (*ma, *GetFESpace(), nodes, dofnrs);
+
+    bool same = header.nchunks == size_t(ntasks) && chunks[id].ndof == ndof
+      && chunks[id].ndofnrs == dofnrs.Size()
+      && memcmp (DofNrs(chunks[id]).Data(), dofnrs.Data(), dofnrs.Size()*sizeof(int64_t)) == 0;
+    for (int nt = 0; nt < 4; nt++)
+      same = same && chunks[id].nnodes[nt] == nodes[nt].Size()
+        && memcmp (NodeTable(chunks[id], nt).Data(), nodes[nt].Data(), nodes[nt].Size()*sizeof(NodeEntry)) == 0;
+
+    if (same)
+      {
+        // same distribution: the stored vectors are my vectors
+        for (int i = 0; i < multidim; i++)
+          {
+            char * data = base + chunks[id].data_offset + i * vecbytes;
+            auto vecptr = dynamic_pointer_cast<S_BaseVectorPtr<SCAL>> (vec[i]);
+            // parallel vectors keep a view of their memory (local_vec), they are copied
+            bool parallel = dynamic_cast<const ParallelBaseVector*> (vec[i].get()) != nullptr;
+            if (file->IsMapped() && vecptr && !parallel)
+              vecptr->AssignMemory (ndof, data, file);
+            else
+              memcpy (vec[i]->Memory(), data, vecbytes);
+          }
+      }
+    else
+      {
+        // look up the nodes by global number in all chunks
+        size_t nstored = 0;
+        for (auto & c : chunks)
+          for (int nt = 0; nt < 4; nt++)
+            nstored += c.nnodes[nt];
+        
+        // global node numbers need not fit into 32 bit
+        ClosedHashTable<INT<2,int64_t>, INT<2,int64_t>> node2entry(2*nstored+10);
+        for (size_t c = 0; c < chunks.Size(); c++)
+          for (int nt = 0; nt < 4; nt++)
+            {
+              auto tab = NodeTable (chunks[c], nt);
+              for (size_t j = 0; j < tab.Size(); j++)
+                node2entry.Set (INT<2,int64_t> (nt, tab[j].globnr), INT<2,int64_t> (c, j));
+            }
+
+        for (int i = 0; i < multidim; i++)
+          *vec[i] = SCAL(0.0);
+        
+        for (int nt = 0; nt < 4; nt++)
+          for (auto & node : nodes[nt])
+            {
+              INT<2,int64_t> key (nt, node.globnr);
+              if (!node2entry.Used (key))
+                throw Exception ("checkpoint '" + filename + "' does not contain node "
+                                 + ToString(node.globnr) + " of type " + ToString(nt));
+              INT<2,int64_t> ce = node2entry.Get (key);
+              const ChunkHeader & chunk = chunks[ce[0]];
+              const NodeEntry & entry = NodeTable(chunk, nt)[ce[1]];
+              if (entry.cnt != node.cnt)
+                throw Exception ("checkpoint '" + filename + "' has a different number of dofs on node "
+                                 + ToString(node.globnr) + " of type " + ToString(nt));
+              auto stored = DofNrs (chunk);
+              if (entry.first < 0 || entry.cnt < 0 || uint64_t(entry.first+entry.cnt) > chunk.ndofnrs)
+                throw Exception ("checkpoint '" + filename + "' is truncated or corrupt");
+              for (int k = 0; k < node.cnt; k++)
+                if (stored[entry.first+k] < 0 || uint64_t(stored[entry.first+k]) >= chunk.ndof)
+                  throw Exception ("checkpoint '" + filename + "' is truncated or corrupt");
+              
+              for (int i = 0; i < multidim; i++)
+                {
+                  SCAL * src = reinterpret_cast<SCAL*> (base + chunk.data_offset) + i * chunk.ndof * es;
+                  SCAL * dst = static_cast<SCAL*> (vec[i]->Memory());
+                  for (int k = 0; k < node.cnt; k++)
+                    for (size_t l = 0; l < es; l++)
+                      dst[dofnrs[node.first+k]*es+l] = src[stored[entry.first+k]*es+l];
+                }
+            }
+      }
+
+#ifdef PARALLEL
+    if (ntasks > 1)
+      for (int i = 0; i < multidim; i++)
+        vec[i]->SetParallelStatus (CUMULATED);
+#endif
+  }
+
+
+
   ComponentGridFunction ::
   ComponentGridFunction (shared_ptr<GridFunction> agf_parent, int acomp)
     : GridFunction (dynamic_cast<const CompoundFESpace&> (*agf_parent->GetFESpace())[acomp],
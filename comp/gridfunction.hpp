@@ -271,6 +271,13 @@ namespace ngcomp
 
     virtual void Load (istream & ist) = 0;
     virtual void Save (ostream & ost) const = 0;
+
+    /// binary checkpoint, one chunk per rank with node tables and the raw vectors
+    virtual void SaveCheckpoint (const string & filename) const
+    { throw Exception ("SaveCheckpoint not implemented for " + GetClassName()); }
+    /// use_mmap .. map the file (copy on write) instead of reading it
+    virtual void LoadCheckpoint (const string & filename, bool use_mmap = true)
+    { throw Exception ("LoadCheckpoint not implemented for " + GetClassName()); }
     using NGS_Object::shared_from_this;
   };
 
@@ -304,6 +311,9 @@ namespace ngcomp
     virtual void Load (istream & ist);
     virtual void Save (ostream & ost) const;
 
+    virtual void SaveCheckpoint (const string & filename) const override;
+    virtual void LoadCheckpoint (const string & filename, bool use_mmap = true) override;
+
     virtual void Update ();
 
   private:
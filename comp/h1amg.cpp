@@ -126,7 +126,7 @@ namespace ngcomp
                                    FlatArray<INT<2>> e2v,
                                    FlatArray<double> edge_weights,
                                    FlatArray<double> vertex_weights,
-                                   size_t level)
+                                   size_t level, bool chebyshev)
   : mat(amat)
   {
       static Timer t("H1AMG"); RegionTimer reg(t);
@@ -365,6 +365,8 @@ namespace ngcomp
 
       auto blocks = make_shared<Table<int>> (smoothing_blocks_creator.MoveTable());
       smoother = mat->CreateBlockJacobiPrecond(blocks);
+      if (chebyshev)
+        chebsmoother = make_shared<ChebyshevJacobi> (mat, smoother);
 
       // build prolongation
       Array<int> nne(num_vertices);
@@ -426,7 +428,8 @@ namespace ngcomp
 	}
       else
         coarse_precond = make_shared<H1AMG_Matrix> (dynamic_pointer_cast<SparseMatrixTM<SCAL>> (coarsemat), coarse_freedofs,
-                                                    coarse_e2v, coarse_edge_weights, coarse_vertex_weights, level+1);
+                                                    coarse_e2v, coarse_edge_weights, coarse_vertex_weights, level+1,
+                                                    chebyshev);
 
 
       restriction = TransposeMatrix (*prolongation);
@@ -438,7 +441,10 @@ namespace ngcomp
       static Timer t("H1AMG::Mult"); RegionTimer reg(t);
       x = 0;
 
-      smoother->GSSmooth(x, b, smoothing_steps);
+      if (chebsmoother)
+        chebsmoother->Smooth(x, b, smoothing_steps);
+      else
+        smoother->GSSmooth(x, b, smoothing_steps);
       auto residuum = b.CreateVector();
       residuum = b - (*mat) * x;
 
@@ -449,7 +455,10 @@ namespace ngcomp
       coarse_precond->Mult(coarse_residuum, coarse_x);
 
       x += *prolongation * coarse_x;
-      smoother->GSSmoothBack (x, b, smoothing_steps);
+      if (chebsmoother)
+        chebsmoother->Smooth(x, b, smoothing_steps);
+      else
+        smoother->GSSmoothBack (x, b, smoothing_steps);
   }
 
   template <class SCAL>
@@ -508,7 +517,9 @@ namespace ngcomp
          });
       vertex_weights_ht = ParallelHashTable<INT<1>,double>();
 
-      mat = make_shared<H1AMG_Matrix<double>> (smat, freedofs, e2v, edge_weights, vertex_weights, 0);
+      bool chebyshev = flags.GetStringFlag ("smoother", "gs") == "chebyshev";
+      mat = make_shared<H1AMG_Matrix<double>> (smat, freedofs, e2v, edge_weights, vertex_weights, 0,
+                                               chebyshev);
     }
 
 
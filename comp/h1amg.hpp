@@ -11,6 +11,8 @@ namespace ngcomp
     size_t size;
     std::shared_ptr<ngla::SparseMatrixTM<SCAL>> mat;
     std::shared_ptr<ngla::BaseBlockJacobiPrecond> smoother;
+    /// Chebyshev accelerated block-Jacobi instead of Gauss-Seidel
+    std::shared_ptr<ngla::ChebyshevJacobi> chebsmoother;
     std::shared_ptr<ngla::SparseMatrixTM<double>> prolongation, restriction;
     std::shared_ptr<ngla::BaseMatrix> coarse_precond;
     int smoothing_steps = 1;
@@ -21,7 +23,7 @@ namespace ngcomp
                   ngcore::FlatArray<ngcore::INT<2>> e2v,
                   ngcore::FlatArray<double> edge_weights,
                   ngcore::FlatArray<double> vertex_weights,
-                  size_t level);
+                  size_t level, bool chebyshev = false);
 
     virtual int VHeight() const override { return size; }
     virtual int VWidth() const override { return size; }
@@ -12,6 +12,7 @@
 #include <multigrid.hpp> 
 #include "../fem/h1hofe.hpp"
 #include "../fem/h1hofefo.hpp"
+#include "../fem/h1hofetp.hpp"
 #include <../fem/hdivhofe.hpp>
 #include <../fem/facethofe.hpp>  
 
@@ -205,6 +206,7 @@ namespace ngcomp
     //  DefineNumListFlag("dom_order_max_z");
     DefineNumFlag("smoothing");
     DefineDefineFlag("wb_withedges");
+    DefineDefineFlag("tp");
     if (parseflags) CheckFlags(flags);
 
     wb_loedge = ma->GetDimension() == 3;
@@ -250,6 +252,7 @@ namespace ngcomp
     highest_order_dc = flags.GetDefineFlag ("highest_order_dc");
     if (highest_order_dc && order < 2)
       throw Exception ("highest_order_dc needs order >= 2");
+    tensorproduct = flags.GetDefineFlag ("tp");
     
     Flags loflags;
     loflags.SetFlag ("order", 1);
@@ -390,6 +393,9 @@ into the wirebasket.
       "  use lowest-order edge dofs for BDDC wirebasket";
     docu.Arg("wb_fulledges") = "bool = false\n"
       "  use all edge dofs for BDDC wirebasket";
+    docu.Arg("tp") = "bool = false\n"
+      "  use sum-factorization for quads and hexes of uniform order,\n"
+      "  speeds up matrix-free operator application (nonassemble)";
     return docu;
   }
 
@@ -625,6 +631,7 @@ into the wirebasket.
       }
     UpdateDofTables ();
     UpdateCouplingDofArray ();
+    UpdateTPTrafos ();
 
     if (low_order_space)
       low_order_embedding =
@@ -844,7 +851,62 @@ into the wirebasket.
     archive & dom_order_min & dom_order_max;
     // archive & smoother;
     // archive & ndlevel;
-    archive & level_adapted_order & nodalp2;
+    archive & level_adapted_order & nodalp2 & tensorproduct;
+    if (archive.Input())
+      UpdateTPTrafos();
+  }
+
+
+  int H1HighOrderFESpace :: TPElementOrder (ElementId ei) const
+  {
+    ELEMENT_TYPE eltype = ma->GetElType(ei);
+    if (!ei.IsVolume() || !tensorproduct || nodalp2 ||
+        (eltype != ET_QUAD && eltype != ET_HEX))
+      return -1;
+
+    auto elnr = ei.Nr();
+    Ngs_Element ngel = ma->GetElement(ei);
+    int p = order_inner[elnr][0];
+    for (int j = 0; j < ma->GetDimension(); j++)
+      if (order_inner[elnr][j] != p) return -1;
+    for (auto e : ngel.Edges())
+      if (order_edge[e] != p) return -1;
+    if (eltype == ET_HEX)
+      for (auto f : ngel.Faces())
+        if (order_face[f][0] != p || order_face[f][1] != p) return -1;
+    return p;
+  }
+
+  void H1HighOrderFESpace :: UpdateTPTrafos ()
+  {
+    static Timer t("H1HighOrderFESpace::UpdateTPTrafos"); RegionTimer reg(t);
+
+    tp_trafos.SetSize0();
+    tp_trafo_nr.SetSize0();
+    if (!tensorproduct) return;
+
+    // one trafo per order and relative vertex numbering
+    tp_trafo_nr.SetSize (ma->GetNE(VOL));
+    tp_trafo_nr = -1;
+    std::map<size_t, int> known[2];
+    for (ElementId ei : ma->Elements<VOL>())
+      {
+        int p = TPElementOrder (ei);
+        if (p < 0) continue;
+        Ngs_Element ngel = ma->GetElement(ei);
+        auto vnums = ngel.Vertices();
+        bool hex = ma->GetElType(ei) == ET_HEX;
+        size_t key = hex ? H1HighOrderFETP<ET_HEX>::TrafoKey (p, vnums)
+          : H1HighOrderFETP<ET_QUAD>::TrafoKey (p, vnums);
+        auto pos = known[hex].find(key);
+        if (pos == known[hex].end())
+          {
+            pos = known[hex].emplace(key, tp_trafos.Size()).first;
+            tp_trafos.Append (hex ? H1HighOrderFETP<ET_HEX>::CalcTrafo (p, vnums)
+                              : H1HighOrderFETP<ET_QUAD>::CalcTrafo (p, vnums));
+          }
+        tp_trafo_nr[ei.Nr()] = pos->second;
+      }
   }
 
   Array<MemoryUsage> H1HighOrderFESpace :: GetMemoryUsage () const
@@ -903,6 +965,16 @@ into the wirebasket.
         
         
         auto elnr = ei.Nr();
+        if (ei.IsVolume() && tp_trafo_nr.Size() && tp_trafo_nr[elnr] != -1)
+          {
+            auto & trafo = *tp_trafos[tp_trafo_nr[elnr]];
+            int p = order_inner[elnr][0];
+            if (eltype == ET_QUAD)
+              return *new (alloc) H1HighOrderFETP<ET_QUAD> (p, ngel.Vertices(), trafo);
+            else
+              return *new (alloc) H1HighOrderFETP<ET_HEX> (p, ngel.Vertices(), trafo);
+          }
+        
         if (ei.IsVolume())
           {
             return SwitchET
@@ -7,6 +7,8 @@
 /* Date:   10. Feb. 2003                                             */
 /*********************************************************************/
 
+namespace ngfem { class H1TPTrafo; }
+
 namespace ngcomp
 {
 
@@ -49,6 +51,12 @@ namespace ngcomp
     bool level_adapted_order; 
     bool nodalp2;
     bool highest_order_dc;
+    /// sum-factorized elements on quads and hexes
+    bool tensorproduct;
+    /// maps of the sum-factorized elements, built once in Update
+    Array<shared_ptr<ngfem::H1TPTrafo>> tp_trafos;
+    /// trafo of volume element, -1 for standard elements
+    Array<int> tp_trafo_nr;
   public:
 
     H1HighOrderFESpace (shared_ptr<MeshAccess> ama, const Flags & flags, bool checkflags=false);
@@ -97,6 +105,10 @@ namespace ngcomp
 
     virtual void UpdateDofTables () override;
     virtual void UpdateCouplingDofArray() override;    
+    /// computes the maps for the sum-factorized elements
+    void UpdateTPTrafos ();
+    /// uniform order of a sum-factorized element, -1 otherwise
+    int TPElementOrder (ElementId ei) const;
 
     virtual void SetOrder (NodeId ni, int order) override;
     virtual int GetOrder (NodeId ni) const override;
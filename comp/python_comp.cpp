@@ -1593,6 +1593,45 @@ filename : string
 parallel : bool
   input parallel
 
+)raw_string"))
+    .def("SaveCheckpoint", [](GF& self, string filename)
+         { self.SaveCheckpoint(filename); },
+         py::arg("filename"), docu_string(R"raw_string(
+Saves the gridfunction into a binary checkpoint file. Every rank
+writes its local vectors as one contiguous chunk, together with
+the global node numbers of its dofs. The file is written under
+a temporary name and then replaces filename, so gridfunctions
+loaded from filename are not affected.
+
+Parameters:
+
+filename : string
+  output file name
+
+)raw_string"))
+    .def("LoadCheckpoint", [](GF& self, string filename, bool mmap)
+         { self.LoadCheckpoint(filename, mmap); },
+         py::arg("filename"), py::arg("mmap")=true, docu_string(R"raw_string(
+Loads a gridfunction from a checkpoint written by SaveCheckpoint.
+On the same mesh distribution sequential vectors use the
+(copy-on-write) mapped file without copying, and parallel vectors
+are copied from it. Otherwise values are looked up by global node
+numbers. A mapped file may be replaced or deleted, but must not be
+modified in place while the gridfunction uses it.
+
+Mapped vectors get new memory, so views taken before loading
+(FV, NumPy) are invalid afterwards. With mmap=False the values
+are copied into the existing vectors.
+
+Parameters:
+
+filename : string
+  input file name
+
+mmap : bool
+  map the file instead of reading it into memory, and use
+  the mapping as vector memory where possible
+
 )raw_string"))
     .def("Set", 
          [](shared_ptr<GF> self, spCF cf,
@@ -1992,7 +2031,16 @@ space : ngsolve.FESpace
                      "  when element matrices are independent of geometry, we store them \n"
                      "  only for the referecne elements",
                      py::arg("check_unused") = "bool = True\n"
-		     "  If set prints warnings if not UNUSED_DOFS are not used."
+		     "  If set prints warnings if not UNUSED_DOFS are not used.",
+                     py::arg("compress_indices") = "bool = False\n"
+                     "  After assembling, column indices of the matrix are stored as 16-bit\n"
+                     "  offsets to the first column of the row, which reduces memory and the\n"
+                     "  memory traffic of the matrix-vector product. Rows spanning more columns\n"
+                     "  keep 32-bit indices. Smoothers and inverses rebuild the 32-bit indices.",
+                     py::arg("batch_assembly") = "bool = False\n"
+                     "  Element matrices of simplices with the same vertex ordering are computed\n"
+                     "  in batches of SIMD width, vectorized over the elements. Used for symbolic\n"
+                     "  volume integrators in Id and grad of scalar spaces of uniform order."
                      );
                 })
 
@@ -2414,7 +2462,14 @@ integrator : ngsolve.fem.LFI
                     "  Smoother between multigrid levels, available options are:\n"
                     "    'point': Gauss-Seidel-Smoother\n"
                     "    'line':  Anisotropic smoother\n"
-                    "    'block': Block smoother";
+                    "    'block': Block smoother\n"
+                    "    'chebyshev': Chebyshev-Jacobi smoother, block Jacobi if blocktype is given";
+                  mg_flags["chebyshev_degree"] = "int = 3\n"
+                    "  Degree of the Chebyshev smoother, number of matrix-vector products per step.";
+                  mg_flags["chebyshev_ratio"] = "float = 30\n"
+                    "  The Chebyshev smoother damps the interval [lmax/ratio, lmax].";
+                  mg_flags["chebyshev_evsteps"] = "int = 10\n"
+                    "  Lanczos steps to estimate lmax for the Chebyshev smoother.";
                   mg_flags["coarsetype"] = "string = direct\n"
                     "  How to solve coarse problem.";
                   mg_flags["coarsesmoothingsteps"] = "int = 1\n"
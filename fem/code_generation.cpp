@@ -4,10 +4,17 @@
 #include<l2hofefo.hpp>
 #include<regex>
 
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace ngfem
 {
-    atomic<unsigned> Code::id_counter{0};
-
     void Code::AddLinkFlag(string flag)
     {
         if(std::find(std::begin(link_flags), std::end(link_flags), flag) == std::end(link_flags))
@@ -16,63 +23,204 @@ namespace ngfem
 
     string Code::AddPointer(const void *p)
     {
-        string name = "compiled_code_pointer" + ToString(id_counter++); 
-        top += "extern \"C\" void* " + name + ";\n";
-        stringstream s_ptr;
+        // no literal addresses in the code, so identical kernels give identical sources
+        auto pos = std::find(pointers.begin(), pointers.end(), p);
+        size_t nr = pos - pointers.begin();
+        if(pos == pointers.end())
+          pointers.push_back(p);
+        return "compiled_code_pointers[" + ToString(nr) + "]";
+    }
+
+    // FNV-1a, stable over runs and platforms
+    static string HashCode(const string & s)
+    {
+      uint64_t hash = 14695981039346656037ull;
+      for (unsigned char c : s)
+        {
+          hash ^= c;
+          hash *= 1099511628211ull;
+        }
+      stringstream ss;
+      ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+      return ss.str();
+    }
+
+    static bool FileExists(const string & filename)
+    {
+      ifstream f(filename);
+      return f.good();
+    }
+
+    static string ReadFile(const string & filename)
+    {
+      ifstream f(filename, ios::binary);
+      stringstream ss;
+      ss << f.rdbuf();
+      return ss.str();
+    }
+
+    static void MakeDirectories(const string & path)
+    {
+      for (size_t pos = path.find_first_of("/\\", 1); ; pos = path.find_first_of("/\\", pos+1))
+        {
+          string dir = path.substr(0, pos);
 #ifdef WIN32
-        s_ptr << "0x";
+          _mkdir(dir.c_str());
+#else
+          mkdir(dir.c_str(), 0755);
+#endif
+          if (pos == string::npos) break;
+        }
+    }
+
+    string KernelCacheDirectory()
+    {
+      if (const char * dir = getenv("NGSOLVE_KERNEL_CACHE"))
+        return dir;
+#ifdef WIN32
+      if (const char * dir = getenv("LOCALAPPDATA"))
+        return string(dir) + "\\ngsolve\\kernels";
+#else
+      if (const char * dir = getenv("XDG_CACHE_HOME"))
+        return string(dir) + "/ngsolve/kernels";
+      if (const char * dir = getenv("HOME"))
+        return string(dir) + "/.cache/ngsolve/kernels";
 #endif
-        s_ptr << std::hex << p;
-        pointer += "void *" + name + " = reinterpret_cast<void*>(" + s_ptr.str() + ");\n";
-        return name;
+      return "ngsolve_kernels";
     }
 
+    // exclusive lock on a file, serializes processes building the same kernel
+    class KernelLock
+    {
+#ifndef WIN32
+      int fd;
+    public:
+      KernelLock(const string & filename)
+      {
+        fd = open(filename.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd >= 0) flock(fd, LOCK_EX);
+      }
+      ~KernelLock()
+      {
+        if (fd < 0) return;
+        flock(fd, LOCK_UN);
+        close(fd);
+      }
+#else
+    public:
+      KernelLock(const string & filename) { ; }
+#endif
+    };
+
     unique_ptr<SharedLibrary> CompileCode(const std::vector<string> &codes, const std::vector<string> &link_flags )
     {
-      static int counter = 0;
       static ngstd::Timer tcompile("CompiledCF::Compile");
+      static ngstd::Timer thit("CompiledCF::Compile cache hit");
       static ngstd::Timer tlink("CompiledCF::Link");
-      string object_files;
-      int i = 0;
-      string prefix = "code" + ToString(counter++);
-      for(string code : codes) {
-        string file_prefix = prefix+"_"+ToString(i++);
-        ofstream codefile(file_prefix+".cpp");
-        codefile << code;
-        codefile.close();
-        cout << IM(3) << "compiling..." << endl;
-        tcompile.Start();
+      static atomic<size_t> hits{0}, misses{0};
+
+      // content address of the kernel
+      string key = ngsolve_version;
+      for (auto & code : codes) key += code;
+      for (auto & flag : link_flags) key += flag;
+
+      string dir = KernelCacheDirectory();
+      MakeDirectories(dir);
+      string name = "kernel_" + HashCode(key);
+      string prefix = dir + "/" + name;
 #ifdef WIN32
-        string scompile = "cmd /C \"ngscxx.bat " + file_prefix + ".cpp\"";
-        object_files += file_prefix+".obj ";
+      string libname = prefix + ".dll";
 #else
-        string scompile = "ngscxx -c " + file_prefix + ".cpp -o " + file_prefix + ".o";
-        object_files += file_prefix+".o ";
+      string libname = prefix + ".so";
 #endif
-        int err = system(scompile.c_str());
-        if (err) throw Exception ("problem calling compiler");
-        tcompile.Stop();
-      }
 
-      cout << IM(3) << "linking..." << endl;
-      tlink.Start();
+      auto SameSources = [&] ()
+        {
+          for (size_t i = 0; i < codes.size(); i++)
+            if (ReadFile(prefix+"_"+ToString(i)+".cpp") != codes[i])
+              return false;
+          return true;
+        };
+
+      KernelLock lock(prefix + ".lock");
+      if (FileExists(libname) && SameSources())
+        {
+          RegionTimer reg(thit);
+          hits++;
+          cout << IM(3) << "kernel cache hit: " << libname
+               << " (" << hits << " hits, " << misses << " misses)" << endl;
+        }
+      else
+        {
+          misses++;
+          // build under a name unique to this process, and move the results into place
 #ifdef WIN32
-        string slink = "cmd /C \"ngsld.bat /OUT:" + prefix+".dll " + object_files + "\"";
+          string tmpname = name + "_" + ToString(GetCurrentProcessId());
 #else
-        string slink = "ngsld -shared " + object_files + " -o " + prefix + ".so -lngstd -lngbla -lngfem -lngcore";
-        for (auto flag : link_flags)
-            slink += " "+flag;
+          char host[256] = "";
+          gethostname(host, sizeof(host)-1);
+          string tmpname = name + "_" + host + "_" + ToString(getpid());
 #endif
-      int err = system(slink.c_str());
-      if (err) throw Exception ("problem calling linker");      
-      tlink.Stop();
-      cout << IM(3) << "done" << endl;
-      auto library = make_unique<SharedLibrary>();
+          string tmpprefix = dir + "/" + tmpname;
+          string object_files;
+          std::vector<string> tmpfiles;
+          for (size_t i = 0; i < codes.size(); i++) {
+            string file_prefix = tmpprefix+"_"+ToString(i);
+            ofstream codefile(file_prefix+".cpp");
+            codefile << codes[i];
+            codefile.close();
+            cout << IM(3) << "compiling..." << endl;
+            tcompile.Start();
 #ifdef WIN32
-      library->Load(prefix+".dll");
+            string scompile = "cmd /C \"cd /D " + dir + " && ngscxx.bat " + tmpname+"_"+ToString(i) + ".cpp\"";
+            object_files += tmpname+"_"+ToString(i)+".obj ";
 #else
-      library->Load("./"+prefix+".so");
+            string scompile = "ngscxx -c " + file_prefix + ".cpp -o " + file_prefix + ".o";
+            object_files += file_prefix+".o ";
 #endif
+            int err = system(scompile.c_str());
+            if (err) throw Exception ("problem calling compiler");
+            tcompile.Stop();
+#ifdef WIN32
+            tmpfiles.push_back(file_prefix+".obj");
+#else
+            tmpfiles.push_back(file_prefix+".o");
+#endif
+          }
+
+          cout << IM(3) << "linking..." << endl;
+          tlink.Start();
+#ifdef WIN32
+          string slink = "cmd /C \"cd /D " + dir + " && ngsld.bat /OUT:" + tmpname+".dll " + object_files + "\"";
+          string tmplib = tmpprefix + ".dll";
+#else
+          string slink = "ngsld -shared " + object_files + " -o " + tmpprefix + ".so -lngstd -lngbla -lngfem -lngcore";
+          for (auto flag : link_flags)
+              slink += " "+flag;
+          string tmplib = tmpprefix + ".so";
+#endif
+          int err = system(slink.c_str());
+          if (err) throw Exception ("problem calling linker");      
+          tlink.Stop();
+
+          // sources first, a library without matching sources is never used
+          for (size_t i = 0; i < codes.size(); i++)
+            {
+              string src = prefix+"_"+ToString(i)+".cpp";
+              remove(src.c_str());
+              rename((tmpprefix+"_"+ToString(i)+".cpp").c_str(), src.c_str());
+            }
+          remove(libname.c_str());
+          if (rename(tmplib.c_str(), libname.c_str()))
+            throw Exception ("cannot move compiled kernel to " + libname);
+          for (auto & f : tmpfiles)
+            remove(f.c_str());
+          cout << IM(3) << "done, kernel cache miss: " << libname
+               << " (" << hits << " hits, " << misses << " misses)" << endl;
+        }
+
+      auto library = make_unique<SharedLibrary>();
+      library->Load(libname);
       return library;
     }
 
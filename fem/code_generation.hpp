@@ -47,13 +47,13 @@ namespace ngfem
     int deriv;
     std::vector<string> link_flags;
 
-    string pointer;
+    /// addresses used by the code, passed at runtime as compiled_code_pointers
+    std::vector<const void*> pointers;
 
     string AddPointer(const void *p );
 
     void AddLinkFlag(string flag);
 
-    static atomic<unsigned> id_counter;
     static string Map( string code, std::map<string,string> variables ) {
       for ( auto mapping : variables ) {
         string oldStr = '{'+mapping.first+'}';
@@ -177,7 +177,10 @@ namespace ngfem
     }
   }
 
+  /// compiles and links the codes, or loads them from the kernel cache
   unique_ptr<SharedLibrary> CompileCode(const std::vector<string> &codes, const std::vector<string> &libraries );
+  /// directory of the kernel cache, from NGSOLVE_KERNEL_CACHE or the user cache directory
+  string KernelCacheDirectory();
   namespace detail {
       string GenerateL2ElementCode(int order);
   }
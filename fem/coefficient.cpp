@@ -11,6 +11,7 @@
 #include <fem.hpp>
 #include <../ngstd/evalfunc.hpp>
 #include <algorithm>
+#include <future>
 #ifdef NGS_PYTHON
 #include <core/python_ngcore.hpp> // for shallow archive
 #endif // NGS_PYTHON
@@ -1023,6 +1024,8 @@ public:
     archive.Shallow(c1) & scal;
   }
 
+  double GetScalar () const { return scal; }
+
   virtual void PrintReport (ostream & ost) const override
   {
     ost << scal << "*(";
@@ -3990,6 +3993,8 @@ public:
     BASE::DoArchive(ar);
     ar.Shallow(c1) & dim1 & comp;
   }
+
+  int GetComponent () const { return comp; }
   
   virtual void GenerateCode(Code &code, FlatArray<int> inputs, int index) const override
   {
@@ -5319,18 +5324,362 @@ shared_ptr<CoefficientFunction> Freeze (shared_ptr<CoefficientFunction> cf)
 
 
 
+  // ///////////////////////////// SIMD bytecode /////////////////////////
+
+  /*
+    In-process evaluation of the steps of a compiled CF for the
+    SIMD<double> path, no external compiler needed.
+
+    Every step owns a block of rows (one row of SIMD<double> per
+    component over all points of the rule). Arithmetic steps are
+    translated to instructions working on rows, products feeding
+    a single sum are fused to multiply-add, components and
+    vectorial CFs become row aliases and copies. All other steps
+    are evaluated by their own Evaluate on the rows of their inputs.
+    Rows are reused as soon as the owning step is no longer needed.
+   */
+  class SIMDBytecode
+  {
+    enum OPCODE { OP_CONST, OP_COORD, OP_COPY, OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+                  OP_SCALE, OP_FMA, OP_STEP };
+    struct Instruction
+    {
+      OPCODE op;
+      int dst, a, b, c;  // rows, for OP_STEP: a,b ... range in args, c ... dim
+      double val;
+      CoefficientFunction * cf;
+    };
+
+    Array<Instruction> program;
+    Array<int> args;        // (row, dim) of inputs of OP_STEP
+    size_t nrows = 0;       // rows of temporary memory, result rows follow
+    size_t outdim = 0;
+    size_t max_inputsize = 0;
+    bool uses_coords = false;
+
+  public:
+    SIMDBytecode (FlatArray<CoefficientFunction*> steps, const DynamicTable<int> & inputs)
+    {
+      static Timer t("CompiledCF::Bytecode"); RegionTimer reg(t);
+      size_t n = steps.Size();
+      size_t last = n-1;
+      enum KIND { GENERIC, CONST, COORD, COMPONENT, ADD, SUB, MUL, DIV, SCALE,
+                  SCALVEC, INNER, VECTORIAL };
+      Array<KIND> kind(n);
+      Array<int> dims(n);
+
+      for (size_t i = 0; i < n; i++)
+        {
+          auto step = steps[i];
+          auto in = inputs[i];
+          dims[i] = step->Dimension();
+          kind[i] = GENERIC;
+          string descr = step->GetDescription();
+
+          auto InputsHaveDim = [&] (int d)
+            {
+              for (int j : in)
+                if (steps[j]->Dimension() != d)
+                  return false;
+              return true;
+            };
+
+          if (dynamic_cast<ConstantCoefficientFunction*> (step))
+            kind[i] = CONST;
+          else if (dynamic_cast<CoordCoefficientFunction*> (step) &&
+                   (descr == "coordinate x" || descr == "coordinate y" || descr == "coordinate z"))
+            kind[i] = COORD;
+          else if (dynamic_cast<ComponentCoefficientFunction*> (step) && in.Size() == 1)
+            kind[i] = COMPONENT;
+          else if (descr.find("binary operation '") == 0 && descr.size() == 20 &&
+                   in.Size() == 2 && InputsHaveDim(dims[i]))
+            switch (descr[18])
+              {
+              case '+': kind[i] = ADD; break;
+              case '-': kind[i] = SUB; break;
+              case '*': kind[i] = MUL; break;
+              case '/': kind[i] = DIV; break;
+              default: break;
+              }
+          else if (dynamic_cast<ScaleCoefficientFunction*> (step) && in.Size() == 1)
+            kind[i] = SCALE;
+          else if (dynamic_cast<MultScalVecCoefficientFunction*> (step) && in.Size() == 2 &&
+                   steps[in[0]]->Dimension() == 1 && steps[in[1]]->Dimension() == dims[i])
+            kind[i] = SCALVEC;
+          else if ((dynamic_cast<MultVecVecCoefficientFunction*> (step) ||
+                    descr.find("innerproduct") == 0) &&
+                   in.Size() == 2 && dims[i] == 1 &&
+                   steps[in[0]]->Dimension() == steps[in[1]]->Dimension())
+            kind[i] = INNER;
+          else if (dynamic_cast<VectorialCoefficientFunction*> (step))
+            {
+              int sum = 0;
+              for (int j : in) sum += dims[j];
+              if (sum == dims[i]) kind[i] = VECTORIAL;
+            }
+        }
+
+      // products used by a single sum only are fused to multiply-add
+      Array<int> usecount(n);
+      usecount = 0;
+      for (size_t i = 0; i < n; i++)
+        for (int j : inputs[i])
+          usecount[j]++;
+      Array<bool> fused(n);
+      fused = false;
+      for (size_t i = 0; i < n; i++)
+        if (kind[i] == ADD)
+          for (int j : inputs[i])
+            if (kind[j] == MUL && usecount[j] == 1 && j != int(last))
+              {
+                fused[j] = true;
+                break;
+              }
+
+      // components share the rows of their input
+      Array<int> owner(n);
+      for (size_t i = 0; i < n; i++)
+        owner[i] = (kind[i] == COMPONENT && i != last) ? owner[inputs[i][0]] : i;
+
+      auto EffectiveInputs = [&] (int i)
+        {
+          Array<int> eff;
+          for (int j : inputs[i])
+            if (fused[j])
+              for (int k : inputs[j]) eff.Append (k);
+            else
+              eff.Append (j);
+          return eff;
+        };
+
+      Array<int> lastuse(n);
+      lastuse = -1;
+      for (size_t i = 0; i < n; i++)
+        if (!fused[i])
+          for (int j : EffectiveInputs(i))
+            lastuse[owner[j]] = max2(lastuse[owner[j]], int(i));
+
+      // row allocation, first fit
+      Array<int> rowowner;
+      Array<int> base(n);
+      base = -1;
+      auto Allocate = [&] (int i, int d)
+        {
+          for (auto & o : rowowner)
+            if (o >= 0 && lastuse[o] < i) o = -1;
+          size_t first = 0;
+          while (true)
+            {
+              size_t k = 0;
+              while (k < size_t(d) && first+k < rowowner.Size() && rowowner[first+k] == -1) k++;
+              if (k == size_t(d) || first+k == rowowner.Size()) break;
+              first += k+1;
+            }
+          while (rowowner.Size() < first+d)
+            rowowner.Append (-1);
+          for (int k = 0; k < d; k++)
+            rowowner[first+k] = i;
+          return int(first);
+        };
+
+      for (size_t i = 0; i < n; i++)
+        {
+          if (fused[i]) continue;
+          auto in = inputs[i];
+          if (i == last)
+            {
+              nrows = rowowner.Size();
+              base[i] = nrows;
+            }
+          else if (kind[i] == COMPONENT)
+            {
+              base[i] = base[in[0]] + dynamic_cast<ComponentCoefficientFunction*>(steps[i])->GetComponent();
+              continue;
+            }
+          else
+            base[i] = Allocate (i, dims[i]);
+
+          int d = base[i];
+          switch (kind[i])
+            {
+            case CONST:
+              program.Append ( { OP_CONST, d, 0, 0, 0, steps[i]->EvaluateConst(), nullptr } );
+              break;
+            case COORD:
+              program.Append ( { OP_COORD, d, steps[i]->GetDescription().back()-'x', 0, 0, 0, nullptr } );
+              uses_coords = true;
+              break;
+            case COMPONENT:
+              program.Append ( { OP_COPY, d, base[in[0]] + dynamic_cast<ComponentCoefficientFunction*>(steps[i])->GetComponent(),
+                                 0, 0, 0, nullptr } );
+              break;
+            case ADD:
+              {
+                int prod = fused[in[0]] ? in[0] : (fused[in[1]] ? in[1] : -1);
+                for (int k = 0; k < dims[i]; k++)
+                  if (prod >= 0)
+                    {
+                      int other = prod == in[0] ? in[1] : in[0];
+                      program.Append ( { OP_FMA, d+k, base[inputs[prod][0]]+k, base[inputs[prod][1]]+k,
+                                         base[other]+k, 0, nullptr } );
+                    }
+                  else
+                    program.Append ( { OP_ADD, d+k, base[in[0]]+k, base[in[1]]+k, 0, 0, nullptr } );
+                break;
+              }
+            case SUB: case MUL: case DIV:
+              {
+                OPCODE op = kind[i] == SUB ? OP_SUB : (kind[i] == MUL ? OP_MUL : OP_DIV);
+                for (int k = 0; k < dims[i]; k++)
+                  program.Append ( { op, d+k, base[in[0]]+k, base[in[1]]+k, 0, 0, nullptr } );
+                break;
+              }
+            case SCALE:
+              {
+                double scal = dynamic_cast<ScaleCoefficientFunction*>(steps[i])->GetScalar();
+                for (int k = 0; k < dims[i]; k++)
+                  program.Append ( { OP_SCALE, d+k, base[in[0]]+k, 0, 0, scal, nullptr } );
+                break;
+              }
+            case SCALVEC:
+              for (int k = 0; k < dims[i]; k++)
+                program.Append ( { OP_MUL, d+k, base[in[0]], base[in[1]]+k, 0, 0, nullptr } );
+              break;
+            case INNER:
+              program.Append ( { OP_MUL, d, base[in[0]], base[in[1]], 0, 0, nullptr } );
+              for (int k = 1; k < dims[in[0]]; k++)
+                program.Append ( { OP_FMA, d, base[in[0]]+k, base[in[1]]+k, d, 0, nullptr } );
+              break;
+            case VECTORIAL:
+              {
+                int k = 0;
+                for (int j : in)
+                  for (int l = 0; l < dims[j]; l++, k++)
+                    program.Append ( { OP_COPY, d+k, base[j]+l, 0, 0, 0, nullptr } );
+                break;
+              }
+            default:
+              {
+                int first = args.Size();
+                for (int j : in)
+                  {
+                    args.Append (base[j]);
+                    args.Append (dims[j]);
+                  }
+                max_inputsize = max2(max_inputsize, in.Size());
+                program.Append ( { OP_STEP, d, first, int(in.Size()), dims[i], 0, steps[i] } );
+              }
+            }
+        }
+      outdim = dims[last];
+      cout << IM(3) << "CompiledCF bytecode: " << program.Size() << " instructions, "
+           << nrows << " rows" << endl;
+    }
+
+    // returns false if the rule cannot be handled
+    bool Run (const SIMD_BaseMappedIntegrationRule & ir, BareSliceMatrix<SIMD<double>> values) const
+    {
+      if (uses_coords && ir.IsComplex())
+        return false;
+
+      size_t npts = ir.Size();
+      ArrayMem<SIMD<double>, 1000> hmem(nrows*npts);
+      ArrayMem<SIMD<double>*, 100> rows(nrows+outdim);
+      for (size_t r = 0; r < nrows; r++)
+        rows[r] = hmem.Data() + r*npts;
+      for (size_t k = 0; k < outdim; k++)
+        rows[nrows+k] = &values(k,0);
+      ArrayMem<BareSliceMatrix<SIMD<double>>,100> in(max_inputsize);
+
+      for (const Instruction & instr : program)
+        {
+          SIMD<double> * d = rows[instr.dst];
+          switch (instr.op)
+            {
+            case OP_CONST:
+              for (size_t j = 0; j < npts; j++) d[j] = instr.val;
+              break;
+            case OP_COORD:
+              {
+                auto points = ir.GetPoints();
+                for (size_t j = 0; j < npts; j++) d[j] = points(j, instr.a);
+                break;
+              }
+            case OP_COPY:
+              {
+                auto a = rows[instr.a];
+                for (size_t j = 0; j < npts; j++) d[j] = a[j];
+                break;
+              }
+            case OP_ADD:
+              {
+                auto a = rows[instr.a], b = rows[instr.b];
+                for (size_t j = 0; j < npts; j++) d[j] = a[j]+b[j];
+                break;
+              }
+            case OP_SUB:
+              {
+                auto a = rows[instr.a], b = rows[instr.b];
+                for (size_t j = 0; j < npts; j++) d[j] = a[j]-b[j];
+                break;
+              }
+            case OP_MUL:
+              {
+                auto a = rows[instr.a], b = rows[instr.b];
+                for (size_t j = 0; j < npts; j++) d[j] = a[j]*b[j];
+                break;
+              }
+            case OP_DIV:
+              {
+                auto a = rows[instr.a], b = rows[instr.b];
+                for (size_t j = 0; j < npts; j++) d[j] = a[j]/b[j];
+                break;
+              }
+            case OP_SCALE:
+              {
+                auto a = rows[instr.a];
+                for (size_t j = 0; j < npts; j++) d[j] = instr.val*a[j];
+                break;
+              }
+            case OP_FMA:
+              {
+                auto a = rows[instr.a], b = rows[instr.b], c = rows[instr.c];
+                for (size_t j = 0; j < npts; j++) d[j] = FMA(a[j], b[j], c[j]);
+                break;
+              }
+            case OP_STEP:
+              {
+                int nin = instr.b;
+                for (int k = 0; k < nin; k++)
+                  {
+                    int row = args[instr.a+2*k], dim = args[instr.a+2*k+1];
+                    new (&in[k]) BareSliceMatrix<SIMD<double>> (FlatMatrix<SIMD<double>> (dim, npts, rows[row]));
+                  }
+                if (size_t(instr.dst) >= nrows)
+                  instr.cf -> Evaluate (ir, in.Range(0, nin), values);
+                else
+                  instr.cf -> Evaluate (ir, in.Range(0, nin),
+                                        FlatMatrix<SIMD<double>> (instr.c, npts, d));
+                break;
+              }
+            }
+        }
+      return true;
+    }
+  };
+
   // ///////////////////////////// Compiled CF /////////////////////////
 class CompiledCoefficientFunction : public CoefficientFunction //, public std::enable_shared_from_this<CompiledCoefficientFunction>
   {
-    typedef void (*lib_function)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<double>);
-    typedef void (*lib_function_simd)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<SIMD<double>>);
-    typedef void (*lib_function_deriv)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<AutoDiff<1,double>>);
-    typedef void (*lib_function_simd_deriv)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<AutoDiff<1,SIMD<double>>>);
-    typedef void (*lib_function_dderiv)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<AutoDiffDiff<1,double>>);
-    typedef void (*lib_function_simd_dderiv)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<AutoDiffDiff<1,SIMD<double>>>);
+    typedef void (*lib_function)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<double>, void **);
+    typedef void (*lib_function_simd)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<SIMD<double>>, void **);
+    typedef void (*lib_function_deriv)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<AutoDiff<1,double>>, void **);
+    typedef void (*lib_function_simd_deriv)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<AutoDiff<1,SIMD<double>>>, void **);
+    typedef void (*lib_function_dderiv)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<AutoDiffDiff<1,double>>, void **);
+    typedef void (*lib_function_simd_dderiv)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<AutoDiffDiff<1,SIMD<double>>>, void **);
 
-    typedef void (*lib_function_complex)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<Complex>);
-    typedef void (*lib_function_simd_complex)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<SIMD<Complex>>);
+    typedef void (*lib_function_complex)(const ngfem::BaseMappedIntegrationRule &, ngbla::BareSliceMatrix<Complex>, void **);
+    typedef void (*lib_function_simd_complex)(const ngfem::SIMD_BaseMappedIntegrationRule &, BareSliceMatrix<SIMD<Complex>>, void **);
 
     shared_ptr<CoefficientFunction> cf;
     Array<CoefficientFunction*> steps;
@@ -5341,58 +5690,215 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     Array<bool> is_complex;
     // Array<Timer*> timers;
     unique_ptr<SharedLibrary> library;
-    lib_function compiled_function = nullptr;
-    lib_function_simd compiled_function_simd = nullptr;
-    lib_function_deriv compiled_function_deriv = nullptr;
-    lib_function_simd_deriv compiled_function_simd_deriv = nullptr;
-    lib_function_dderiv compiled_function_dderiv = nullptr;
-    lib_function_simd_dderiv compiled_function_simd_dderiv = nullptr;
-
-    lib_function_complex compiled_function_complex = nullptr;
-    lib_function_simd_complex compiled_function_simd_complex = nullptr;
-
-  public:
-    CompiledCoefficientFunction() = default;
-    CompiledCoefficientFunction (shared_ptr<CoefficientFunction> acf)
-      : CoefficientFunction(acf->Dimension(), acf->IsComplex()), cf(acf) // , compiled_function(nullptr), compiled_function_simd(nullptr)
+    /// runtime arguments of the compiled code (addresses of steps, parameters, ...)
+    Array<void*> code_pointers;
+    // set by the compile thread, until then the steps are interpreted
+    std::atomic<lib_function> compiled_function{nullptr};
+    std::atomic<lib_function_simd> compiled_function_simd{nullptr};
+    std::atomic<lib_function_deriv> compiled_function_deriv{nullptr};
+    std::atomic<lib_function_simd_deriv> compiled_function_simd_deriv{nullptr};
+    std::atomic<lib_function_dderiv> compiled_function_dderiv{nullptr};
+    std::atomic<lib_function_simd_dderiv> compiled_function_simd_dderiv{nullptr};
+
+    std::atomic<lib_function_complex> compiled_function_complex{nullptr};
+    std::atomic<lib_function_simd_complex> compiled_function_simd_complex{nullptr};
+    std::atomic<bool> compiled{false};
+    /// ready when a started compilation has finished (successful or not)
+    std::shared_future<void> compilation;
+    /// constants created by folding, the steps hold raw pointers
+    Array<shared_ptr<CoefficientFunction>> folded_constants;
+    /// in-process evaluation of the SIMD<double> path
+    unique_ptr<SIMDBytecode> bytecode;
+
+    void BuildSteps ()
     {
-      SetDimensions (cf->Dimensions());
+      steps.SetSize0();
       cf -> TraverseTree
         ([&] (CoefficientFunction & stepcf)
          {
            if (!steps.Contains(&stepcf))
-             {
-               steps.Append (&stepcf);
-               // timers.Append (new Timer(string("CompiledCF")+typeid(stepcf).name()));
-               dim.Append (stepcf.Dimension());
-               is_complex.Append (stepcf.IsComplex());
-             }
+             steps.Append (&stepcf);
          });
-      
+
+      Array<Array<int>> ins(steps.Size());
+      cf -> TraverseTree
+        ([&] (CoefficientFunction & stepcf)
+         {
+           int mypos = steps.Pos (&stepcf);
+           if (!ins[mypos].Size())
+             for (auto incf : stepcf.InputCoefficientFunctions())
+               ins[mypos].Append (steps.Pos(incf.get()));
+         });
+
+      OptimizeSteps (ins);
+
+      dim.SetSize0();
+      is_complex.SetSize0();
+      for (auto step : steps)
+        {
+          dim.Append (step->Dimension());
+          is_complex.Append (step->IsComplex());
+        }
       totdim = 0;
       for (int d : dim) totdim += d;
-      
+
       cout << IM(3) << "Compiled CF:" << endl;
       for (auto cf : steps)
         cout << IM(3) << typeid(*cf).name() << endl;
-      
+
       inputs = DynamicTable<int> (steps.Size());
       max_inputsize = 0;
-      
-      cf -> TraverseTree
-        ([&] (CoefficientFunction & stepcf)
-         {
-           int mypos = steps.Pos (&stepcf);
-           if (!inputs[mypos].Size())
-             {
-               Array<shared_ptr<CoefficientFunction>> in = stepcf.InputCoefficientFunctions();
-               max_inputsize = max2(in.Size(), max_inputsize);
-               for (auto incf : in)
-                 inputs.Add (mypos, steps.Pos(incf.get()));
-             }
-         });
+      for (size_t i : Range(steps))
+        {
+          max_inputsize = max2(ins[i].Size(), max_inputsize);
+          for (int in : ins[i])
+            inputs.Add (i, in);
+        }
       cout << IM(3) << "inputs = " << endl << inputs << endl;
+    }
+
+    // structural key of a step, built from the code it generates for given inputs
+    string StepKey (CoefficientFunction & step, FlatArray<int> ins) const
+    {
+      stringstream key;
+      key << typeid(step).name() << " " << ToString(step.Dimensions()) << " " << step.IsComplex() << " ";
+      try
+        {
+          Code code;
+          code.is_simd = false;
+          code.deriv = 0;
+          code.res_type = step.IsComplex() ? "Complex" : "double";
+          step.GenerateCode (code, ins, 1000000);
+          key << code.top << code.header << code.body;
+          for (auto p : code.pointers)
+            key << " " << p;
+        }
+      catch (Exception &)
+        {
+          // cannot compare, the step stays unique
+          key << &step;
+        }
+      return key.str();
+    }
+
+    /*
+      Common sub-expression elimination and algebraic simplification
+      on the list of steps: structurally equal steps are merged, trivial
+      operations (x*1, x+0, scale 1, transpose of transpose) are replaced
+      by their argument, and scalar operations on constants are folded.
+      Steps are in topological order, inputs refer to earlier steps.
+     */
+    void OptimizeSteps (Array<Array<int>> & ins)
+    {
+      static Timer t("CompiledCF::OptimizeSteps"); RegionTimer reg(t);
+      size_t n = steps.Size();
+      Array<int> repr(n);
+      std::map<string,int> known;
+
+      auto IsConstant = [&] (int k, double val)
+        {
+          auto c = dynamic_cast<ConstantCoefficientFunction*> (steps[k]);
+          return c && c->EvaluateConst() == val;
+        };
+
+      for (size_t i = 0; i < n; i++)
+        {
+          for (int & in : ins[i])
+            in = repr[in];
+          auto step = steps[i];
+          string descr = step->GetDescription();
+          repr[i] = i;
+
+          // the final step is the result, it is never replaced
+          if (i < n-1)
+            {
+              int alias = -1;
+              if (descr == "binary operation '*'")
+                {
+                  if (IsConstant(ins[i][1], 1)) alias = ins[i][0];
+                  else if (IsConstant(ins[i][0], 1)) alias = ins[i][1];
+                }
+              else if (descr == "binary operation '+'")
+                {
+                  if (IsConstant(ins[i][1], 0)) alias = ins[i][0];
+                  else if (IsConstant(ins[i][0], 0)) alias = ins[i][1];
+                }
+              else if (descr == "scale 1" && ins[i].Size() == 1)
+                alias = ins[i][0];
+              else if (descr == "Matrix transpose" &&
+                       steps[ins[i][0]]->GetDescription() == "Matrix transpose")
+                alias = ins[ins[i][0]][0];
+
+              if (alias >= 0 &&
+                  ToString(steps[alias]->Dimensions()) == ToString(step->Dimensions()) &&
+                  steps[alias]->IsComplex() == step->IsComplex())
+                {
+                  repr[i] = alias;
+                  continue;
+                }
+            }
+
+          // scalar operations on constants
+          if (ins[i].Size() && !step->IsComplex() && step->Dimension() == 1 &&
+              (descr.find("unary operation") == 0 || descr.find("binary operation") == 0 ||
+               descr.find("scale ") == 0))
+            {
+              bool allconst = true;
+              for (int in : ins[i])
+                if (!dynamic_cast<ConstantCoefficientFunction*> (steps[in]))
+                  allconst = false;
+              if (allconst)
+                try
+                  {
+                    auto c = make_shared<ConstantCoefficientFunction> (step->EvaluateConst());
+                    folded_constants.Append (c);
+                    steps[i] = c.get();
+                    ins[i].SetSize0();
+                  }
+                catch (Exception &) { ; }
+            }
+
+          auto [pos, isnew] = known.emplace (StepKey (*steps[i], ins[i]), i);
+          if (!isnew && i < n-1)
+            repr[i] = pos->second;
+        }
+
+      // keep the steps the result depends on
+      Array<bool> used(n);
+      used = false;
+      used[n-1] = true;
+      for (size_t i = n; i-- > 0; )
+        if (used[i])
+          for (int in : ins[i])
+            used[in] = true;
+
+      Array<int> newnr(n);
+      Array<CoefficientFunction*> newsteps;
+      Array<Array<int>> newins;
+      for (size_t i = 0; i < n; i++)
+        if (used[i])
+          {
+            newnr[i] = newsteps.Size();
+            newsteps.Append (steps[i]);
+            Array<int> in;
+            for (int j : ins[i])
+              in.Append (newnr[j]);
+            newins.Append (std::move(in));
+          }
 
+      if (newsteps.Size() < n)
+        cout << IM(3) << "CompiledCF: reduced " << n << " steps to " << newsteps.Size() << endl;
+      steps = std::move(newsteps);
+      ins = std::move(newins);
+    }
+
+  public:
+    CompiledCoefficientFunction() = default;
+    CompiledCoefficientFunction (shared_ptr<CoefficientFunction> acf)
+      : CoefficientFunction(acf->Dimension(), acf->IsComplex()), cf(acf) // , compiled_function(nullptr), compiled_function_simd(nullptr)
+    {
+      SetDimensions (cf->Dimensions());
+      BuildSteps();
     }
 
 
@@ -5446,37 +5952,18 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
       ar.Shallow(cf);
       if(ar.Input())
         {
-          cf -> TraverseTree
-            ([&] (CoefficientFunction & stepcf)
-             {
-               if (!steps.Contains(&stepcf))
-                 {
-                   steps.Append (&stepcf);
-                   // timers.Append (new Timer(string("CompiledCF")+typeid(stepcf).name()));
-                   dim.Append (stepcf.Dimension());
-                   is_complex.Append (stepcf.IsComplex());
-                 }
-             });
-          totdim = 0;
-          for (int d : dim) totdim += d;
-          inputs = DynamicTable<int> (steps.Size());
-          max_inputsize = 0;
-
-          cf -> TraverseTree
-            ([&] (CoefficientFunction & stepcf)
-             {
-               int mypos = steps.Pos (&stepcf);
-               if (!inputs[mypos].Size())
-                 {
-                   Array<shared_ptr<CoefficientFunction>> in = stepcf.InputCoefficientFunctions();
-                   max_inputsize = max2(in.Size(), max_inputsize);
-                   for (auto incf : in)
-                     inputs.Add (mypos, steps.Pos(incf.get()));
-                 }
-             });
+          BuildSteps();
+          BuildBytecode();
         }
     }
 
+    void BuildBytecode ()
+    {
+      for (bool c : is_complex)
+        if (c) return;
+      bytecode = make_unique<SIMDBytecode> (steps, inputs);
+    }
+
 
     virtual shared_ptr<CoefficientFunction>
     Diff (const CoefficientFunction * var, shared_ptr<CoefficientFunction> dir) const override
@@ -5493,7 +5980,7 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
         if(cf->IsComplex())
             maxderiv = 0;
         stringstream s;
-        string pointer_code;
+        std::vector<const void*> pointers;
         string top_code = ""
              "#include<fem.hpp>\n"
              "using namespace ngfem;\n"
@@ -5515,6 +6002,7 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
             if(deriv==1) res_type = "AutoDiff<1," + res_type + ">";
             if(deriv==2) res_type = "AutoDiffDiff<1," + res_type + ">";
             code.res_type = res_type;
+            code.pointers = std::move(pointers);
 
             for (auto i : Range(steps)) {
               auto& step = *steps[i];
@@ -5523,7 +6011,7 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
               step.GenerateCode(code, inputs[i],i);
             }
 
-            pointer_code += code.pointer;
+            pointers = std::move(code.pointers);
             top_code += code.top;
 
             // set results
@@ -5586,7 +6074,7 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
                   s << ", " << param_type << parameters[i];
                 */
               }
-            s << " ) {" << endl;
+            s << ", void ** compiled_code_pointers ) {" << endl;
             s << code.header << endl;
             s << "[[maybe_unused]] auto points = mir.GetPoints();" << endl;
             s << "[[maybe_unused]] auto domain_index = mir.GetTransformation().GetElementIndex();" << endl;
@@ -5604,49 +6092,84 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
         string file_code = top_code + s.str();
         std::vector<string> codes;
         codes.push_back(file_code);
-        if(pointer_code.size()) {
-          pointer_code = "extern \"C\" {\n" + pointer_code;
-          pointer_code += "}\n";
-          codes.push_back(pointer_code);
-        }
+
+        code_pointers.SetSize(pointers.size());
+        for (auto i : Range(pointers.size()))
+          code_pointers[i] = const_cast<void*>(pointers[i]);
 
         auto self = dynamic_pointer_cast<CompiledCoefficientFunction>(shared_from_this());
-        auto compile_func = [self, codes, link_flags, maxderiv] () {
-              self->library = CompileCode( codes, link_flags );
-              if(self->cf->IsComplex())
+        std::promise<void> done;
+        compilation = done.get_future().share();
+        auto compile_func = [self, codes, link_flags, maxderiv, wait, done = std::move(done)] () mutable {
+            try
               {
-                  self->compiled_function_simd_complex = self->library->GetFunction<lib_function_simd_complex>("CompiledEvaluateSIMD");
-                  self->compiled_function_complex = self->library->GetFunction<lib_function_complex>("CompiledEvaluate");
-              }
-              else
-              {
-                  self->compiled_function_simd = self->library->GetFunction<lib_function_simd>("CompiledEvaluateSIMD");
-                  self->compiled_function = self->library->GetFunction<lib_function>("CompiledEvaluate");
-                  if(maxderiv>0)
+                self->library = CompileCode( codes, link_flags );
+                auto & lib = *self->library;
+                auto Publish = [&lib] (auto & func, string name)
+                  {
+                    using T = typename std::remove_reference_t<decltype(func)>::value_type;
+                    func.store (lib.GetFunction<T>(name), std::memory_order_release);
+                  };
+                if(self->cf->IsComplex())
                   {
-                      self->compiled_function_simd_deriv = self->library->GetFunction<lib_function_simd_deriv>("CompiledEvaluateDerivSIMD");
-                      self->compiled_function_deriv = self->library->GetFunction<lib_function_deriv>("CompiledEvaluateDeriv");
+                    Publish (self->compiled_function_simd_complex, "CompiledEvaluateSIMD");
+                    Publish (self->compiled_function_complex, "CompiledEvaluate");
                   }
-                  if(maxderiv>1)
+                else
                   {
-                      self->compiled_function_simd_dderiv = self->library->GetFunction<lib_function_simd_dderiv>("CompiledEvaluateDDerivSIMD");
-                      self->compiled_function_dderiv = self->library->GetFunction<lib_function_dderiv>("CompiledEvaluateDDeriv");
+                    Publish (self->compiled_function_simd, "CompiledEvaluateSIMD");
+                    Publish (self->compiled_function, "CompiledEvaluate");
+                    if(maxderiv>0)
+                      {
+                        Publish (self->compiled_function_simd_deriv, "CompiledEvaluateDerivSIMD");
+                        Publish (self->compiled_function_deriv, "CompiledEvaluateDeriv");
+                      }
+                    if(maxderiv>1)
+                      {
+                        Publish (self->compiled_function_simd_dderiv, "CompiledEvaluateDDerivSIMD");
+                        Publish (self->compiled_function_dderiv, "CompiledEvaluateDDeriv");
+                      }
                   }
+                self->compiled.store (true, std::memory_order_release);
+                cout << IM(7) << "Compilation done" << endl;
               }
-              cout << IM(7) << "Compilation done" << endl;
+            catch (const std::exception & e)
+              {
+                done.set_value();
+                if (wait) throw;
+                // keep on interpreting
+                cerr << IM(3) << "Compilation of CoefficientFunction failed: " << e.what() << endl;
+                return;
+              }
+            done.set_value();
         };
         if(wait)
             compile_func();
         else
         {
           try {
-            std::thread( compile_func ).detach();
+            std::thread( std::move(compile_func) ).detach();
           } catch (const std::exception &e) {
               cerr << IM(3) << "Compilation of CoefficientFunction failed: " << e.what() << endl;
           }
         }
     }
 
+    bool IsCompiled () const { return compiled.load(std::memory_order_acquire); }
+
+    // waits for a running compilation, negative timeout waits forever
+    bool WaitCompiled (double timeout) const
+    {
+      if (compilation.valid())
+        {
+          if (timeout < 0)
+            compilation.wait();
+          else if (compilation.wait_for (std::chrono::duration<double>(timeout)) != std::future_status::ready)
+            return false;
+        }
+      return IsCompiled();
+    }
+
     void TraverseTree (const function<void(CoefficientFunction&)> & func) override
     {
       cf -> TraverseTree (func);
@@ -5765,9 +6288,9 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     
     void Evaluate (const BaseMappedIntegrationRule & ir, BareSliceMatrix<double> values) const override
     {
-      if(compiled_function)
+      if(auto func = compiled_function.load(std::memory_order_acquire))
       {
-        compiled_function(ir,values);
+        func(ir, values, code_pointers.Data());
         return;
       }
 
@@ -5817,9 +6340,9 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     void Evaluate (const BaseMappedIntegrationRule & ir,
                    BareSliceMatrix<AutoDiff<1,double>> values) const override
     {
-      if(compiled_function_deriv)
+      if(auto func = compiled_function_deriv.load(std::memory_order_acquire))
         {
-          compiled_function_deriv(ir, values);
+          func(ir, values, code_pointers.Data());
           return;
         }
 
@@ -5856,9 +6379,9 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     void Evaluate (const BaseMappedIntegrationRule & ir,
                    BareSliceMatrix<AutoDiffDiff<1,double>> values) const override
     {
-      if(compiled_function_dderiv)
+      if(auto func = compiled_function_dderiv.load(std::memory_order_acquire))
       {
-        compiled_function_dderiv(ir, values);
+        func(ir, values, code_pointers.Data());
         return;
       }
 
@@ -5895,9 +6418,9 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     void Evaluate (const SIMD_BaseMappedIntegrationRule & ir,
                    BareSliceMatrix<AutoDiff<1,SIMD<double>>> values) const override
     {
-      if(compiled_function_simd_deriv)
+      if(auto func = compiled_function_simd_deriv.load(std::memory_order_acquire))
         {
-          compiled_function_simd_deriv(ir, values);
+          func(ir, values, code_pointers.Data());
           return;
         }
 
@@ -5936,9 +6459,9 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     void Evaluate (const SIMD_BaseMappedIntegrationRule & ir,
                    BareSliceMatrix<AutoDiffDiff<1,SIMD<double>>> values) const override
     {
-      if(compiled_function_simd_dderiv)
+      if(auto func = compiled_function_simd_dderiv.load(std::memory_order_acquire))
       {
-        compiled_function_simd_dderiv(ir, values);
+        func(ir, values, code_pointers.Data());
         return;
       }
       
@@ -5977,12 +6500,15 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     void Evaluate (const SIMD_BaseMappedIntegrationRule & ir,
                    BareSliceMatrix<SIMD<double>> values) const override
     {
-      if(compiled_function_simd)
+      if(auto func = compiled_function_simd.load(std::memory_order_acquire))
       {
-        compiled_function_simd(ir, values);
+        func(ir, values, code_pointers.Data());
         return;
       }
 
+      if (bytecode && bytecode->Run (ir, values))
+        return;
+
       T_Evaluate (ir, values);
       return;
 
@@ -6018,9 +6544,9 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
 
     void Evaluate (const BaseMappedIntegrationRule & ir, BareSliceMatrix<Complex> values) const override
     {
-      if(compiled_function_complex)
+      if(auto func = compiled_function_complex.load(std::memory_order_acquire))
       {
-          compiled_function_complex(ir,values);
+          func(ir, values, code_pointers.Data());
           return;
       }
       else
@@ -6032,9 +6558,9 @@ class CompiledCoefficientFunction : public CoefficientFunction //, public std::e
     void Evaluate (const SIMD_BaseMappedIntegrationRule & ir,
                    BareSliceMatrix<SIMD<Complex>> values) const override
     {
-      if(compiled_function_simd_complex)
+      if(auto func = compiled_function_simd_complex.load(std::memory_order_acquire))
       {
-        compiled_function_simd_complex(ir,values);
+        func(ir, values, code_pointers.Data());
         return;
       }
       else
@@ -6446,14 +6972,28 @@ class RealCF : public CoefficientFunctionNoDerivative
     return make_shared<ImagCF>(cf);
   }
 
-  shared_ptr<CoefficientFunction> Compile (shared_ptr<CoefficientFunction> c, bool realcompile, int maxderiv, bool wait)
+  shared_ptr<CoefficientFunction> Compile (shared_ptr<CoefficientFunction> c, bool realcompile, int maxderiv, bool wait, bool bytecode)
   {
     auto cf = make_shared<CompiledCoefficientFunction> (c);
+    if(bytecode)
+      cf->BuildBytecode();
     if(realcompile)
       cf->RealCompile(maxderiv, wait);
     return cf;
   }
 
+  bool IsCompiled (shared_ptr<CoefficientFunction> cf)
+  {
+    auto ccf = dynamic_pointer_cast<CompiledCoefficientFunction> (cf);
+    return ccf && ccf->IsCompiled();
+  }
+
+  bool WaitCompiled (shared_ptr<CoefficientFunction> cf, double timeout)
+  {
+    auto ccf = dynamic_pointer_cast<CompiledCoefficientFunction> (cf);
+    return ccf && ccf->WaitCompiled(timeout);
+  }
+
 class LoggingCoefficientFunction : public T_CoefficientFunction<LoggingCoefficientFunction>
 {
 protected:
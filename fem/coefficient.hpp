@@ -1695,7 +1695,14 @@ INLINE shared_ptr<CoefficientFunction> BinaryOpCF(shared_ptr<CoefficientFunction
   shared_ptr<CoefficientFunction> Freeze (shared_ptr<CoefficientFunction> cf);
   
   NGS_DLL_HEADER
-  shared_ptr<CoefficientFunction> Compile (shared_ptr<CoefficientFunction> c, bool realcompile=false, int maxderiv=2, bool wait=false);
+  shared_ptr<CoefficientFunction> Compile (shared_ptr<CoefficientFunction> c, bool realcompile=false, int maxderiv=2, bool wait=false, bool bytecode=true);
+
+  /// true as soon as the compiled library of a CF from Compile is in use
+  NGS_DLL_HEADER
+  bool IsCompiled (shared_ptr<CoefficientFunction> cf);
+  /// waits for a background compilation (timeout in seconds, negative waits forever)
+  NGS_DLL_HEADER
+  bool WaitCompiled (shared_ptr<CoefficientFunction> cf, double timeout = -1);
 
   NGS_DLL_HEADER
   shared_ptr<CoefficientFunction> LoggingCF (shared_ptr<CoefficientFunction> func, string logfile="stdout");
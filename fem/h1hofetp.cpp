@@ -0,0 +1,388 @@
+/*********************************************************************/
+/* File:   h1hofetp.cpp                                              */
+/* Author: Start                                                     */
+/* Date:   2026                                                      */
+/*********************************************************************/
+
+/*
+  Sum-factorized evaluation of H1 elements on quads and hexes
+*/
+
+#define FILE_H1HOFETP_CPP
+
+#include <fem.hpp>
+#include "h1hofetp.hpp"
+
+namespace ngfem
+{
+
+  // Legendre polynomials on [0,1] and their derivatives at the points of a 1D rule
+  class TPShapes1D
+  {
+    ArrayMem<double,256> mem;
+  public:
+    FlatMatrix<> shape, dshape;
+
+    TPShapes1D (int order, const SIMD_IntegrationRule & ir)
+      : mem(2*ir.GetNIP()*(order+1)),
+        shape(ir.GetNIP(), order+1, mem.Data()),
+        dshape(ir.GetNIP(), order+1, mem.Data()+ir.GetNIP()*(order+1))
+    {
+      constexpr size_t SW = SIMD<double>::Size();
+      FlatMatrix<> hshape = shape, hdshape = dshape;
+      for (size_t q = 0; q < ir.GetNIP(); q++)
+        {
+          AutoDiff<1> x (ir[q/SW](0)[q%SW], 0);
+          LegendrePolynomial (order, 2.0*x-1.0,
+                              SBLambda ([hshape, hdshape, q] (size_t i, auto val)
+                                        {
+                                          hshape(q,i) = val.Value();
+                                          hdshape(q,i) = val.DValue(0);
+                                        }));
+        }
+    }
+  };
+
+
+  /*
+    Tensor coefficients c(i,j) and point values v(ix,iy) are stored row-wise,
+    the last index running fastest, as the points in the quad and hex rules.
+  */
+
+  // v(ix,iy) = sum_ij bx(ix,i) by(iy,j) c(i,j)
+  static void TPEvaluate (FlatMatrix<> bx, FlatMatrix<> by,
+                          FlatVector<> c, FlatVector<> v)
+  {
+    size_t P = bx.Width();
+    size_t nx = bx.Height(), ny = by.Height();
+    FlatMatrix<> mc(P, P, &c(0));
+    FlatMatrix<> mv(nx, ny, &v(0));
+    STACK_ARRAY(double, mem, P*ny);
+    FlatMatrix<> tmp(P, ny, &mem[0]);
+    tmp = mc * Trans(by);
+    mv = bx * tmp;
+  }
+
+  // c(i,j) += sum_{ix,iy} bx(ix,i) by(iy,j) v(ix,iy)
+  static void TPAddTrans (FlatMatrix<> bx, FlatMatrix<> by,
+                          FlatVector<> v, FlatVector<> c)
+  {
+    size_t P = bx.Width();
+    size_t nx = bx.Height(), ny = by.Height();
+    FlatMatrix<> mc(P, P, &c(0));
+    FlatMatrix<> mv(nx, ny, &v(0));
+    STACK_ARRAY(double, mem, P*ny);
+    FlatMatrix<> tmp(P, ny, &mem[0]);
+    tmp = Trans(bx) * mv;
+    mc += tmp * by;
+  }
+
+  // v(ix,iy,iz) = sum_ijk bx(ix,i) by(iy,j) bz(iz,k) c(i,j,k)
+  static void TPEvaluate (FlatMatrix<> bx, FlatMatrix<> by, FlatMatrix<> bz,
+                          FlatVector<> c, FlatVector<> v)
+  {
+    size_t P = bx.Width();
+    size_t nx = bx.Height(), ny = by.Height(), nz = bz.Height();
+    FlatMatrix<> mc(P*P, P, &c(0));
+    FlatMatrix<> mv(nx, ny*nz, &v(0));
+
+    STACK_ARRAY(double, mem1, P*P*nz);
+    FlatMatrix<> tmp1(P*P, nz, &mem1[0]);
+    tmp1 = mc * Trans(bz);
+
+    STACK_ARRAY(double, mem2, P*ny*nz);
+    FlatMatrix<> tmp2(P, ny*nz, &mem2[0]);
+    for (size_t i = 0; i < P; i++)
+      FlatMatrix<> (ny, nz, &tmp2(i,0)) = by * tmp1.Rows(i*P, (i+1)*P);
+
+    mv = bx * tmp2;
+  }
+
+  // c(i,j,k) += sum_{ix,iy,iz} bx(ix,i) by(iy,j) bz(iz,k) v(ix,iy,iz)
+  static void TPAddTrans (FlatMatrix<> bx, FlatMatrix<> by, FlatMatrix<> bz,
+                          FlatVector<> v, FlatVector<> c)
+  {
+    size_t P = bx.Width();
+    size_t nx = bx.Height(), ny = by.Height(), nz = bz.Height();
+    FlatMatrix<> mc(P*P, P, &c(0));
+    FlatMatrix<> mv(nx, ny*nz, &v(0));
+
+    STACK_ARRAY(double, mem2, P*ny*nz);
+    FlatMatrix<> tmp2(P, ny*nz, &mem2[0]);
+    tmp2 = Trans(bx) * mv;
+
+    STACK_ARRAY(double, mem1, P*P*nz);
+    FlatMatrix<> tmp1(P*P, nz, &mem1[0]);
+    for (size_t i = 0; i < P; i++)
+      tmp1.Rows(i*P, (i+1)*P) = Trans(by) * FlatMatrix<> (ny, nz, &tmp2(i,0));
+
+    mc += tmp1 * bz;
+  }
+
+
+
+  template <ELEMENT_TYPE ET>
+  shared_ptr<H1TPTrafo> H1HighOrderFETP<ET> :: CalcTrafo (const H1HighOrderFE<ET> & fel)
+  {
+    static Timer t("H1HighOrderFETP - compute trafo");
+    RegionTimer reg(t);
+
+    int order = fel.Order();
+    size_t P = order+1;
+    size_t ntp = (DIM == 2) ? P*P : P*P*P;
+    size_t ndof = fel.GetNDof();
+
+    // Gauss rule with P points, exact for products of degree 2 order
+    const IntegrationRule & ir1d = SelectIntegrationRule (ET_SEGM, 2*order);
+    // projection onto Legendre polynomials:  proj(q,i) = (2i+1) w_q P_i(2x_q-1)
+    Matrix<> proj(P, P);
+    for (size_t q = 0; q < P; q++)
+      LegendrePolynomial (order, 2*ir1d[q](0)-1,
+                          SBLambda ([&] (size_t i, double val)
+                                    { proj(q,i) = (2*i+1) * ir1d[q].Weight() * val; }));
+
+    Matrix<> shapes(ntp, ndof);
+    for (size_t q = 0; q < ntp; q++)
+      {
+        IntegrationPoint ip = (DIM == 2)
+          ? IntegrationPoint (ir1d[q/P](0), ir1d[q%P](0), 0, 0)
+          : IntegrationPoint (ir1d[q/(P*P)](0), ir1d[(q/P)%P](0), ir1d[q%P](0), 0);
+        fel.CalcShape (ip, shapes.Row(q));
+      }
+
+    auto trafo = make_shared<H1TPTrafo>();
+    trafo->order = order;
+    trafo->firsti.SetSize(ndof+1);
+    trafo->firsti[0] = 0;
+
+    Vector<> vals(ntp), tcoefs(ntp);
+    for (size_t k = 0; k < ndof; k++)
+      {
+        vals = shapes.Col(k);
+        tcoefs = 0.0;
+        if constexpr (DIM == 2)
+          TPAddTrans (proj, proj, vals, tcoefs);
+        else
+          TPAddTrans (proj, proj, proj, vals, tcoefs);
+
+        double cmax = MaxNorm (tcoefs);
+        for (size_t a = 0; a < ntp; a++)
+          if (fabs(tcoefs(a)) > 1e-12 * cmax)
+            {
+              trafo->index.Append (a);
+              trafo->coef.Append (tcoefs(a));
+            }
+        trafo->firsti[k+1] = trafo->index.Size();
+      }
+    return trafo;
+  }
+
+
+  template <ELEMENT_TYPE ET>
+  void H1HighOrderFETP<ET> :: ToTensor (BareSliceVector<> coefs, FlatVector<> tcoefs) const
+  {
+    auto & t = *trafo;
+    tcoefs = 0.0;
+    for (size_t k = 0; k < this->ndof; k++)
+      {
+        double uk = coefs(k);
+        for (size_t j = t.firsti[k]; j < t.firsti[k+1]; j++)
+          tcoefs(t.index[j]) += t.coef[j] * uk;
+      }
+  }
+
+  template <ELEMENT_TYPE ET>
+  void H1HighOrderFETP<ET> :: AddFromTensor (FlatVector<> tcoefs, BareSliceVector<> coefs) const
+  {
+    auto & t = *trafo;
+    for (size_t k = 0; k < this->ndof; k++)
+      {
+        double sum = 0;
+        for (size_t j = t.firsti[k]; j < t.firsti[k+1]; j++)
+          sum += t.coef[j] * tcoefs(t.index[j]);
+        coefs(k) += sum;
+      }
+  }
+
+
+
+  template <ELEMENT_TYPE ET>
+  void H1HighOrderFETP<ET> ::
+  Evaluate (const SIMD_IntegrationRule & ir,
+            BareSliceVector<> coefs,
+            BareVector<SIMD<double>> values) const
+  {
+    if (!ir.IsTP())
+      {
+        TBASE::Evaluate (ir, coefs, values);
+        return;
+      }
+
+    static Timer t("H1HighOrderFETP - evaluate");
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    size_t P = this->order+1;
+    size_t ntp = (DIM == 2) ? P*P : P*P*P;
+    STACK_ARRAY(double, memc, ntp);
+    FlatVector<> tcoefs(ntp, &memc[0]);
+    ToTensor (coefs, tcoefs);
+
+    values(ir.Size()-1) = 0.0;   // clear overhead
+    FlatVector<> vals(ir.GetNIP(), &values(0)[0]);
+
+    TPShapes1D sx(this->order, ir.GetIRX());
+    TPShapes1D sy(this->order, ir.GetIRY());
+    if constexpr (DIM == 2)
+      TPEvaluate (sx.shape, sy.shape, tcoefs, vals);
+    else
+      {
+        TPShapes1D sz(this->order, ir.GetIRZ());
+        TPEvaluate (sx.shape, sy.shape, sz.shape, tcoefs, vals);
+      }
+  }
+
+  template <ELEMENT_TYPE ET>
+  void H1HighOrderFETP<ET> ::
+  AddTrans (const SIMD_IntegrationRule & ir,
+            BareVector<SIMD<double>> values,
+            BareSliceVector<> coefs) const
+  {
+    if (!ir.IsTP())
+      {
+        TBASE::AddTrans (ir, values, coefs);
+        return;
+      }
+
+    static Timer t("H1HighOrderFETP - addtrans");
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    size_t P = this->order+1;
+    size_t ntp = (DIM == 2) ? P*P : P*P*P;
+    STACK_ARRAY(double, memc, ntp);
+    FlatVector<> tcoefs(ntp, &memc[0]);
+    tcoefs = 0.0;
+
+    FlatVector<> vals(ir.GetNIP(), &values(0)[0]);
+
+    TPShapes1D sx(this->order, ir.GetIRX());
+    TPShapes1D sy(this->order, ir.GetIRY());
+    if constexpr (DIM == 2)
+      TPAddTrans (sx.shape, sy.shape, vals, tcoefs);
+    else
+      {
+        TPShapes1D sz(this->order, ir.GetIRZ());
+        TPAddTrans (sx.shape, sy.shape, sz.shape, vals, tcoefs);
+      }
+    AddFromTensor (tcoefs, coefs);
+  }
+
+  template <ELEMENT_TYPE ET>
+  void H1HighOrderFETP<ET> ::
+  EvaluateGrad (const SIMD_BaseMappedIntegrationRule & bmir,
+                BareSliceVector<> coefs,
+                BareSliceMatrix<SIMD<double>> values) const
+  {
+    auto & ir = bmir.IR();
+    if (!ir.IsTP() || bmir.DimSpace() != DIM)
+      {
+        TBASE::EvaluateGrad (bmir, coefs, values);
+        return;
+      }
+
+    static Timer t("H1HighOrderFETP - evaluate grad");
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    size_t P = this->order+1;
+    size_t ntp = (DIM == 2) ? P*P : P*P*P;
+    STACK_ARRAY(double, memc, ntp);
+    FlatVector<> tcoefs(ntp, &memc[0]);
+    ToTensor (coefs, tcoefs);
+
+    // gradient on the reference element
+    STACK_ARRAY(SIMD<double>, memg, DIM*ir.Size());
+    FlatMatrix<SIMD<double>> grad(DIM, ir.Size(), &memg[0]);
+    grad = SIMD<double>(0.0);
+
+    TPShapes1D sx(this->order, ir.GetIRX());
+    TPShapes1D sy(this->order, ir.GetIRY());
+    if constexpr (DIM == 2)
+      {
+        TPEvaluate (sx.dshape, sy.shape, tcoefs, FlatVector<>(ir.GetNIP(), &grad(0,0)[0]));
+        TPEvaluate (sx.shape, sy.dshape, tcoefs, FlatVector<>(ir.GetNIP(), &grad(1,0)[0]));
+      }
+    else
+      {
+        TPShapes1D sz(this->order, ir.GetIRZ());
+        TPEvaluate (sx.dshape, sy.shape, sz.shape, tcoefs, FlatVector<>(ir.GetNIP(), &grad(0,0)[0]));
+        TPEvaluate (sx.shape, sy.dshape, sz.shape, tcoefs, FlatVector<>(ir.GetNIP(), &grad(1,0)[0]));
+        TPEvaluate (sx.shape, sy.shape, sz.dshape, tcoefs, FlatVector<>(ir.GetNIP(), &grad(2,0)[0]));
+      }
+
+    auto & mir = static_cast<const SIMD_MappedIntegrationRule<DIM,DIM>&> (bmir);
+    for (size_t i = 0; i < mir.Size(); i++)
+      {
+        Vec<DIM,SIMD<double>> refgrad;
+        for (int d = 0; d < DIM; d++)
+          refgrad(d) = grad(d,i);
+        Vec<DIM,SIMD<double>> hv = Trans(mir[i].GetJacobianInverse()) * refgrad;
+        for (int d = 0; d < DIM; d++)
+          values(d,i) = hv(d);
+      }
+  }
+
+  template <ELEMENT_TYPE ET>
+  void H1HighOrderFETP<ET> ::
+  AddGradTrans (const SIMD_BaseMappedIntegrationRule & bmir,
+                BareSliceMatrix<SIMD<double>> values,
+                BareSliceVector<> coefs) const
+  {
+    auto & ir = bmir.IR();
+    if (!ir.IsTP() || bmir.DimSpace() != DIM)
+      {
+        TBASE::AddGradTrans (bmir, values, coefs);
+        return;
+      }
+
+    static Timer t("H1HighOrderFETP - addgradtrans");
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    auto & mir = static_cast<const SIMD_MappedIntegrationRule<DIM,DIM>&> (bmir);
+    STACK_ARRAY(SIMD<double>, memg, DIM*ir.Size());
+    FlatMatrix<SIMD<double>> grad(DIM, ir.Size(), &memg[0]);
+    for (size_t i = 0; i < mir.Size(); i++)
+      {
+        Vec<DIM,SIMD<double>> hv;
+        for (int d = 0; d < DIM; d++)
+          hv(d) = values(d,i);
+        Vec<DIM,SIMD<double>> refval = mir[i].GetJacobianInverse() * hv;
+        for (int d = 0; d < DIM; d++)
+          grad(d,i) = refval(d);
+      }
+
+    size_t P = this->order+1;
+    size_t ntp = (DIM == 2) ? P*P : P*P*P;
+    STACK_ARRAY(double, memc, ntp);
+    FlatVector<> tcoefs(ntp, &memc[0]);
+    tcoefs = 0.0;
+
+    TPShapes1D sx(this->order, ir.GetIRX());
+    TPShapes1D sy(this->order, ir.GetIRY());
+    if constexpr (DIM == 2)
+      {
+        TPAddTrans (sx.dshape, sy.shape, FlatVector<>(ir.GetNIP(), &grad(0,0)[0]), tcoefs);
+        TPAddTrans (sx.shape, sy.dshape, FlatVector<>(ir.GetNIP(), &grad(1,0)[0]), tcoefs);
+      }
+    else
+      {
+        TPShapes1D sz(this->order, ir.GetIRZ());
+        TPAddTrans (sx.dshape, sy.shape, sz.shape, FlatVector<>(ir.GetNIP(), &grad(0,0)[0]), tcoefs);
+        TPAddTrans (sx.shape, sy.dshape, sz.shape, FlatVector<>(ir.GetNIP(), &grad(1,0)[0]), tcoefs);
+        TPAddTrans (sx.shape, sy.shape, sz.dshape, FlatVector<>(ir.GetNIP(), &grad(2,0)[0]), tcoefs);
+      }
+    AddFromTensor (tcoefs, coefs);
+  }
+
+
+  template class H1HighOrderFETP<ET_QUAD>;
+  template class H1HighOrderFETP<ET_HEX>;
+}
@@ -0,0 +1,116 @@
+#ifndef FILE_H1HOFETP
+#define FILE_H1HOFETP
+
+/*********************************************************************/
+/* File:   h1hofetp.hpp                                              */
+/* Author: Start                                                     */
+/* Date:   2026                                                      */
+/*********************************************************************/
+
+
+namespace ngfem
+{
+
+  /**
+     Maps the hierarchical H1 basis of an element to tensor products
+     of Legendre polynomials on [0,1]^D. On quads and hexes the map is
+     a signed permutation up to round-off, and is stored sparse.
+     It depends only on the order and the relative vertex numbering,
+     and is computed once per such class by the finite element space.
+   */
+  class H1TPTrafo
+  {
+  public:
+    int order;
+    /// tensor coefficient index[j] += coef[j] * u(k),  firsti[k] <= j < firsti[k+1]
+    Array<size_t> firsti;
+    Array<int> index;
+    Array<double> coef;
+  };
+
+
+
+  /**
+     H1 element on quads and hexes with sum-factorized SIMD evaluation.
+     For tensor product integration rules, Evaluate, EvaluateGrad and
+     their transposes cost O(p^{D+1}) instead of O(p^{2D}) per element.
+     Requires uniform order on all edges, faces and the cell.
+   */
+  template <ELEMENT_TYPE ET>
+  class H1HighOrderFETP : public H1HighOrderFE<ET>
+  {
+    typedef H1HighOrderFE<ET> TBASE;
+    enum { DIM = ET_trait<ET>::DIM };
+
+    const H1TPTrafo * trafo;
+
+  public:
+    template <typename TA>
+    H1HighOrderFETP (int aorder, const TA & avnums, const H1TPTrafo & atrafo)
+      : H1HighOrderFE<ET> (aorder), trafo(&atrafo)
+    {
+      this->SetVertexNumbers (avnums);
+    }
+
+    /// trafos are equal for equal keys
+    template <typename TA>
+    static size_t TrafoKey (int aorder, const TA & avnums)
+    {
+      // shape functions depend on the relative order of vertex numbers only
+      constexpr int NV = ET_trait<ET>::N_VERTEX;
+      size_t key = aorder;
+      for (int i = 0; i < NV; i++)
+        {
+          int rank = 0;
+          for (int j = 0; j < NV; j++)
+            if (avnums[j] < avnums[i]) rank++;
+          key = key*NV + rank;
+        }
+      return key;
+    }
+
+    /// the map for an element of this order and vertex numbering
+    template <typename TA>
+    static shared_ptr<H1TPTrafo> CalcTrafo (int aorder, const TA & avnums)
+    {
+      H1HighOrderFE<ET> fel(aorder);
+      fel.SetVertexNumbers (avnums);
+      return CalcTrafo (fel);
+    }
+    static shared_ptr<H1TPTrafo> CalcTrafo (const H1HighOrderFE<ET> & fel);
+
+    using TBASE::Evaluate;
+    using TBASE::AddTrans;
+    using TBASE::EvaluateGrad;
+    using TBASE::AddGradTrans;
+
+    virtual void Evaluate (const SIMD_IntegrationRule & ir,
+                           BareSliceVector<> coefs,
+                           BareVector<SIMD<double>> values) const override;
+
+    virtual void AddTrans (const SIMD_IntegrationRule & ir,
+                           BareVector<SIMD<double>> values,
+                           BareSliceVector<> coefs) const override;
+
+    virtual void EvaluateGrad (const SIMD_BaseMappedIntegrationRule & mir,
+                               BareSliceVector<> coefs,
+                               BareSliceMatrix<SIMD<double>> values) const override;
+
+    virtual void AddGradTrans (const SIMD_BaseMappedIntegrationRule & mir,
+                               BareSliceMatrix<SIMD<double>> values,
+                               BareSliceVector<> coefs) const override;
+
+  protected:
+    /// tensor coefficients from element coefficients
+    void ToTensor (BareSliceVector<> coefs, FlatVector<> tcoefs) const;
+    /// coefs += transpose of ToTensor
+    void AddFromTensor (FlatVector<> tcoefs, BareSliceVector<> coefs) const;
+  };
+
+#ifndef FILE_H1HOFETP_CPP
+  extern template class H1HighOrderFETP<ET_QUAD>;
+  extern template class H1HighOrderFETP<ET_HEX>;
+#endif
+}
+
+#endif
@@ -1262,17 +1262,20 @@ cf : ngsolve.CoefficientFunction
           { return Freeze(coef); },
           "don't differentiate this expression")
 
-    .def ("Compile", [] (shared_ptr<CF> coef, bool realcompile, int maxderiv, bool wait)
-           { return Compile (coef, realcompile, maxderiv, wait); },
+    .def ("Compile", [] (shared_ptr<CF> coef, bool realcompile, int maxderiv, bool wait, bool bytecode)
+           { return Compile (coef, realcompile, maxderiv, wait, bytecode); },
            py::arg("realcompile")=false,
            py::arg("maxderiv")=2,
-          py::arg("wait")=false, py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+          py::arg("wait")=false, py::arg("bytecode")=true,
+          py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
 Compile list of individual steps, experimental improvement for deep trees
 
 Parameters:
 
 realcompile : bool
-  True -> Compile to C++ code
+  True -> Compile to C++ code. The libraries are cached in the directory
+  NGSOLVE_KERNEL_CACHE (default: ~/.cache/ngsolve/kernels) and reused
+  by later runs and other MPI ranks.
 
 maxderiv : int
   input maximal derivative
@@ -1280,6 +1283,30 @@ maxderiv : int
 wait : bool
   True -> Waits until the previous Compile call is finished before start compiling
 
+bytecode : bool
+  True -> Evaluate real valued functions with an in-process SIMD bytecode,
+  used as long as no compiled library is available
+
+With wait=False the library is built on a background thread, the
+function is evaluated without it until it is ready, see IsCompiled
+and WaitCompiled.
+
+)raw_string"))
+    .def ("IsCompiled", [] (shared_ptr<CF> coef) { return IsCompiled (coef); },
+          "True if the compiled library of a compiled CoefficientFunction is in use")
+    .def ("WaitCompiled", [] (shared_ptr<CF> coef, optional<double> timeout)
+          { return WaitCompiled (coef, timeout ? *timeout : -1); },
+          py::arg("timeout")=py::none(), py::call_guard<py::gil_scoped_release>(),
+          docu_string(R"raw_string(
+Waits for the background compilation started by Compile(realcompile=True, wait=False).
+
+Parameters:
+
+timeout : float
+  maximal waiting time in seconds, None waits until compilation is finished
+
+Returns True if the compiled library is in use.
+
 )raw_string"))
 
 
@@ -2429,12 +2456,12 @@ alpha : double
 
   m.def("VoxelCoefficient",
         [](py::tuple pystart, py::tuple pyend, py::array values,
-           bool linear)
+           bool linear, bool tiled)
         -> shared_ptr<CoefficientFunction>
         {
-          Array<string> allowed_types = { "float64", "complex128" };
+          Array<string> allowed_types = { "float64", "float32", "complex128" };
           if(!allowed_types.Contains(py::cast<string>(values.dtype().attr("name"))))
-            throw Exception("Only float64 and complex128 dtype arrays allowed!");
+            throw Exception("Only float64, float32 and complex128 dtype arrays allowed!");
           Array<double> start, end;
           Array<size_t> dim_vals;
           for(auto val : pystart)
@@ -2451,22 +2478,33 @@ alpha : double
               for(auto i : Range(vals))
                 vals[i] = c_array.at(i);
               return make_shared<VoxelCoefficientFunction<Complex>>
-                (start, end, dim_vals, move(vals), linear);
+                (start, end, dim_vals, move(vals), linear, tiled);
+            }
+          if(values.itemsize() == sizeof(float))
+            {
+              auto f_array = py::cast<py::array_t<float>>(values.attr("ravel")());
+              Array<float> vals(values.size());
+              for(auto i : Range(vals))
+                vals[i] = f_array.at(i);
+              return make_shared<VoxelCoefficientFunction<double>>
+                (start, end, dim_vals, move(vals), linear, tiled);
             }
           auto d_array = py::cast<py::array_t<double>>(values.attr("ravel")());
           Array<double> vals(values.size());
           for(auto i : Range(vals))
             vals[i] = d_array.at(i);
           return make_shared<VoxelCoefficientFunction<double>>
-            (start, end, dim_vals, move(vals), linear);
+            (start, end, dim_vals, move(vals), linear, tiled);
         }, py::arg("start"), py::arg("end"), py::arg("values"),
-        py::arg("linear")=true, R"delimiter(CoefficientFunction defined on a grid.
+        py::arg("linear")=true, py::arg("tiled")=false, R"delimiter(CoefficientFunction defined on a grid.
 
 Start and end mark the cartesian boundary of domain. The function will be continued by a constant function outside of this box. Inside a cartesian grid will be created by the dimensions of the numpy input array 'values'. This array must have the dimensions of the mesh and the values stored as:
 x1y1z1, x2y1z1, ..., xNy1z1, x1y2z1, ...
 
 If linear is True the function will be interpolated linearly between the values. Otherwise the nearest voxel value is taken.
 
+A float32 array is stored in single precision, which halves the memory. If tiled is True the values are stored in blocks of 4x4x4 voxels, such that neighbouring points hit the same cache lines.
+
 )delimiter");
 
 }
@@ -1793,7 +1793,272 @@ namespace ngfem
   }
 
 
-  
+
+  bool SymbolicBilinearFormIntegrator ::
+  SupportsBatchAssembly (const FiniteElement & fel) const
+  {
+    if (vb != VOL || element_vb != VOL) return false;
+    if (cf->IsComplex() || GetDeformation()) return false;
+    if (typeid(fel) == typeid(const MixedFiniteElement&)) return false;
+    if (!dynamic_cast<const BaseScalarFiniteElement*> (&fel)) return false;
+
+    int D = fel.Dim();
+    auto supported = [D] (const ProxyFunction * proxy)
+      {
+        if (proxy->IsOther()) return false;
+        const DifferentialOperator & diffop = *proxy->Evaluator();
+        if (diffop.Name() == "Id") return proxy->Dimension() == 1;
+        if (diffop.Name() == "grad") return proxy->Dimension() == D;
+        return false;
+      };
+
+    for (auto proxy : trial_proxies)
+      if (!supported(proxy)) return false;
+    for (auto proxy : test_proxies)
+      if (!supported(proxy)) return false;
+    return true;
+  }
+
+
+  FlatMatrix<double> SymbolicBilinearFormIntegrator ::
+  CalcBatchShapes (const FiniteElement & fel, LocalHeap & lh) const
+  {
+    auto & sfel = static_cast<const BaseScalarFiniteElement&> (fel);
+    const IntegrationRule & ir = GetIntegrationRule (fel, lh);
+    int D = fel.Dim();
+    size_t nip = ir.Size();
+    size_t ndof = fel.GetNDof();
+
+    FlatMatrix<> refshapes((D+1)*nip, ndof, lh);
+    HeapReset hr(lh);
+    FlatMatrix<> dshape(ndof, D, lh);
+    for (size_t q = 0; q < nip; q++)
+      {
+        sfel.CalcShape (ir[q], refshapes.Row(q));
+        sfel.CalcDShape (ir[q], dshape);
+        refshapes.Rows(nip+D*q, nip+D*(q+1)) = Trans(dshape);
+      }
+    return refshapes;
+  }
+
+
+  template <int D>
+  static void CalcElementMatrixBatchAddD (const SymbolicBilinearFormIntegrator & bfi,
+                                          CoefficientFunction & cf,
+                                          FlatArray<ProxyFunction*> trial_proxies,
+                                          FlatArray<ProxyFunction*> test_proxies,
+                                          const Matrix<bool> & nonzeros,
+                                          const FiniteElement & fel,
+                                          FlatMatrix<double> refshapes,
+                                          FlatArray<const ElementTransformation*> trafos,
+                                          FlatMatrix<SIMD<double>> elmats,
+                                          LocalHeap & lh)
+  {
+    constexpr size_t W = SIMD<double>::Size();
+    const IntegrationRule & ir = bfi.GetIntegrationRule (fel, lh);
+    size_t nip = ir.Size();
+    size_t ndof = fel.GetNDof();
+
+    // mapped rules of all lanes, unused lanes repeat the last element
+    ProxyUserData ud;
+    ArrayMem<const MappedIntegrationRule<D,D>*, W> mirs(W);
+    for (size_t i = 0; i < W; i++)
+      {
+        auto & trafo = *trafos[min(i, trafos.Size()-1)];
+        const_cast<ElementTransformation&>(trafo).userdata = &ud;
+        mirs[i] = &static_cast<const MappedIntegrationRule<D,D>&> (trafo(ir, lh));
+      }
+
+    // the batch as one SIMD mapped rule: all lanes of point q are ir[q],
+    // lane i is mapped by the element of lane i
+    FlatArray<SIMD<IntegrationPoint>> simd_ips(nip, lh);
+    for (size_t q = 0; q < nip; q++)
+      simd_ips[q] = SIMD<IntegrationPoint> ([&] (int) { return ir[q]; });
+    SIMD_IntegrationRule simd_ir(nip, simd_ips.Data());
+    SIMD_MappedIntegrationRule<D,D> simd_mir(simd_ir, *trafos[0], -1, lh);
+    for (size_t q = 0; q < nip; q++)
+      {
+        auto & mip = simd_mir[q];
+        for (int j = 0; j < D; j++)
+          {
+            mip.Point()(j) = SIMD<double> ([&] (int i) { return (*mirs[i])[q].GetPoint()(j); });
+            for (int k = 0; k < D; k++)
+              mip.Jacobian()(j,k) = SIMD<double> ([&] (int i) { return (*mirs[i])[q].GetJacobian()(j,k); });
+          }
+        mip.Compute();
+      }
+
+    // gridfunctions depend on the element, not only on the point,
+    // they are evaluated element by element, as cfs without SIMD support
+    bool lanewise = false;
+    cf.TraverseTree ([&] (CoefficientFunction & nodecf)
+                     {
+                       if (nodecf.StoreUserData()) lanewise = true;
+                     });
+
+    FlatMatrix<> sval(nip, 1, lh), lanevals(nip, W, lh);
+    auto evaluate = [&] (FlatMatrix<SIMD<double>> val)
+      {
+        if (!lanewise)
+          {
+            try
+              {
+                cf.Evaluate (simd_mir, val);
+                return;
+              }
+            catch (ExceptionNOSIMD e)
+              {
+                lanewise = true;
+              }
+          }
+        for (size_t i = 0; i < W; i++)
+          {
+            cf.Evaluate (*mirs[i], sval);
+            lanevals.Col(i) = sval.Col(0);
+          }
+        for (size_t q = 0; q < nip; q++)
+          val(0,q) = SIMD<double> (&lanevals(q,0));
+      };
+
+    auto bref = [&] (bool grad, size_t q)
+      {
+        return grad ? refshapes.Rows(nip+D*q, nip+D*(q+1)) : refshapes.Rows(q, q+1);
+      };
+
+    int k1 = 0;
+    for (auto proxy1 : trial_proxies)
+      {
+        int l1 = 0;
+        for (auto proxy2 : test_proxies)
+          {
+            HeapReset hr(lh);
+            size_t dim1 = proxy1->Dimension(), dim2 = proxy2->Dimension();
+            bool grad1 = proxy1->Evaluator()->Name() == "grad";
+            bool grad2 = proxy2->Evaluator()->Name() == "grad";
+
+            bool is_nonzero = false;
+            for (size_t k = 0; k < dim1; k++)
+              for (size_t l = 0; l < dim2; l++)
+                is_nonzero |= nonzeros(l1+l, k1+k);
+            if (!is_nonzero)
+              {
+                l1 += dim2;
+                continue;
+              }
+
+            FlatMatrix<SIMD<double>> dvals(dim2*dim1, nip, lh);
+            FlatMatrix<SIMD<double>> val(1, nip, lh);
+            dvals = SIMD<double>(0.0);
+            for (size_t k = 0; k < dim1; k++)
+              for (size_t l = 0; l < dim2; l++)
+                if (nonzeros(l1+l, k1+k))
+                  {
+                    ud.trialfunction = proxy1;
+                    ud.trial_comp = k;
+                    ud.testfunction = proxy2;
+                    ud.test_comp = l;
+                    evaluate (val);
+                    dvals.Row(l*dim1+k) = val.Row(0);
+                  }
+
+            // coefficient pulled back to the reference element, elmat += Bref2^T G Bref1
+            // with G = w JI D JI^T for gradients
+            FlatMatrix<SIMD<double>> gvals(nip, dim2*dim1, lh);
+            for (size_t q = 0; q < nip; q++)
+              {
+                auto & mip = simd_mir[q];
+                Mat<D,D,SIMD<double>> jinv = mip.GetJacobianInverse();
+                SIMD<double> hg[3][3];
+                for (size_t l = 0; l < dim2; l++)
+                  for (size_t k = 0; k < dim1; k++)
+                    if (grad2)
+                      {
+                        SIMD<double> sum = 0.0;
+                        for (size_t m = 0; m < dim2; m++)
+                          sum += jinv(l,m) * dvals(m*dim1+k, q);
+                        hg[l][k] = sum;
+                      }
+                    else
+                      hg[l][k] = dvals(l*dim1+k, q);
+
+                SIMD<double> w = mip.GetWeight();
+                for (size_t l = 0; l < dim2; l++)
+                  for (size_t k = 0; k < dim1; k++)
+                    if (grad1)
+                      {
+                        SIMD<double> sum = 0.0;
+                        for (size_t m = 0; m < dim1; m++)
+                          sum += hg[l][m] * jinv(k,m);
+                        gvals(q, l*dim1+k) = w * sum;
+                      }
+                    else
+                      gvals(q, l*dim1+k) = w * hg[l][k];
+              }
+
+            // element matrices, SIMD over the elements
+            FlatMatrix<SIMD<double>> bg(ndof, dim2, lh);
+            for (size_t q = 0; q < nip; q++)
+              {
+                auto b1 = bref(grad1, q);
+                auto b2 = bref(grad2, q);
+                for (size_t j = 0; j < ndof; j++)
+                  for (size_t l = 0; l < dim2; l++)
+                    {
+                      SIMD<double> sum = 0.0;
+                      for (size_t k = 0; k < dim1; k++)
+                        sum += b1(k,j) * gvals(q, l*dim1+k);
+                      bg(j,l) = sum;
+                    }
+                for (size_t i = 0; i < ndof; i++)
+                  for (size_t j = 0; j < ndof; j++)
+                    {
+                      SIMD<double> sum = elmats(i,j);
+                      for (size_t l = 0; l < dim2; l++)
+                        sum += b2(l,i) * bg(j,l);
+                      elmats(i,j) = sum;
+                    }
+              }
+            l1 += dim2;
+          }
+        k1 += proxy1->Dimension();
+      }
+
+    for (auto trafo : trafos)
+      const_cast<ElementTransformation*>(trafo)->userdata = nullptr;
+  }
+
+
+  void SymbolicBilinearFormIntegrator ::
+  CalcElementMatrixBatchAdd (const FiniteElement & fel,
+                             FlatMatrix<double> refshapes,
+                             FlatArray<const ElementTransformation*> trafos,
+                             FlatMatrix<SIMD<double>> elmats,
+                             LocalHeap & lh) const
+  {
+    static Timer t("SymbolicBFI::CalcElementMatrixBatchAdd", 2);
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    switch (fel.Dim())
+      {
+      case 1:
+        CalcElementMatrixBatchAddD<1> (*this, *cf, trial_proxies, test_proxies, nonzeros,
+                                       fel, refshapes, trafos, elmats, lh);
+        break;
+      case 2:
+        CalcElementMatrixBatchAddD<2> (*this, *cf, trial_proxies, test_proxies, nonzeros,
+                                       fel, refshapes, trafos, elmats, lh);
+        break;
+      case 3:
+        CalcElementMatrixBatchAddD<3> (*this, *cf, trial_proxies, test_proxies, nonzeros,
+                                       fel, refshapes, trafos, elmats, lh);
+        break;
+      default:
+        throw Exception ("CalcElementMatrixBatchAdd: unsupported dimension");
+      }
+  }
+
+
+
 
   template <typename SCAL, typename SCAL_SHAPES, typename SCAL_RES>
   void SymbolicBilinearFormIntegrator ::
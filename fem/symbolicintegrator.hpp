@@ -698,7 +698,30 @@ public:
                                    const ElementTransformation & trafo, 
                                    FlatMatrix<SCAL_RES> elmat,
                                    LocalHeap & lh) const;
-    
+
+    /// real volume integrand in Id and grad of a scalar element ?
+    NGS_DLL_HEADER bool SupportsBatchAssembly (const FiniteElement & fel) const;
+
+    /**
+       reference shapes and gradients in the integration points,
+       shared by all elements with the same finite element.
+       rows 0..nip: shapes, row nip+D*q+j: j-th derivative in point q
+    */
+    NGS_DLL_HEADER FlatMatrix<double>
+    CalcBatchShapes (const FiniteElement & fel, LocalHeap & lh) const;
+
+    /**
+       element matrices of up to SIMD<double>::Size() elements of the same
+       class, vectorized over the elements: lane i of elmats belongs to
+       trafos[i]. Unused lanes repeat the last element.
+    */
+    NGS_DLL_HEADER void
+    CalcElementMatrixBatchAdd (const FiniteElement & fel,
+                               FlatMatrix<double> refshapes,
+                               FlatArray<const ElementTransformation*> trafos,
+                               FlatMatrix<SIMD<double>> elmats,
+                               LocalHeap & lh) const;
+
     NGS_DLL_HEADER virtual void 
     CalcLinearizedElementMatrix (const FiniteElement & fel,
                                  const ElementTransformation & trafo, 
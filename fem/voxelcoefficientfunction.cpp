@@ -4,64 +4,112 @@
 namespace ngfem
 {
   template<typename T>
-  T VoxelCoefficientFunction<T> :: T_Evaluate(const BaseMappedIntegrationPoint& ip) const
+  VoxelCoefficientFunction<T> ::
+  VoxelCoefficientFunction(const Array<double>& _start,
+                           const Array<double>& _end,
+                           const Array<size_t>& _dim_vals,
+                           Array<T>&& _values,
+                           bool _linear, bool _tiled)
+    : CoefficientFunctionNoDerivative(1, is_same_v<T, Complex>),
+      start(_start), end(_end), dim_vals(_dim_vals),
+      values(move(_values)), linear(_linear), tiled(_tiled)
   {
-    auto pnt = ip.GetPoint();
-    ArrayMem<size_t, 3> ind;
-    ArrayMem<double, 3> weight;
-    for(auto i : Range(start))
-      {
-        auto nvals = linear ? dim_vals[i] - 1 : dim_vals[i];
-        double len = (end[i] - start[i])/nvals;
-        double coord = min2(end[i], max2(start[i], pnt[i]));
-        if(!linear && coord == end[i])
-          coord *= (1-1e-12);
-        double pos = (coord - start[i])/len;
-        ind.Append(pos);
-        if(linear)
-          weight.Append(1.-(pos-ind[i]));
-      }
+    Setup();
+    StoreTiled(values);
+  }
 
-    if(!linear)
+  template<typename T>
+  VoxelCoefficientFunction<T> ::
+  VoxelCoefficientFunction(const Array<double>& _start,
+                           const Array<double>& _end,
+                           const Array<size_t>& _dim_vals,
+                           Array<float>&& _values,
+                           bool _linear, bool _tiled)
+    : CoefficientFunctionNoDerivative(1, is_same_v<T, Complex>),
+      start(_start), end(_end), dim_vals(_dim_vals),
+      fvalues(move(_values)), linear(_linear), tiled(_tiled)
+  {
+    if constexpr(is_same_v<T, Complex>)
+      throw Exception("Single precision storage only for real VoxelCoefficient!");
+    Setup();
+    StoreTiled(fvalues);
+  }
+
+  template<typename T>
+  void VoxelCoefficientFunction<T> :: Setup()
+  {
+    if(start.Size() > 3 || start.Size() != dim_vals.Size())
+      throw Exception("VoxelCoefficient: dimension of values must fit start and end, at most 3!");
+    for(auto i : Range(3))
       {
-        size_t offset = dim_vals[0];
-        size_t index = ind[0];
-        for(auto i : IntRange(1,ind.Size()))
-          {
-            index += offset * ind[i];
-            offset *= dim_vals[i];
-          }
-        return values[index];
+        n[i] = i < dim_vals.Size() ? dim_vals[i] : 1;
+        len[i] = 1.;
+        if(i < start.Size())
+          len[i] = (end[i] - start[i])/(linear ? n[i] - 1 : n[i]);
+        tile_shift[i] = (tiled && n[i] > 1) ? 2 : 0;
+        ntiles[i] = (n[i] + (size_t(1) << tile_shift[i]) - 1) >> tile_shift[i];
       }
+  }
 
-    Array<size_t> indices(pow(2, ind.Size()));
-    Array<double> tot_weight(indices.Size());
+  // reorder lexicographic values to tiles
+  template<typename T> template<typename TV>
+  void VoxelCoefficientFunction<T> :: StoreTiled(Array<TV>& vals)
+  {
+    if(!tiled)
+      return;
+    Array<TV> tiled_vals(ntiles[0] * ntiles[1] * ntiles[2] << (tile_shift[0] + tile_shift[1] + tile_shift[2]));
+    tiled_vals = TV(0.);
+    for(size_t k = 0, ii = 0; k < n[2]; k++)
+      for(size_t j = 0; j < n[1]; j++)
+        for(size_t i = 0; i < n[0]; i++, ii++)
+          tiled_vals[Index(i,j,k)] = vals[ii];
+    vals = move(tiled_vals);
+  }
 
-    indices[0] = ind[0];
-    indices[1] = min2(ind[0]+1, dim_vals[0]-1);
-    tot_weight[0] = weight[0];
-    tot_weight[1] = 1.-weight[0];
-    size_t offset = dim_vals[0];
-    size_t indsize = 2;
+  template<typename T>
+  void VoxelCoefficientFunction<T> :: Locate(int dir, double x, size_t& ind, double& weight) const
+  {
+    double coord = min2(end[dir], max2(start[dir], x));
+    if(!linear && coord == end[dir])
+      coord *= (1-1e-12);
+    double pos = (coord - start[dir])/len[dir];
+    ind = min2(size_t(pos), n[dir]-1);
+    weight = 1.-(pos-ind);
+  }
 
-    for(auto i : IntRange(1, ind.Size()))
-      {
-        for(auto j : Range(indsize))
-          {
-            auto indplus1 = min2(ind[i]+1, dim_vals[i]-1);
-            indices[indsize + j] = offset * indplus1 + indices[j];
-            indices[j] += offset * ind[i];
-            tot_weight[indsize + j] = (1.-weight[i]) * tot_weight[j];
-            tot_weight[j] *= weight[i];
-          }
-        indsize *= 2;
-        offset *= dim_vals[i];
-      }
+  template<typename T>
+  T VoxelCoefficientFunction<T> :: T_Evaluate(const double* pnt) const
+  {
+    size_t ind[3] = { 0, 0, 0 };
+    double weight[3] = { 1., 1., 1. };
+    for(auto i : Range(start))
+      Locate(i, pnt[i], ind[i], weight[i]);
 
-    T result = 0.;
-    for(auto i : Range(indices))
-      result += tot_weight[i] * values[indices[i]];
+    if(!linear)
+      return Value(ind[0], ind[1], ind[2]);
+
+    size_t up[3];
+    for(auto i : Range(3))
+      up[i] = min2(ind[i]+1, n[i]-1);
 
+    T result = 0.;
+    for(size_t c = 0; c < (size_t(1) << start.Size()); c++)
+      {
+        size_t cind[3];
+        double w = 1.;
+        for(auto i : Range(3))
+          if(c & (size_t(1) << i))
+            {
+              cind[i] = up[i];
+              w *= 1.-weight[i];
+            }
+          else
+            {
+              cind[i] = ind[i];
+              w *= weight[i];
+            }
+        result += w * Value(cind[0], cind[1], cind[2]);
+      }
     return result;
   }
 
@@ -69,7 +117,7 @@ namespace ngfem
   Complex VoxelCoefficientFunction<T> :: EvaluateComplex(const BaseMappedIntegrationPoint& ip) const
   {
     if constexpr(is_same_v<T, Complex>)
-      return T_Evaluate(ip);
+      return T_Evaluate(&ip.GetPoint()(0));
     throw Exception("Complex evaluate for real VoxelCoefficient called!");
   }
 
@@ -78,7 +126,7 @@ namespace ngfem
   {
     if constexpr(is_same_v<T, Complex>)
       {
-        values = T_Evaluate(mip);
+        values = T_Evaluate(&mip.GetPoint()(0));
         return;
       }
     throw Exception("Complex evaluate for real VoxelCoefficient called!");
@@ -88,10 +136,92 @@ namespace ngfem
   double VoxelCoefficientFunction<T> :: Evaluate(const BaseMappedIntegrationPoint& ip) const
   {
     if constexpr(is_same_v<T, double>)
-      return T_Evaluate(ip);
+      return T_Evaluate(&ip.GetPoint()(0));
     throw Exception("Real evaluate for complex VoxelCoefficient called!");
   }
 
+  template<typename T>
+  void VoxelCoefficientFunction<T> :: Evaluate(const BaseMappedIntegrationRule& ir, BareSliceMatrix<double> values) const
+  {
+    if constexpr(is_same_v<T, double>)
+      {
+        if(ir.IsComplex())
+          {
+            CoefficientFunctionNoDerivative::Evaluate(ir, values);
+            return;
+          }
+        auto points = ir.GetPoints();
+        for(auto i : Range(ir))
+          values(i,0) = T_Evaluate(&points(i,0));
+      }
+    else
+      CoefficientFunctionNoDerivative::Evaluate(ir, values);
+  }
+
+  template<typename T>
+  void VoxelCoefficientFunction<T> :: Evaluate(const SIMD_BaseMappedIntegrationRule& ir, BareSliceMatrix<SIMD<double>> values) const
+  {
+    if constexpr(is_same_v<T, double>)
+      {
+        if(ir.IsComplex())
+          {
+            CoefficientFunctionNoDerivative::Evaluate(ir, values);
+            return;
+          }
+        auto points = ir.GetPoints();
+        size_t dim = start.Size();
+        for(auto i : Range(ir))
+          {
+            // clamp, locate and weight on all lanes at once, as Locate does per point
+            SIMD<double> ind[3], up[3], weight[3];
+            for(auto d : Range(3))
+              {
+                ind[d] = up[d] = SIMD<double>(0.);
+                weight[d] = SIMD<double>(1.);
+              }
+            for(auto d : Range(dim))
+              {
+                SIMD<double> x = points(i,d);
+                x = IfPos(start[d] - x, SIMD<double>(start[d]), x);
+                x = IfPos(x - end[d], SIMD<double>(end[d]), x);
+                SIMD<double> pos = (x - start[d]) / len[d];
+                double last = n[d]-1;
+                SIMD<double> fl = floor(pos);
+                ind[d] = IfPos(fl - last, SIMD<double>(last), fl);
+                up[d] = IfPos(last - ind[d], ind[d] + 1., ind[d]);
+                weight[d] = 1. - (pos - ind[d]);
+              }
+
+            // only the value loads are per lane
+            if(!linear)
+              {
+                values(0,i) = SIMD<double>([&](int l)->double
+                                           { return Value(size_t(ind[0][l]), size_t(ind[1][l]), size_t(ind[2][l])); });
+                continue;
+              }
+
+            // gather the corner values, interpolate one direction after the other
+            SIMD<double> corner[8];
+            for(size_t c = 0; c < (size_t(1) << dim); c++)
+              corner[c] = SIMD<double>([&](int l)->double
+                                       {
+                                         return Value(size_t((c & 1) ? up[0][l] : ind[0][l]),
+                                                      size_t((c & 2) ? up[1][l] : ind[1][l]),
+                                                      size_t((c & 4) ? up[2][l] : ind[2][l]));
+                                       });
+            for(size_t d = dim; d-- > 0; )
+              {
+                size_t half = size_t(1) << d;
+                for(size_t c = 0; c < half; c++)
+                  corner[c] = weight[d] * corner[c] + (1.-weight[d]) * corner[c+half];
+              }
+            values(0,i) = corner[0];
+          }
+      }
+    else
+      CoefficientFunctionNoDerivative::Evaluate(ir, values);
+  }
+
   template class VoxelCoefficientFunction<double>;
   template class VoxelCoefficientFunction<Complex>;
 } // namespace ngfem
@@ -11,26 +11,63 @@ namespace ngfem
     Array<double> start, end;
     Array<size_t> dim_vals;
     Array<SCAL> values;
+    // single precision storage, used instead of values if not empty
+    Array<float> fvalues;
     bool linear;
+    // values are stored in tiles of 4 values per direction
+    bool tiled;
+    size_t n[3];          // values per direction, 1 for missing directions
+    double len[3];        // voxel size
+    int tile_shift[3];    // 2^shift values per tile and direction
+    size_t ntiles[3];
   public:
     VoxelCoefficientFunction(const Array<double>& _start,
                              const Array<double>& _end,
                              const Array<size_t>& _dim_vals,
                              Array<SCAL>&& _values,
-                             bool _linear)
-      : CoefficientFunctionNoDerivative(1, is_same_v<SCAL, Complex>),
-        start(_start), end(_end), dim_vals(_dim_vals),
-        values(move(_values)), linear(_linear)
-    { ; }
+                             bool _linear,
+                             bool _tiled = false);
+
+    VoxelCoefficientFunction(const Array<double>& _start,
+                             const Array<double>& _end,
+                             const Array<size_t>& _dim_vals,
+                             Array<float>&& _values,
+                             bool _linear,
+                             bool _tiled = false);
 
     using CoefficientFunctionNoDerivative::Evaluate;
     double Evaluate(const BaseMappedIntegrationPoint& ip) const override;
     Complex EvaluateComplex(const BaseMappedIntegrationPoint& ip) const override;
 
     void Evaluate(const BaseMappedIntegrationPoint& mip, FlatVector<Complex> values) const override;
+    void Evaluate(const BaseMappedIntegrationRule& ir, BareSliceMatrix<double> values) const override;
+    void Evaluate(const SIMD_BaseMappedIntegrationRule& ir, BareSliceMatrix<SIMD<double>> values) const override;
 
   private:
-    SCAL T_Evaluate(const BaseMappedIntegrationPoint& ip) const;
+    void Setup();
+    template<typename T>
+    void StoreTiled(Array<T>& vals);
+
+    size_t Index(size_t i, size_t j, size_t k) const
+    {
+      if(!tiled)
+        return i + n[0] * (j + n[1] * k);
+      size_t tile = (i >> tile_shift[0]) + ntiles[0] * ((j >> tile_shift[1]) + ntiles[1] * (k >> tile_shift[2]));
+      size_t inner = (i & ((size_t(1) << tile_shift[0]) - 1)) +
+        ((j & ((size_t(1) << tile_shift[1]) - 1)) << tile_shift[0]) +
+        ((k & ((size_t(1) << tile_shift[2]) - 1)) << (tile_shift[0] + tile_shift[1]));
+      return (tile << (tile_shift[0] + tile_shift[1] + tile_shift[2])) + inner;
+    }
+
+    SCAL Value(size_t i, size_t j, size_t k) const
+    {
+      if(fvalues.Size())
+        return fvalues[Index(i,j,k)];
+      return values[Index(i,j,k)];
+    }
+
+    void Locate(int dir, double x, size_t& ind, double& weight) const;
+    SCAL T_Evaluate(const double* pnt) const;
   };
 } // namespace ngfem
 
@@ -171,7 +171,23 @@ namespace ngla
     y.FV<Complex>() = Conj(tmpy.FV<Complex>());
     // throw Exception(string("MultHermitianAdd not overloaded for type ")+typeid(*this).name());
   }
-  
+
+  void BaseMatrix :: Mult (const MultiVector & x, MultiVector & y) const
+  {
+    if (x.Size() != y.Size())
+      throw Exception ("BaseMatrix::Mult: number of vectors don't match");
+    for (size_t i = 0; i < x.Size(); i++)
+      Mult (x[i], y[i]);
+  }
+
+  void BaseMatrix :: MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if (x.Size() != y.Size())
+      throw Exception ("BaseMatrix::MultAdd: number of vectors don't match");
+    for (size_t i = 0; i < x.Size(); i++)
+      MultAdd (s, x[i], y[i]);
+  }
+
    // to split mat x vec for symmetric matrices
   void BaseMatrix :: MultAdd1 (double s, const BaseVector & x, BaseVector & y,
 			       const BitArray * ainner,
@@ -298,6 +314,9 @@ namespace ngla
       case MUMPS:           return "mumps";
       case MASTERINVERSE:   return "masterinverse";
       case UMFPACK:         return "umfpack";
+      case SPARSECHOLESKY_ND: return "sparsecholesky_nd";
+      case SPARSECHOLESKY_SUPERNODAL: return "sparsecholesky_supernodal";
+      case SPARSECHOLESKY_SINGLE: return "sparsecholesky_single";
       }
     return "";
   }
@@ -10,10 +10,11 @@
 
 namespace ngla
 {
+  class MultiVector;
 
 
   // sets the solver which is used for InverseMatrix
-  enum INVERSETYPE { PARDISO, PARDISOSPD, SPARSECHOLESKY, SUPERLU, SUPERLU_DIST, MUMPS, MASTERINVERSE, UMFPACK };
+  enum INVERSETYPE { PARDISO, PARDISOSPD, SPARSECHOLESKY, SUPERLU, SUPERLU_DIST, MUMPS, MASTERINVERSE, UMFPACK, SPARSECHOLESKY_ND, SPARSECHOLESKY_SUPERNODAL, SPARSECHOLESKY_SINGLE };
   extern string GetInverseName (INVERSETYPE type);
 
   /**
@@ -109,6 +110,11 @@ namespace ngla
    /// y += s Trans(matrix) * x
     virtual void MultConjTransAdd (Complex s, const BaseVector & x, BaseVector & y) const;
 
+    /// y[i] = matrix * x[i] for all vectors
+    virtual void Mult (const MultiVector & x, MultiVector & y) const;
+    /// y[i] += s matrix * x[i] for all vectors
+    virtual void MultAdd (double s, const MultiVector & x, MultiVector & y) const;
+
 
 
 
@@ -170,6 +170,43 @@ namespace ngla
   }
 
 
+  double BaseVector :: AddAddInnerProduct (double a, const BaseVector & x,
+                                            BaseVector & y, double b, const BaseVector & z,
+                                            const BaseVector * w)
+  {
+    Add (a, x);
+    y.Add (b, z);
+    return w ? y.InnerProductD (*w) : 0.0;
+  }
+
+  double BaseVector :: AddL2Norm (double a, const BaseVector & x)
+  {
+    Add (a, x);
+    return L2Norm();
+  }
+
+  BaseVector & BaseVector :: MultiAdd (double s, FlatArray<double> c,
+                                       FlatArray<const BaseVector*> v)
+  {
+    if (c.Size() != v.Size())
+      throw Exception ("BaseVector::MultiAdd: number of coefficients and vectors don't match");
+
+    size_t first = 0;
+    if (s == 0)
+      {
+        if (c.Size() == 0)
+          return SetScalar (0.0);
+        Set (c[0], *v[0]);
+        first = 1;
+      }
+    else
+      Scale (s);
+    for (size_t i = first; i < c.Size(); i++)
+      Add (c[i], *v[i]);
+    return *this;
+  }
+
+
   double BaseVector :: InnerProductD (const BaseVector & v2) const
   {
     return dynamic_cast<const S_BaseVector<double>&> (*this) . 
@@ -881,6 +918,125 @@ namespace ngla
   
   
 
+  // chunks of the fused kernels, small enough to stay in the L1 cache
+  constexpr size_t FUSED_CHUNK = 1024;
+  
+  template <typename TSCAL>
+  double S_BaseVectorPtr<TSCAL> :: AddAddInnerProduct (double a, const BaseVector & x,
+                                                       BaseVector & y, double b, const BaseVector & z,
+                                                       const BaseVector * w)
+  {
+    if constexpr (!is_same<TSCAL,double>::value)
+      return BaseVector::AddAddInnerProduct (a, x, y, b, z, w);
+    else
+      {
+        static Timer t("BaseVector::AddAddInnerProduct");
+        RegionTimer reg(t);
+
+        auto me = FVDouble();
+        auto fx = x.FVDouble();
+        auto fy = y.FVDouble();
+        auto fz = z.FVDouble();
+        FlatVector<double> fw = w ? w->FVDouble() : fy;
+        if (fx.Size() != me.Size() || fy.Size() != me.Size() ||
+            fz.Size() != me.Size() || fw.Size() != me.Size())
+          throw Exception ("BaseVector::AddAddInnerProduct: vector sizes don't match");
+        t.AddFlops (3*me.Size());
+
+        double parts[16];
+        ParallelJob ([&] (TaskInfo ti)
+                     {
+                       auto r = ngstd::Range(me).Split (ti.task_nr, ti.ntasks);
+                       double sum = 0;
+                       for (size_t first = r.First(); first < r.Next(); first += FUSED_CHUNK)
+                         {
+                           IntRange rc(first, min2(first+FUSED_CHUNK, r.Next()));
+                           me.Range(rc) += a * fx.Range(rc);
+                           fy.Range(rc) += b * fz.Range(rc);
+                           if (w)
+                             sum += ngbla::InnerProduct (fy.Range(rc), fw.Range(rc));
+                         }
+                       parts[ti.task_nr] = sum;
+                     }, 16);
+        double sum = 0;
+        for (double part : parts) sum += part;
+        return sum;
+      }
+  }
+
+  template <typename TSCAL>
+  double S_BaseVectorPtr<TSCAL> :: AddL2Norm (double a, const BaseVector & x)
+  {
+    if constexpr (!is_same<TSCAL,double>::value)
+      return BaseVector::AddL2Norm (a, x);
+    else
+      {
+        static Timer t("BaseVector::AddL2Norm");
+        RegionTimer reg(t);
+
+        auto me = FVDouble();
+        auto fx = x.FVDouble();
+        if (fx.Size() != me.Size())
+          throw Exception ("BaseVector::AddL2Norm: vector sizes don't match");
+        t.AddFlops (2*me.Size());
+
+        double parts[16];
+        ParallelJob ([&] (TaskInfo ti)
+                     {
+                       auto r = ngstd::Range(me).Split (ti.task_nr, ti.ntasks);
+                       double sum = 0;
+                       for (size_t first = r.First(); first < r.Next(); first += FUSED_CHUNK)
+                         {
+                           IntRange rc(first, min2(first+FUSED_CHUNK, r.Next()));
+                           me.Range(rc) += a * fx.Range(rc);
+                           sum += ngbla::L2Norm2 (me.Range(rc));
+                         }
+                       parts[ti.task_nr] = sum;
+                     }, 16);
+        double sum = 0;
+        for (double part : parts) sum += part;
+        return sqrt(sum);
+      }
+  }
+
+  template <typename TSCAL>
+  BaseVector & S_BaseVectorPtr<TSCAL> :: MultiAdd (double s, FlatArray<double> c,
+                                                   FlatArray<const BaseVector*> v)
+  {
+    if constexpr (!is_same<TSCAL,double>::value)
+      return BaseVector::MultiAdd (s, c, v);
+    else
+      {
+        static Timer t("BaseVector::MultiAdd");
+        RegionTimer reg(t);
+
+        if (c.Size() != v.Size())
+          throw Exception ("BaseVector::MultiAdd: number of coefficients and vectors don't match");
+        
+        auto me = FVDouble();
+        Array<double*> pv(v.Size());
+        for (size_t i = 0; i < v.Size(); i++)
+          {
+            auto fv = v[i]->FVDouble();
+            if (fv.Size() != me.Size())
+              throw Exception ("BaseVector::MultiAdd: vector sizes don't match");
+            pv[i] = fv.Data();
+          }
+        t.AddFlops ((v.Size()+1) * me.Size());
+
+        ParallelForRange (me.Size(), [&] (IntRange r)
+                          {
+                            if (s == 0)
+                              me.Range(r) = 0.0;
+                            else if (s != 1)
+                              me.Range(r) *= s;
+                            for (size_t i = 0; i < pv.Size(); i++)
+                              me.Range(r) += c[i] * FlatVector<double>(me.Size(), pv[i]).Range(r);
+                          });
+        return *this;
+      }
+  }
+
   template <typename TSCAL>
   AutoVector S_BaseVectorPtr<TSCAL> :: Range (size_t begin, size_t end) const
   {
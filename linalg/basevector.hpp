@@ -233,6 +233,21 @@ namespace ngla
     virtual BaseVector & Add (double scal, const BaseVector & v);
     virtual BaseVector & Add (Complex scal, const BaseVector & v);
 
+    /*
+      Fused updates for Krylov space methods, one sweep through memory.
+      The default implementations call Add and InnerProduct.
+    */
+    
+    /// this += a x,  y += b z,  returns <y,w>, or 0 if w == nullptr
+    virtual double AddAddInnerProduct (double a, const BaseVector & x,
+                                       BaseVector & y, double b, const BaseVector & z,
+                                       const BaseVector * w);
+    /// this += a x, returns the l2-norm of the result
+    virtual double AddL2Norm (double a, const BaseVector & x);
+    /// this = s * this + sum_i c[i] v[i], for s == 0 this is not read
+    virtual BaseVector & MultiAdd (double s, FlatArray<double> c,
+                                   FlatArray<const BaseVector*> v);
+
     virtual ostream & Print (ostream & ost) const;
     virtual void Save(ostream & ost) const;
     virtual void Load(istream & ist);
@@ -490,6 +505,22 @@ namespace ngla
       return vec->Add (scal,v);
     }
 
+    virtual double AddAddInnerProduct (double a, const BaseVector & x,
+                                       BaseVector & y, double b, const BaseVector & z,
+                                       const BaseVector * w)
+    {
+      return vec->AddAddInnerProduct (a, x, y, b, z, w);
+    }
+    virtual double AddL2Norm (double a, const BaseVector & x)
+    {
+      return vec->AddL2Norm (a, x);
+    }
+    virtual BaseVector & MultiAdd (double s, FlatArray<double> c,
+                                   FlatArray<const BaseVector*> v)
+    {
+      return vec->MultiAdd (s, c, v);
+    }
+
     virtual ostream & Print (ostream & ost) const
     {
       return vec->Print (ost);
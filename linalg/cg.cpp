@@ -12,6 +12,10 @@
 
 #include <la.hpp>
 
+#ifdef PARALLEL
+#include "../parallel/parallelvector.hpp"
+#endif
+
 namespace ngla
 {
   inline double Abs (const double & v)
@@ -604,19 +608,44 @@ namespace ngla
 	    if (kss == 0.0) break;
 	    
 	    al = wd / kss;
-	    u += al * s;
-	    d -= al * w;
 
-	    if (c)
-	      w = (*c) * d;
-	    else
-	      w = d;
-	    wdn = S_InnerProduct<IPTYPE> (d, w);
+            if constexpr (is_same<IPTYPE,double>::value)
+              {
+                // fused updates, without preconditioner (d,d) comes with the update of d
+                if (c)
+                  {
+                    u.AddAddInnerProduct (al, s, d, -al, w, nullptr);
+                    w = (*c) * d;
+                    wdn = S_InnerProduct<IPTYPE> (d, w);
+                  }
+                else
+                  {
+                    // (d,d) from the norm, which knows the parallel status of d
+                    u.Add (al, s);
+                    wdn = sqr (d.AddL2Norm (-al, w));
+                  }
+
+                be = wdn / wd;
+                double one = 1;
+                const BaseVector * pw = c ? &w : &d;
+                s.MultiAdd (be, FlatArray<double>(1, &one), FlatArray<const BaseVector*>(1, &pw));
+              }
+            else
+              {
+                u += al * s;
+                d -= al * w;
+
+                if (c)
+                  w = (*c) * d;
+                else
+                  w = d;
+                wdn = S_InnerProduct<IPTYPE> (d, w);
 
-	    be = wdn / wd;
+                be = wdn / wd;
 	    
-	    s *= be;
-	    s += w;
+                s *= be;
+                s += w;
+              }
 
 	    if (printrates ) cout << IM(1) << n << " " << sqrt (Abs (wdn)) << endl;
 	    if ( sh )
@@ -720,9 +749,19 @@ namespace ngla
 	    rho_old = rho_new;
 	    rho_new = S_InnerProduct<IPTYPE>(r_tilde, r);
 	    beta = (rho_new / rho_old ) * ( alpha / omega );
-	    p = r;
-	    p += beta * p;
-	    p -= beta*omega * v;
+            // p = r + beta (p - omega v)
+            if constexpr (is_same<IPTYPE,double>::value)
+              {
+                double coefs[2] = { 1, -beta*omega };
+                const BaseVector * vecs[2] = { &r, &v };
+                p.MultiAdd (beta, FlatArray<double>(2, coefs), FlatArray<const BaseVector*>(2, vecs));
+              }
+            else
+              {
+                p *= beta;
+                p += r;
+                p -= beta*omega * v;
+              }
 
 	    if (c)
 	      p_tilde = (*c) * p;
@@ -732,9 +771,13 @@ namespace ngla
 	    v = (*a) * p_tilde;
 	    alpha = rho_new / S_InnerProduct<IPTYPE> (r_tilde, v);
 	    s = r;
-	    s -= alpha * v;
-
-	    err_i = L2Norm(s);
+            if constexpr (is_same<IPTYPE,double>::value)
+              err_i = s.AddL2Norm (-alpha, v);
+            else
+              {
+                s -= alpha * v;
+                err_i = L2Norm(s);
+              }
 	    u += alpha * p_tilde;
 	    
 	    if ( err_i < err )
@@ -752,9 +795,13 @@ namespace ngla
 	    omega = S_InnerProduct<IPTYPE> (t, s) / S_InnerProduct<IPTYPE> (t, t);
 	    u +=  omega * s_tilde;
 	    r = s;
-	    r -= omega * t;
-
-	    err_i = L2Norm(r);
+            if constexpr (is_same<IPTYPE,double>::value)
+              err_i = r.AddL2Norm (-omega, t);
+            else
+              {
+                r -= omega * t;
+                err_i = L2Norm(r);
+              }
 
 	    if (printrates ) cout << IM(1) << n << " " << err_i << endl;
 	    if(sh)
@@ -1031,6 +1078,839 @@ namespace ngla
 
 
 
+  /*
+    Cholesky factorization g = l l^T, stops at the first pivot which
+    is small relative to the diagonal entry. Returns the number of
+    computed columns, these are filled also below the leading block.
+  */
+  static int PartialCholesky (FlatMatrix<> g, FlatMatrix<> l)
+  {
+    int n = g.Height();
+    l = 0.0;
+    for (int k = 0; k < n; k++)
+      {
+        double d = g(k,k);
+        for (int j = 0; j < k; j++)
+          d -= sqr(l(k,j));
+        if (d <= 1e-14 * g(k,k) || d <= 0)
+          return k;
+        l(k,k) = sqrt(d);
+        for (int i = k+1; i < n; i++)
+          {
+            double sum = g(i,k);
+            for (int j = 0; j < k; j++)
+              sum -= l(i,j) * l(k,j);
+            l(i,k) = sum / l(k,k);
+          }
+      }
+    return n;
+  }
+
+  /*
+    Local parts of a few inner products, summed up by one
+    non-blocking allreduce. The caller does other work between
+    Start and Wait.
+  */
+  template <class IPTYPE>
+  class AsyncInnerProducts
+  {
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    Vector<SCAL> values;
+    bool parallel = false;
+#ifdef PARALLEL
+    MPI_Comm comm;
+    MPI_Request request = MPI_REQUEST_NULL;
+#endif
+  public:
+    AsyncInnerProducts (size_t n) : values(n) { ; }
+
+    // local part of (a,b). One of the vectors must be distributed and
+    // the other one cumulated, otherwise the statuses are fixed here.
+    void Set (size_t i, const BaseVector & a, const BaseVector & b)
+    {
+#ifdef PARALLEL
+      auto para = dynamic_cast_ParallelBaseVector (&a);
+      auto parb = dynamic_cast_ParallelBaseVector (&b);
+      if (para && parb && para->IsParallelVector() && parb->IsParallelVector())
+        {
+          if (para == parb)
+            throw Exception ("AsyncInnerProducts: vectors must be different");
+          if (para->Status() == parb->Status())
+            {
+              if (para->Status() == DISTRIBUTED)
+                para->Cumulate();
+              else
+                para->Distribute();
+            }
+          values(i) = S_InnerProduct<IPTYPE> (*para->GetLocalVector(), *parb->GetLocalVector());
+          comm = para->GetParallelDofs()->GetCommunicator();
+          parallel = true;
+          return;
+        }
+#endif
+      values(i) = S_InnerProduct<IPTYPE> (a, b);
+    }
+
+    void Start ()
+    {
+#ifdef PARALLEL
+      if (parallel)
+        MPI_Iallreduce (MPI_IN_PLACE, values.Data(), values.Size(), MyGetMPIType<SCAL>(),
+                        MPI_SUM, comm, &request);
+#endif
+    }
+
+    FlatVector<SCAL> Wait ()
+    {
+#ifdef PARALLEL
+      if (parallel)
+        MPI_Wait (&request, MPI_STATUS_IGNORE);
+#endif
+      return values;
+    }
+  };
+
+
+
+  template <class IPTYPE>
+  void PipelinedCGSolver<IPTYPE> :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer timer ("pipelined CG solver");
+    RegionTimer reg (timer);
+
+    try
+      {
+        // Ghysels, Vanroose: Hiding global synchronization latency in
+        // the preconditioned conjugate gradient algorithm, Alg. 4
+	if(sh)
+	  sh->SetThreadPercentage(0);
+
+        auto r = f.CreateVector();
+        auto u = f.CreateVector();
+        auto w = f.CreateVector();
+        auto m = f.CreateVector();
+        auto nv = f.CreateVector();
+        auto z = f.CreateVector();
+        auto q = f.CreateVector();
+        auto s = f.CreateVector();
+        auto p = f.CreateVector();
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+          r = f - (*a) * x;
+
+        if (c)
+          u = (*c) * r;
+        else
+          u = r;
+        w = (*a) * u;
+
+        AsyncInnerProducts<IPTYPE> ips(2);
+        SCAL gamma, gamma_old = 1.0, delta, alpha = 1.0, beta;
+        double err = 0, lwstart = 0, lerr = 0;
+        int n = 0;
+
+        while (true)
+          {
+            ips.Set (0, r, u);
+            ips.Set (1, w, u);
+            ips.Start();
+
+            // overlapped with the reduction
+            if (c)
+              m = (*c) * w;
+            else
+              m = w;
+            nv = (*a) * m;
+
+            FlatVector<SCAL> vals = ips.Wait();
+            gamma = vals(0);
+            delta = vals(1);
+
+            if (n == 0)
+              {
+                if (printrates) cout << IM(1) << "0 " << sqrt(Abs(gamma)) << endl;
+                double gamma0 = (gamma == 0.0) ? 1 : Abs(gamma);
+                err = stop_absolute ? prec * prec : prec * prec * gamma0;
+                lwstart = log(gamma0);
+                lerr = log(err);
+              }
+            else
+              {
+                if (printrates) cout << IM(1) << n << " " << sqrt (Abs (gamma)) << endl;
+                if (sh)
+                  sh->SetThreadPercentage(100.*max2(double(n)/double(maxsteps),
+                                                    (lwstart-log(Abs(gamma)))/(lwstart-lerr)));
+              }
+
+            if (n >= maxsteps || Abs(gamma) <= err || (sh && sh->ShouldTerminate()))
+              break;
+
+            if (n == 0)
+              {
+                if (delta == 0.0) break;
+                alpha = gamma / delta;
+                z = nv;
+                q = m;
+                s = w;
+                p = u;
+              }
+            else
+              {
+                beta = gamma / gamma_old;
+                SCAL denom = delta - beta * gamma / alpha;
+                if (denom == 0.0) break;
+                alpha = gamma / denom;
+                z *= beta; z += nv;
+                q *= beta; q += m;
+                s *= beta; s += w;
+                p *= beta; p += u;
+              }
+
+            x += alpha * p;
+            r -= alpha * s;
+            u -= alpha * q;
+            w -= alpha * z;
+
+            gamma_old = gamma;
+            n++;
+          }
+
+	const_cast<int&> (steps) = n;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in PipelinedCGSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in PipelinedCGSolver::Mult\n"));
+      }
+  }
+
+
+
+
+  void SStepGMRESSolver :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer timer ("s-step GMRES solver");
+    static Timer timer_mpk ("s-step GMRES solver - Krylov vectors");
+    static Timer timer_orth ("s-step GMRES solver - orthogonalize");
+    RegionTimer reg (timer);
+
+    try
+      {
+        if (f.IsComplex())
+          throw Exception ("SStepGMRESSolver: only real systems are supported");
+
+        auto r = f.CreateVector();
+        auto hv = f.CreateVector();
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+          r = f - (*a) * x;
+
+        if (c)
+          {
+            hv = (*c) * r;
+            r = hv;
+          }
+
+        int mmax = maxsteps;
+        auto basis = MultiVector::Create (f, mmax+1);
+        auto block = MultiVector::Create (f, sstep);
+        MultiVector & Q = *basis;
+        MultiVector & W = *block;
+
+        // h2 .. Hessenberg matrix, h .. triangular after Givens rotations
+        Matrix<> h(mmax+1, mmax), h2(mmax+1, mmax);
+        Vector<> gamma(mmax+1), cs(mmax), sn(mmax);
+        h = 0.0;
+        h2 = 0.0;
+        gamma = 0.0;
+
+        double norm = r.L2Norm();
+        gamma(0) = norm;
+	if (printrates) cout << IM(1) << "0 " << norm << endl;
+
+	double err = stop_absolute ? prec : prec * norm;
+        if (norm == 0.0)
+          {
+            const_cast<int&> (steps) = 0;
+            return;
+          }
+        Q[0] = (1.0/norm) * r;
+
+        int j = 0;   // number of finished columns of h
+        while (j < mmax && norm > err)
+          {
+            int s = min2 (sstep, mmax-j);
+
+            // monomial basis w_i = (C A)^i q_j, no communication but the operators
+            timer_mpk.Start();
+            for (int i = 0; i < s; i++)
+              {
+                hv = (*a) * (i == 0 ? Q[j] : W[i-1]);
+                if (c)
+                  W[i] = (*c) * hv;
+                else
+                  W[i] = hv;
+              }
+            timer_mpk.Stop();
+
+            // w_k = sum_i R(i,k) q_i
+            RegionTimer rorth(timer_orth);
+            auto Wb = W.Range (IntRange(0, s));
+            auto Qj = Q.Range (IntRange(0, j+1));
+            Matrix<> R(j+1+s, s);
+            R = 0.0;
+
+            // block classical Gram-Schmidt, applied twice
+            for (int pass = 0; pass < 2; pass++)
+              {
+                Matrix<> R1 = Qj->InnerProducts (*Wb);
+                Qj->MultAdd (-1, R1, *Wb);
+                R.Rows(0, j+1) += R1;
+              }
+
+            // Cholesky-QR of the block, stops at the first dependent vector
+            Matrix<> G = Wb->InnerProducts (*Wb);
+            Matrix<> L(s);
+            int rank = PartialCholesky (G, L);
+            for (int k = 0; k < s; k++)
+              for (int i = 0; i < min2(k+1, rank); i++)
+                R(j+1+i, k) = L(k,i);
+
+            if (rank > 0)
+              {
+                Matrix<> R2inv = Trans (L.Rows(0,rank).Cols(0,rank));
+                CalcInverse (R2inv);
+                Wb->Range (IntRange(0, rank)) -> Mult (R2inv, *Q.Range (IntRange(j+1, j+1+rank)));
+              }
+
+            // Hessenberg columns j .. j+nc-1 from
+            // (C A) [q_j, w_1 .. w_{nc-1}] = [w_1 .. w_nc]
+            int nc = (rank < s) ? rank+1 : s;
+            Matrix<> Cm(j+nc, nc);
+            Cm = 0.0;
+            Cm(j, 0) = 1;
+            for (int i = 1; i < nc; i++)
+              Cm.Col(i) = R.Col(i-1).Range(0, j+nc);
+
+            Matrix<> hnew(j+nc+1, nc);
+            hnew = R.Rows(0, j+nc+1).Cols(0, nc);
+            if (j > 0)
+              hnew.Rows(0, j+1) -= h2.Rows(0, j+1).Cols(0, j) * Cm.Rows(0, j);
+            Matrix<> Cinv = Cm.Rows(j, j+nc);
+            CalcInverse (Cinv);
+            h2.Rows(0, j+nc+1).Cols(j, j+nc) = hnew * Cinv;
+
+            // Givens rotations for the new columns
+            for (int col = j; col < j+nc; col++)
+              {
+                h.Col(col).Range(0, col+2) = h2.Col(col).Range(0, col+2);
+                for (int i = 0; i < col; i++)
+                  {
+                    double hi = h(i,col), hip = h(i+1,col);
+                    h(i,col)   = cs(i) * hi + sn(i) * hip;
+                    h(i+1,col) = -sn(i) * hi + cs(i) * hip;
+                  }
+                double beta = sqrt (sqr(h(col,col)) + sqr(h(col+1,col)));
+                cs(col) = h(col,col) / beta;
+                sn(col) = h(col+1,col) / beta;
+                h(col,col) = beta;
+                h(col+1,col) = 0;
+                gamma(col+1) = -sn(col) * gamma(col);
+                gamma(col) = cs(col) * gamma(col);
+
+                norm = fabs (gamma(col+1));
+                if (printrates) cout << IM(1) << col+1 << " " << norm << endl;
+              }
+
+            j += nc;
+            if (rank < s) break;   // invariant Krylov space
+          }
+
+        // x += Q y,  h y = gamma
+        Vector<> y(j);
+        for (int i = j-1; i >= 0; i--)
+          {
+            double sum = gamma(i);
+            for (int k = i+1; k < j; k++)
+              sum -= h(i,k) * y(k);
+            y(i) = sum / h(i,i);
+          }
+        Q.Range (IntRange(0, j)) -> MultAdd (1, y, x);
+
+	const_cast<int&> (steps) = j;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in SStepGMRESSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in SStepGMRESSolver::Mult\n"));
+      }
+  }
+
+
+
+
+
+
+
+  /*
+    Eigenvalues of the symmetric matrix m in ascending order,
+    the rows of evecs are the eigenvectors.
+  */
+  static void SortedEigenSystem (FlatMatrix<> m, FlatVector<> lami, FlatMatrix<> evecs)
+  {
+    int n = m.Height();
+#ifdef LAPACK
+    Matrix<> hm = m;
+    LapackEigenValuesSymmetric (hm, lami, evecs);
+#else
+    Vector<> hlami(n);
+    Matrix<> hevecs(n);
+    FlatVector<> flami = hlami;
+    FlatMatrix<> fevecs = hevecs;
+    CalcEigenSystem (m, flami, fevecs);
+    Array<int> index(n);
+    for (int i = 0; i < n; i++) index[i] = i;
+    std::sort (index.begin(), index.end(),
+               [&] (int i, int j) { return hlami(i) < hlami(j); });
+    for (int i = 0; i < n; i++)
+      {
+        lami(i) = hlami(index[i]);
+        evecs.Row(i) = hevecs.Row(index[i]);
+      }
+#endif
+  }
+
+
+  /*
+    B U = Q R, afterwards bu = Q and u = U R^{-1}, for the
+    first n vectors. Returns the rank.
+  */
+  static int RecycleQR (MultiVector & u, MultiVector & bu, int n)
+  {
+    if (n == 0) return 0;
+    auto bun = bu.Range (IntRange(0, n));
+    Matrix<> g = bun->InnerProducts (*bun);
+    Matrix<> l(n);
+    int rank = PartialCholesky (g, l);
+    if (rank == 0) return 0;
+
+    Matrix<> rinv = Trans (l.Rows(0,rank).Cols(0,rank));
+    CalcInverse (rinv);
+    auto tmp = MultiVector::Create (u[0], rank);
+    u.Range (IntRange(0, rank)) -> Mult (rinv, *tmp);
+    for (int i = 0; i < rank; i++) u[i] = (*tmp)[i];
+    bu.Range (IntRange(0, rank)) -> Mult (rinv, *tmp);
+    for (int i = 0; i < rank; i++) bu[i] = (*tmp)[i];
+    return rank;
+  }
+
+
+
+  void DeflatedCGSolver :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer timer ("deflated CG solver");
+    static Timer timer_recycle ("deflated CG solver - recycle");
+    RegionTimer reg (timer);
+
+    try
+      {
+        if (f.IsComplex())
+          throw Exception ("DeflatedCGSolver: only real systems are supported");
+	if(sh)
+	  sh->SetThreadPercentage(0);
+
+        int k = nrecycle;
+        int nstore = 2*nrecycle;
+        if (recycled && recycled->VectorSize() != f.Size())
+          {
+            recycled = nullptr;
+            nrecycled = 0;
+          }
+        int nu = recycled ? nrecycled : 0;
+
+        auto r = f.CreateVector();
+        auto z = f.CreateVector();
+        auto p = f.CreateVector();
+        auto w = f.CreateVector();
+
+        // [U, P] and A [U, P], U recycled, P first search directions
+        auto wmv = MultiVector::Create (f, max2(nu + nstore, 1));
+        auto awmv = MultiVector::Create (f, max2(nu + nstore, 1));
+        MultiVector & W = *wmv;
+        MultiVector & AW = *awmv;
+
+        Matrix<> einv;
+        if (nu > 0)
+          {
+            RegionTimer rr(timer_recycle);
+            for (int i = 0; i < nu; i++)
+              W[i] = (*recycled)[i];
+            a->Mult (*W.Range(IntRange(0, nu)), *AW.Range(IntRange(0, nu)));
+            Matrix<> e = W.Range(IntRange(0, nu))->InnerProducts (*AW.Range(IntRange(0, nu)));
+            Matrix<> es = 0.5 * (e + Trans(e));
+            Matrix<> l(nu);
+            nu = PartialCholesky (es, l);
+            einv.SetSize (nu, nu);
+            einv = es.Rows(0,nu).Cols(0,nu);
+            if (nu > 0)
+              CalcInverse (einv);
+          }
+        auto U = W.Range (IntRange(0, nu));
+        auto AU = AW.Range (IntRange(0, nu));
+
+        // v -= U E^{-1} (AU)^T v
+        auto deflate = [&] (BaseVector & v)
+          {
+            if (nu == 0) return;
+            Vector<> coefs = einv * AU->InnerProducts (v);
+            U->MultAdd (-1, coefs, v);
+          };
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+          r = f - (*a) * x;
+
+        // x in the A-orthogonal complement, then r is orthogonal to U
+        if (nu > 0)
+          {
+            Vector<> coefs = einv * U->InnerProducts (r);
+            U->MultAdd (1, coefs, x);
+            AU->MultAdd (-1, coefs, r);
+          }
+
+        if (c)
+          z = (*c) * r;
+        else
+          z = r;
+        p = z;
+        deflate (p);
+
+        double wdn = InnerProduct (r, z);
+	if (printrates) cout << IM(1) << "0 " << sqrt(fabs(wdn)) << endl;
+	if (wdn == 0.0) wdn = 1;
+
+        double err = stop_absolute ? prec * prec : prec * prec * fabs(wdn);
+	double lwstart = log(fabs(wdn));
+	double lerr = log(err);
+
+        int n = 0, np = 0;
+        double one = 1;
+        const BaseVector * pz = &z;
+	while (n++ < maxsteps && fabs(wdn) > err && !(sh && sh->ShouldTerminate()))
+	  {
+            w = (*a) * p;
+            double kss = InnerProduct (p, w);
+            if (kss == 0.0) break;
+
+            // A-normalized directions for the Ritz values
+            if (np < nstore && kss > 0)
+              {
+                W[nu+np] = (1/sqrt(kss)) * p;
+                AW[nu+np] = (1/sqrt(kss)) * w;
+                np++;
+              }
+
+            double al = wdn / kss;
+            x.AddAddInnerProduct (al, p, r, -al, w, nullptr);
+
+            if (c)
+              z = (*c) * r;
+            else
+              z = r;
+            double wd = wdn;
+            wdn = InnerProduct (r, z);
+            double be = wdn / wd;
+
+            p.MultiAdd (be, FlatArray<double>(1, &one), FlatArray<const BaseVector*>(1, &pz));
+            deflate (p);
+
+	    if (printrates ) cout << IM(1) << n << " " << sqrt (fabs (wdn)) << endl;
+	    if (sh)
+	      sh->SetThreadPercentage(100.*max2(double(n)/double(maxsteps),
+						(lwstart-log(fabs(wdn)))/(lwstart-lerr)));
+	  }
+	const_cast<int&> (steps) = n;
+
+        // Rayleigh-Ritz in span [U, P]: G y = theta F y, keep the smallest theta
+        int m = nu + np;
+        if (k > 0 && m > 0)
+          {
+            RegionTimer rr(timer_recycle);
+            auto Ws = W.Range (IntRange(0, m));
+            Matrix<> g = Ws->InnerProducts (*AW.Range (IntRange(0, m)));
+            Matrix<> gs = 0.5 * (g + Trans(g));
+            Matrix<> fm = Ws->InnerProducts (*Ws);
+            Matrix<> l(m);
+            int mm = PartialCholesky (gs, l);
+            if (mm > 0)
+              {
+                // 1/theta are the eigenvalues of L^{-1} F L^{-T}
+                Matrix<> linv = l.Rows(0,mm).Cols(0,mm);
+                CalcInverse (linv);
+                Matrix<> hm = linv * fm.Rows(0,mm).Cols(0,mm) * Trans(linv);
+                Vector<> lami(mm);
+                Matrix<> evecs(mm);
+                SortedEigenSystem (hm, lami, evecs);
+
+                int kk = min2 (k, mm);
+                Matrix<> y(mm, kk);
+                for (int i = 0; i < kk; i++)
+                  y.Col(i) = Trans(linv) * evecs.Row(mm-1-i);
+
+                if (!recycled)
+                  recycled = MultiVector::Create (f, k);
+                Ws->Range (IntRange(0, mm)) -> Mult (y, *recycled->Range (IntRange(0, kk)));
+                nrecycled = kk;
+              }
+          }
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in DeflatedCGSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in DeflatedCGSolver::Mult\n"));
+      }
+  }
+
+
+
+
+  void GCROSolver :: Mult (const BaseVector & f, BaseVector & x) const
+  {
+    static Timer timer ("GCRO solver");
+    RegionTimer reg (timer);
+
+    try
+      {
+        if (f.IsComplex())
+          throw Exception ("GCROSolver: only real systems are supported");
+	if(sh)
+	  sh->SetThreadPercentage(0);
+
+        int k = nrecycle;
+        int m = restart;
+        if (recycled && recycled->VectorSize() != f.Size())
+          {
+            recycled = nullptr;
+            nrecycled = 0;
+          }
+        if (!recycled && k > 0)
+          recycled = MultiVector::Create (f, k);
+
+        auto r = f.CreateVector();
+        auto hv = f.CreateVector();
+        auto d = f.CreateVector();
+        auto bd = f.CreateVector();
+
+        // bu = C A U, orthonormal after RecycleQR
+        shared_ptr<MultiVector> bumv = k > 0 ? MultiVector::Create (f, k) : nullptr;
+        int nu = 0;
+        if (k > 0)
+          {
+            for (int i = 0; i < nrecycled; i++)
+              {
+                hv = (*a) * (*recycled)[i];
+                if (c)
+                  (*bumv)[i] = (*c) * hv;
+                else
+                  (*bumv)[i] = hv;
+              }
+            nu = RecycleQR (*recycled, *bumv, nrecycled);
+          }
+
+	if (initialize)
+	  {
+	    x = 0.0;
+	    r = f;
+	  }
+	else
+          r = f - (*a) * x;
+        if (c)
+          {
+            hv = (*c) * r;
+            r = hv;
+          }
+
+        double norm = r.L2Norm();
+	if (printrates) cout << IM(1) << "0 " << norm << endl;
+        double err = stop_absolute ? prec : prec * norm;
+
+        // x += U C^T r,  r -= C C^T r
+        if (nu > 0)
+          {
+            auto U = recycled->Range (IntRange(0, nu));
+            auto BU = bumv->Range (IntRange(0, nu));
+            Vector<> coefs = BU->InnerProducts (r);
+            U->MultAdd (1, coefs, x);
+            BU->MultAdd (-1, coefs, r);
+            norm = r.L2Norm();
+          }
+
+        auto vmv = MultiVector::Create (f, m+1);
+        MultiVector & V = *vmv;
+        Matrix<> h(m+1, m), hr(m+1, m), bm(max2(k,1), m);
+        Vector<> gamma(m+1), cs(m), sn(m), y(m);
+
+        int it = 0;
+        while (norm > err && it < maxsteps && !(sh && sh->ShouldTerminate()))
+          {
+            V[0] = (1.0/norm) * r;
+            h = 0.0;
+            bm = 0.0;
+            gamma = 0.0;
+            gamma(0) = norm;
+
+            int j = 0;
+            while (j < m && it < maxsteps)
+              {
+                hv = (*a) * V[j];
+                if (c)
+                  V[j+1] = (*c) * hv;
+                else
+                  V[j+1] = hv;
+
+                // project out C
+                if (nu > 0)
+                  {
+                    auto BU = bumv->Range (IntRange(0, nu));
+                    Vector<> bc = BU->InnerProducts (V[j+1]);
+                    BU->MultAdd (-1, bc, V[j+1]);
+                    bm.Col(j).Range(0, nu) = bc;
+                  }
+
+                // Arnoldi, classical Gram-Schmidt applied twice
+                auto Vj = V.Range (IntRange(0, j+1));
+                for (int pass = 0; pass < 2; pass++)
+                  {
+                    Vector<> hc = Vj->InnerProducts (V[j+1]);
+                    Vj->MultAdd (-1, hc, V[j+1]);
+                    h.Col(j).Range(0, j+1) += hc;
+                  }
+                double hn = V[j+1].L2Norm();
+                h(j+1, j) = hn;
+                if (hn != 0)
+                  V[j+1].Scale (1/hn);
+
+                hr.Col(j).Range(0, j+2) = h.Col(j).Range(0, j+2);
+                for (int i = 0; i < j; i++)
+                  {
+                    double hi = hr(i,j), hip = hr(i+1,j);
+                    hr(i,j)   = cs(i) * hi + sn(i) * hip;
+                    hr(i+1,j) = -sn(i) * hi + cs(i) * hip;
+                  }
+                double beta = sqrt (sqr(hr(j,j)) + sqr(hr(j+1,j)));
+                cs(j) = hr(j,j) / beta;
+                sn(j) = hr(j+1,j) / beta;
+                hr(j,j) = beta;
+                hr(j+1,j) = 0;
+                gamma(j+1) = -sn(j) * gamma(j);
+                gamma(j) = cs(j) * gamma(j);
+
+                j++;
+                it++;
+                norm = fabs (gamma(j));
+                if (printrates) cout << IM(1) << it << " " << norm << endl;
+                if (sh)
+                  sh->SetThreadPercentage(100.*double(it)/double(maxsteps));
+                if (norm <= err || hn == 0) break;
+              }
+
+            for (int i = j-1; i >= 0; i--)
+              {
+                double sum = gamma(i);
+                for (int l = i+1; l < j; l++)
+                  sum -= hr(i,l) * y(l);
+                y(i) = sum / hr(i,i);
+              }
+
+            // d = V y - U B y, and C A d = V H y
+            d = 0.0;
+            V.Range (IntRange(0, j)) -> MultAdd (1, y.Range(0, j), d);
+            if (nu > 0)
+              {
+                Vector<> by = bm.Rows(0, nu).Cols(0, j) * y.Range(0, j);
+                recycled->Range (IntRange(0, nu)) -> MultAdd (-1, by, d);
+              }
+            Vector<> hy = h.Rows(0, j+1).Cols(0, j) * y.Range(0, j);
+            bd = 0.0;
+            V.Range (IntRange(0, j+1)) -> MultAdd (1, hy, bd);
+
+            x += d;
+            r -= bd;
+            norm = r.L2Norm();
+
+            // recycle the correction, C A d is orthogonal to C already
+            double nbd = bd.L2Norm();
+            if (k > 0 && nbd > 0)
+              {
+                if (nu == k)
+                  {
+                    for (int i = 0; i < k-1; i++)
+                      {
+                        (*recycled)[i] = (*recycled)[i+1];
+                        (*bumv)[i] = (*bumv)[i+1];
+                      }
+                    nu--;
+                  }
+                (*recycled)[nu] = (1/nbd) * d;
+                (*bumv)[nu] = (1/nbd) * bd;
+                nu++;
+              }
+          }
+
+        nrecycled = nu;
+	const_cast<int&> (steps) = it;
+      }
+
+    catch (Exception & e)
+      {
+	e.Append ("in caught in GCROSolver::Mult\n");
+	throw;
+      }
+    catch (exception & e)
+      {
+	throw Exception(e.what() +
+			string ("\ncaught in GCROSolver::Mult\n"));
+      }
+  }
+
+
+
+
+
+
+
 //*****************************************************************
 // Iterative template routine -- QMR
 //
@@ -1334,6 +2214,10 @@ void QMRSolver<SCAL> :: Mult (const BaseVector & b, BaseVector & x) const
   template class GMRESSolver<Complex>;
   template class GMRESSolver<ComplexConjugate>;
   template class GMRESSolver<ComplexConjugate2>;
+  template class PipelinedCGSolver<double>;
+  template class PipelinedCGSolver<Complex>;
+  template class PipelinedCGSolver<ComplexConjugate>;
+  template class PipelinedCGSolver<ComplexConjugate2>;
 
 
 }
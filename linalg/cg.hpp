@@ -196,7 +196,127 @@ namespace ngla
     ///
     virtual void Mult (const BaseVector & v, BaseVector & prod) const;
   };
-  
+
+
+
+  /**
+     Pipelined conjugate gradient solver (Ghysels, Vanroose).
+
+     Both inner products of an iteration are summed up by one
+     non-blocking allreduce, which runs while the preconditioner
+     and the matrix are applied. Costs three more vectors and
+     vector updates than CGSolver.
+  */
+  template <class IPTYPE>
+  class NGS_DLL_HEADER PipelinedCGSolver : public KrylovSpaceSolver
+  {
+  public:
+    typedef typename SCAL_TRAIT<IPTYPE>::SCAL SCAL;
+    ///
+    PipelinedCGSolver ()
+      : KrylovSpaceSolver () { ; }
+    ///
+    PipelinedCGSolver (shared_ptr<BaseMatrix> aa)
+      : KrylovSpaceSolver (aa) { ; }
+    ///
+    PipelinedCGSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac)
+      : KrylovSpaceSolver (aa, ac) { ; }
+
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
+
+  /**
+     s-step (communication avoiding) GMRES solver for real systems.
+
+     s Krylov vectors are generated at once by the monomial basis
+     (C A)^i v, without any inner product. The block is orthogonalized
+     against the basis by block Gram-Schmidt and within itself by
+     Cholesky-QR, which are three global reductions per s steps.
+     The Hessenberg matrix is recovered from the triangular factors.
+     The monomial basis gets ill-conditioned for large s, s = 4..8
+     is a reasonable choice.
+  */
+  class NGS_DLL_HEADER SStepGMRESSolver : public KrylovSpaceSolver
+  {
+    int sstep = 4;
+  public:
+    ///
+    SStepGMRESSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac = nullptr)
+      : KrylovSpaceSolver (aa, ac) { ; }
+
+    void SetSStep (int as) { sstep = max2 (as, 1); }
+
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
+
+  /**
+     Deflated conjugate gradient solver for sequences of SPD systems
+     (Saad, Yeung, Erhel, Guyomarc'h).
+
+     The iteration runs in the A-orthogonal complement of a recycled
+     space U. After each solve U is replaced by the Ritz vectors of
+     the smallest eigenvalues, computed from U and the first search
+     directions. The matrix may change between calls, A U is
+     recomputed at the beginning of every Mult. Real systems only.
+  */
+  class NGS_DLL_HEADER DeflatedCGSolver : public KrylovSpaceSolver
+  {
+    int nrecycle = 8;
+    mutable shared_ptr<MultiVector> recycled;
+    mutable int nrecycled = 0;
+  public:
+    ///
+    DeflatedCGSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac = nullptr)
+      : KrylovSpaceSolver (aa, ac) { ; }
+
+    /// dimension of the recycled space
+    void SetNumRecycle (int an) { nrecycle = max2 (an, 0); ClearRecycling(); }
+    int GetNumRecycled () const { return nrecycled; }
+    void ClearRecycling () { recycled = nullptr; nrecycled = 0; }
+
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
+
+
+  /**
+     GCRO solver with recycling for sequences of general real systems,
+     left preconditioned.
+
+     Restarted GMRES for the operator projected to the complement of
+     C A U, where U are the corrections of the latest restart cycles,
+     also of previous calls of Mult. This is GCRO-DR with recycled
+     corrections instead of harmonic Ritz vectors, so no eigenvalue
+     problem has to be solved.
+  */
+  class NGS_DLL_HEADER GCROSolver : public KrylovSpaceSolver
+  {
+    int restart = 30;
+    int nrecycle = 8;
+    mutable shared_ptr<MultiVector> recycled;
+    mutable int nrecycled = 0;
+  public:
+    ///
+    GCROSolver (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ac = nullptr)
+      : KrylovSpaceSolver (aa, ac) { ; }
+
+    void SetRestart (int ar) { restart = max2 (ar, 1); }
+    /// dimension of the recycled space
+    void SetNumRecycle (int an) { nrecycle = max2 (an, 0); ClearRecycling(); }
+    int GetNumRecycled () const { return nrecycled; }
+    void ClearRecycling () { recycled = nullptr; nrecycled = 0; }
+
+    ///
+    virtual void Mult (const BaseVector & v, BaseVector & prod) const;
+  };
+
 
 
 
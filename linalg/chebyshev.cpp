@@ -78,4 +78,67 @@ namespace ngla
 	  }
       }
   }
+
+
+
+  ChebyshevJacobi :: ChebyshevJacobi (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> adinv,
+                                      int adegree, double ratio, int evsteps)
+    : a(aa), dinv(adinv), degree(max2(adegree, 1))
+  {
+    static Timer t("ChebyshevJacobi - estimate lambda max");
+    RegionTimer reg(t);
+
+    EigenSystem eigen (*a, *dinv);
+    eigen.SetMaxSteps (evsteps);
+    eigen.SetPrecision (1e-2);
+    eigen.Calc();
+    // Lanczos approximates lambda max from below
+    lmax = 1.1 * eigen.MaxEigenValue();
+    lmin = lmax / ratio;
+    if (!(lmax > 0))
+      throw Exception ("ChebyshevJacobi: lambda max estimate failed, is the matrix positive definite ?");
+  }
+
+  void ChebyshevJacobi :: Smooth (BaseVector & x, const BaseVector & b, int steps) const
+  {
+    static Timer t("ChebyshevJacobi::Smooth");
+    RegionTimer reg(t);
+
+    auto r = b.CreateVector();
+    auto z = b.CreateVector();
+    auto d = b.CreateVector();
+    auto ad = b.CreateVector();
+
+    double theta = 0.5 * (lmax + lmin);
+    double delta = 0.5 * (lmax - lmin);
+    double sigma = theta / delta;
+
+    for (int step = 0; step < steps; step++)
+      {
+        r = b - (*a) * x;
+        d = (*dinv) * r;
+        d *= 1/theta;
+        double rho = 1 / sigma;
+
+        for (int k = 1; k < degree; k++)
+          {
+            x += d;
+            ad = (*a) * d;
+            r -= ad;
+            z = (*dinv) * r;
+
+            double rho_new = 1 / (2*sigma - rho);
+            d *= rho_new * rho;
+            d += (2 * rho_new / delta) * z;
+            rho = rho_new;
+          }
+        x += d;
+      }
+  }
+
+  void ChebyshevJacobi :: Mult (const BaseVector & b, BaseVector & x) const
+  {
+    x = 0.0;
+    Smooth (x, b, 1);
+  }
 }
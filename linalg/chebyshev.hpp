@@ -36,6 +36,46 @@ namespace ngla
     AutoVector CreateColVector () const override { return a->CreateRowVector(); }
   };
 
+
+
+  /**
+     Chebyshev accelerated (block-)Jacobi smoother.
+
+     The error is damped by a Chebyshev polynomial in D^{-1} A on the
+     interval [lmax/ratio, lmax], where D^{-1} is a point or block
+     Jacobi preconditioner. lmax is estimated by a few Lanczos steps
+     (EigenSystem) in the constructor. Needs only matrix-vector
+     products and the Jacobi preconditioner, no ordering or coloring.
+     Mult applies the smoother to a zero initial guess, which is a
+     symmetric preconditioner.
+  */
+  class NGS_DLL_HEADER ChebyshevJacobi : public BaseMatrix
+  {
+  protected:
+    shared_ptr<BaseMatrix> a, dinv;
+    /// degree of the polynomial, number of matrix-vector products per step
+    int degree;
+    double lmin, lmax;
+  public:
+    ///
+    ChebyshevJacobi (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> adinv,
+                     int adegree = 3, double ratio = 30, int evsteps = 10);
+
+    bool IsComplex() const override { return a->IsComplex(); }
+    double GetLambdaMax () const { return lmax; }
+    ///
+    void SetBounds (double almin, double almax) { lmin = almin; lmax = almax; }
+    /// steps smoothing iterations for A x = b
+    void Smooth (BaseVector & x, const BaseVector & b, int steps = 1) const;
+    ///
+    void Mult (const BaseVector & b, BaseVector & x) const override;
+    ///
+    int VHeight() const override { return a->VWidth(); }
+    int VWidth() const override { return a->VHeight(); }
+    AutoVector CreateRowVector () const override { return a->CreateColVector(); }
+    AutoVector CreateColVector () const override { return a->CreateRowVector(); }
+  };
+
 }
 
 #endif
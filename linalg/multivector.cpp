@@ -0,0 +1,291 @@
+/*********************************************************************/
+/* File:   multivector.cpp                                           */
+/* Author: Start                                                     */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+/*
+   sets of vectors with contiguous storage
+*/
+
+#include <la.hpp>
+#include "../parallel/parallelvector.hpp"
+
+
+namespace ngla
+{
+
+  MultiVector :: MultiVector (size_t asize, int aes, size_t m)
+    : size(asize), entrysize(aes),
+      mem(make_shared<Matrix<double>> (m, asize*aes)), data(*mem), vecs(m)
+  {
+    *mem = 0.0;
+    for (size_t i = 0; i < m; i++)
+      vecs[i] = make_shared<S_BaseVectorPtr<double>> (size, entrysize, data.Data()+i*data.Width());
+  }
+
+  MultiVector :: MultiVector (const MultiVector & mv, IntRange r)
+    : size(mv.size), entrysize(mv.entrysize), mem(mv.mem), data(mv.data.Rows(r))
+  {
+    for (auto v : mv.vecs.Range(r))
+      vecs.Append (v);
+  }
+
+  MultiVector :: ~MultiVector () { ; }
+
+
+  shared_ptr<MultiVector> MultiVector :: Create (const BaseVector & v, size_t m)
+  {
+    if (v.IsComplex())
+      throw Exception ("MultiVector: only real vectors are supported");
+
+    auto pv = dynamic_cast_ParallelBaseVector (&v);
+    if (pv && pv->IsParallelVector())
+      return make_shared<ParallelMultiVector> (pv->GetParallelDofs(), m, pv->Status());
+
+    return make_shared<MultiVector> (v.Size(), v.EntrySize(), m);
+  }
+
+  shared_ptr<MultiVector> MultiVector :: Range (IntRange r) const
+  {
+    return shared_ptr<MultiVector> (new MultiVector (*this, r));
+  }
+
+  void MultiVector :: SetScalar (double scal)
+  {
+    for (auto & v : vecs)
+      *v = scal;
+  }
+
+
+  void MultiVector :: LocalInnerProducts (FlatMatrix<double> w, SliceMatrix<double> res) const
+  {
+    static Timer t("MultiVector::InnerProducts"); RegionTimer reg(t);
+    size_t n = data.Width();
+    if (w.Width() != n)
+      throw Exception ("MultiVector::InnerProducts: vector sizes don't match");
+    t.AddFlops (double(data.Height())*w.Height()*n);
+
+    res = 0.0;
+    if (data.Height() == 0 || w.Height() == 0) return;
+
+    // every task sums up a slice of the vectors, partial results are
+    // added afterwards. The slices are long enough for the
+    // row-times-row kernels to stream both blocks once
+    size_t nparts = (task_manager && n > 16384) ? TaskManager::GetNumThreads() : 1;
+    Array<Matrix<double>> partial(nparts);
+    ParallelFor (nparts, [&] (size_t i)
+                 {
+                   auto r = IntRange(0, n).Split (i, nparts);
+                   partial[i].SetSize (data.Height(), w.Height());
+                   partial[i] = 0.0;
+                   AddABt (data.Cols(r), w.Cols(r), partial[i]);
+                 });
+    for (auto & p : partial)
+      res += p;
+  }
+
+  void MultiVector :: LocalMultAdd (double s, SliceMatrix<double> c,
+                                    FlatMatrix<double> y, bool add) const
+  {
+    static Timer t("MultiVector::MultAdd"); RegionTimer reg(t);
+    size_t n = data.Width();
+    if (c.Height() != data.Height() || c.Width() != y.Height() || y.Width() != n)
+      throw Exception ("MultiVector::MultAdd: sizes don't match");
+    t.AddFlops (double(data.Height())*y.Height()*n);
+
+    if (y.Height() == 0) return;
+    if (data.Height() == 0)
+      {
+        if (!add) y = 0.0;
+        return;
+      }
+
+    Matrix<double> sct = s * Trans(c);
+    ParallelForRange (n, [&] (IntRange r)
+                      {
+                        if (add)
+                          AddAB (sct, data.Cols(r), y.Cols(r));
+                        else
+                          MultMatMat (sct, data.Cols(r), y.Cols(r));
+                      });
+  }
+
+
+  Matrix<double> MultiVector :: InnerProducts (const MultiVector & w) const
+  {
+    Matrix<double> res(Size(), w.Size());
+    LocalInnerProducts (w.FM(), res);
+    return res;
+  }
+
+  Vector<double> MultiVector :: InnerProducts (const BaseVector & w) const
+  {
+    Vector<double> res(Size());
+    FlatVector<double> fw = w.FVDouble();
+    LocalInnerProducts (FlatMatrix<double> (1, fw.Size(), fw.Data()),
+                        FlatMatrix<double> (Size(), 1, res.Data()));
+    return res;
+  }
+
+  void MultiVector :: MultAdd (double s, FlatVector<double> c, BaseVector & y) const
+  {
+    FlatVector<double> fy = y.FVDouble();
+    LocalMultAdd (s, FlatMatrix<double> (c.Size(), 1, c.Data()),
+                  FlatMatrix<double> (1, fy.Size(), fy.Data()), true);
+  }
+
+  void MultiVector :: MultAdd (double s, SliceMatrix<double> c, MultiVector & y) const
+  {
+    LocalMultAdd (s, c, y.FM(), true);
+  }
+
+  void MultiVector :: Mult (SliceMatrix<double> c, MultiVector & y) const
+  {
+    LocalMultAdd (1, c, y.FM(), false);
+  }
+
+
+
+
+  ParallelMultiVector :: ParallelMultiVector (shared_ptr<ParallelDofs> apd, size_t m,
+                                              PARALLEL_STATUS status)
+    : MultiVector (apd->GetNDofLocal(), apd->GetEntrySize(), m), paralleldofs(apd)
+  {
+    if (apd->GetEntrySize() != 1)
+      throw Exception ("ParallelMultiVector: only scalar dofs are supported");
+
+    for (size_t i = 0; i < m; i++)
+      vecs[i] = make_shared<ParallelVFlatVector<double>> (size, data.Data()+i*data.Width(),
+                                                          paralleldofs, status);
+    for (size_t i = 0; i < size; i++)
+      if (!paralleldofs->IsMasterDof(i))
+        nonmaster_dofs.Append (i);
+  }
+
+  ParallelMultiVector :: ParallelMultiVector (const ParallelMultiVector & mv, IntRange r)
+    : MultiVector (mv, r), paralleldofs(mv.paralleldofs), nonmaster_dofs(mv.nonmaster_dofs)
+  { ; }
+
+  shared_ptr<MultiVector> ParallelMultiVector :: Range (IntRange r) const
+  {
+    return shared_ptr<MultiVector> (new ParallelMultiVector (*this, r));
+  }
+
+  PARALLEL_STATUS ParallelMultiVector :: GetParallelStatus () const
+  {
+    if (Size() == 0) return CUMULATED;
+    auto status = vecs[0]->GetParallelStatus();
+    for (auto & v : vecs)
+      if (v->GetParallelStatus() != status)
+        {
+          Cumulate();
+          return CUMULATED;
+        }
+    return status;
+  }
+
+  void ParallelMultiVector :: Cumulate () const
+  {
+    for (auto & v : vecs)
+      v->Cumulate();
+  }
+
+  void ParallelMultiVector :: Distribute () const
+  {
+    for (auto & v : vecs)
+      v->Distribute();
+  }
+
+  static void AllReduceSum (FlatMatrix<double> m, const ParallelDofs & pardofs)
+  {
+#ifdef PARALLEL
+    if (pardofs.GetCommunicator().Size() > 1)
+      MPI_Allreduce (MPI_IN_PLACE, m.Data(), m.Height()*m.Width(),
+                     MPI_DOUBLE, MPI_SUM, pardofs.GetCommunicator());
+#endif
+  }
+
+  Matrix<double> ParallelMultiVector :: InnerProducts (const MultiVector & w) const
+  {
+    // as for single vectors: one of them must be distributed.
+    // If both are cumulated (e.g. V^T V), the dofs not owned by this
+    // rank are removed from the local sum
+    auto status1 = GetParallelStatus();
+    auto status2 = w.GetParallelStatus();
+    if (status1 == DISTRIBUTED && status2 == DISTRIBUTED)
+      {
+        Cumulate();
+        status1 = CUMULATED;
+        status2 = w.GetParallelStatus();
+      }
+
+    Matrix<double> res(Size(), w.Size());
+    FlatMatrix<double> fw = w.FM();
+    LocalInnerProducts (fw, res);
+    if (status1 == CUMULATED && status2 == CUMULATED)
+      for (int dof : nonmaster_dofs)
+        for (size_t i = 0; i < res.Height(); i++)
+          for (size_t j = 0; j < res.Width(); j++)
+            res(i,j) -= data(i,dof) * fw(j,dof);
+
+    AllReduceSum (res, *paralleldofs);
+    return res;
+  }
+
+  Vector<double> ParallelMultiVector :: InnerProducts (const BaseVector & w) const
+  {
+    auto status1 = GetParallelStatus();
+    auto status2 = w.GetParallelStatus();
+    if (status1 == DISTRIBUTED && status2 == DISTRIBUTED)
+      {
+        w.Cumulate();
+        status2 = CUMULATED;
+      }
+
+    Vector<double> res = MultiVector::InnerProducts (w);
+    if (status1 == CUMULATED && status2 == CUMULATED)
+      {
+        FlatVector<double> fw = w.FVDouble();
+        for (int dof : nonmaster_dofs)
+          for (size_t i = 0; i < res.Size(); i++)
+            res(i) -= data(i,dof) * fw(dof);
+      }
+
+    AllReduceSum (FlatMatrix<double> (res.Size(), 1, res.Data()), *paralleldofs);
+    return res;
+  }
+
+  void ParallelMultiVector :: MultAdd (double s, FlatVector<double> c, BaseVector & y) const
+  {
+    if (y.GetParallelStatus() != GetParallelStatus())
+      {
+        if (y.GetParallelStatus() == DISTRIBUTED)
+          y.Cumulate();
+        else
+          Cumulate();
+      }
+    MultiVector::MultAdd (s, c, y);
+  }
+
+  void ParallelMultiVector :: MultAdd (double s, SliceMatrix<double> c, MultiVector & y) const
+  {
+    if (y.GetParallelStatus() != GetParallelStatus())
+      {
+        if (y.GetParallelStatus() == DISTRIBUTED)
+          y.Cumulate();
+        else
+          Cumulate();
+      }
+    MultiVector::MultAdd (s, c, y);
+  }
+
+  void ParallelMultiVector :: Mult (SliceMatrix<double> c, MultiVector & y) const
+  {
+    auto status = GetParallelStatus();
+    MultiVector::Mult (c, y);
+    for (auto v : y.Vectors())
+      v->SetParallelStatus (status);
+  }
+
+}
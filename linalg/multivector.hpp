@@ -0,0 +1,119 @@
+#ifndef FILE_MULTIVECTOR
+#define FILE_MULTIVECTOR
+
+/*********************************************************************/
+/* File:   multivector.hpp                                           */
+/* Author: Start                                                     */
+/* Date:   Oct. 2026                                                 */
+/*********************************************************************/
+
+namespace ngla
+{
+
+  /**
+     A set of m real vectors of the same size.
+
+     The vectors are stored as the rows of one contiguous m x n
+     matrix, so every vector is a BaseVector by itself, and block
+     operations (V^T W, V c) are single dense matrix-matrix products
+     sweeping the vectors once.
+   */
+  class NGS_DLL_HEADER MultiVector
+  {
+  protected:
+    size_t size;
+    int entrysize;
+    /// storage, shared with sub-ranges
+    shared_ptr<Matrix<double>> mem;
+    /// the vectors, rows of mem
+    FlatMatrix<double> data;
+    Array<shared_ptr<BaseVector>> vecs;
+
+    MultiVector (const MultiVector & mv, IntRange r);
+  public:
+    MultiVector (size_t asize, int aes, size_t m);
+    virtual ~MultiVector ();
+
+    /// a multi-vector with m vectors of the same type as v
+    static shared_ptr<MultiVector> Create (const BaseVector & v, size_t m);
+
+    /// number of vectors
+    size_t Size () const { return vecs.Size(); }
+    /// length of every vector
+    size_t VectorSize () const { return size; }
+    int EntrySize () const { return entrysize; }
+
+    BaseVector & operator[] (size_t i) const { return *vecs[i]; }
+    FlatArray<shared_ptr<BaseVector>> Vectors () const { return vecs; }
+
+    /// vector i is row i
+    FlatMatrix<double> FM () const { return data; }
+
+    /// view to the vectors r, sharing the memory
+    virtual shared_ptr<MultiVector> Range (IntRange r) const;
+
+    void SetScalar (double scal);
+
+    /// result(i,j) = <this[i], w[j]>, i.e. V^T W
+    virtual Matrix<double> InnerProducts (const MultiVector & w) const;
+    /// result(i) = <this[i], w>
+    virtual Vector<double> InnerProducts (const BaseVector & w) const;
+
+    /// y += s V c, i.e. y += s sum_i c(i) this[i]
+    virtual void MultAdd (double s, FlatVector<double> c, BaseVector & y) const;
+    /// y[j] += s sum_i c(i,j) this[i]
+    virtual void MultAdd (double s, SliceMatrix<double> c, MultiVector & y) const;
+    /// y[j] = sum_i c(i,j) this[i]
+    virtual void Mult (SliceMatrix<double> c, MultiVector & y) const;
+
+    /// statuses of the (distributed) vectors are made equal
+    virtual PARALLEL_STATUS GetParallelStatus () const { return NOT_PARALLEL; }
+    virtual void Cumulate () const { ; }
+    virtual void Distribute () const { ; }
+
+  protected:
+    // local kernels, no communication
+
+    /// res = V W^T for the vectors stored as rows of w
+    void LocalInnerProducts (FlatMatrix<double> w, SliceMatrix<double> res) const;
+    /// y = s c^T V, or y += s c^T V
+    void LocalMultAdd (double s, SliceMatrix<double> c, FlatMatrix<double> y, bool add) const;
+  };
+
+
+
+  /**
+     Multi-vector with the vectors distributed over the
+     parallel dofs. All vectors of the multi-vector share one
+     parallel status.
+   */
+  class NGS_DLL_HEADER ParallelMultiVector : public MultiVector
+  {
+    shared_ptr<ParallelDofs> paralleldofs;
+    /// local dofs not owned by this rank
+    Array<int> nonmaster_dofs;
+
+    ParallelMultiVector (const ParallelMultiVector & mv, IntRange r);
+  public:
+    ParallelMultiVector (shared_ptr<ParallelDofs> apd, size_t m,
+                         PARALLEL_STATUS status = CUMULATED);
+
+    shared_ptr<ParallelDofs> GetParallelDofs () const { return paralleldofs; }
+
+    virtual shared_ptr<MultiVector> Range (IntRange r) const override;
+
+    virtual Matrix<double> InnerProducts (const MultiVector & w) const override;
+    virtual Vector<double> InnerProducts (const BaseVector & w) const override;
+
+    virtual void MultAdd (double s, FlatVector<double> c, BaseVector & y) const override;
+    virtual void MultAdd (double s, SliceMatrix<double> c, MultiVector & y) const override;
+    virtual void Mult (SliceMatrix<double> c, MultiVector & y) const override;
+
+    virtual PARALLEL_STATUS GetParallelStatus () const override;
+    virtual void Cumulate () const override;
+    virtual void Distribute () const override;
+  };
+
+}
+
+#endif
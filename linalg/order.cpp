@@ -796,4 +796,704 @@ namespace ngla
     list[nr].degree = 0;
   }
 
+  /* 
+
+  Nested dissection ordering
+
+  Multilevel graph bisection along the lines of
+
+  G. Karypis and V. Kumar: A fast and high quality multilevel scheme 
+  for partitioning irregular graphs,
+  SIAM J. Sci. Comput. Vol 20, 1998, pp 359-392
+
+  */
+
+  namespace nested_dissection
+  {
+    // graph with vertex and edge weights in compressed row storage
+    class WGraph
+    {
+    public:
+      Array<size_t> firsti;
+      Array<int> colnr;
+      Array<int> ewgt;
+      Array<int> vwgt;
+
+      int Size() const { return vwgt.Size(); }
+      FlatArray<int> Neighbours (int v) const { return colnr.Range(firsti[v], firsti[v+1]); }
+      FlatArray<int> EdgeWeights (int v) const { return ewgt.Range(firsti[v], firsti[v+1]); }
+      
+      size_t TotalWeight() const
+      {
+        size_t sum = 0;
+        for (int w : vwgt) sum += w;
+        return sum;
+      }
+    };
+
+    // coarse graphs below this size are bisected directly
+    constexpr int coarse_size = 100;
+
+    /*
+      heavy edge matching: matched vertex pairs form the
+      vertices of the coarse graph. Returns false if coarsening 
+      does not reduce the graph anymore.
+    */
+    bool Coarsen (const WGraph & g, WGraph & cg, Array<int> & cmap)
+    {
+      int nv = g.Size();
+      int maxvwgt = max<size_t> (1, 3*g.TotalWeight() / (2*coarse_size));
+
+      Array<int> match(nv);
+      match = -1;
+      for (int v = 0; v < nv; v++)
+        {
+          if (match[v] != -1) continue;
+          int best = -1, bestw = -1;
+          auto nbs = g.Neighbours(v);
+          auto ews = g.EdgeWeights(v);
+          for (int k : Range(nbs))
+            {
+              int u = nbs[k];
+              if (match[u] == -1 && u != v && ews[k] > bestw &&
+                  g.vwgt[v]+g.vwgt[u] <= maxvwgt)
+                {
+                  best = u;
+                  bestw = ews[k];
+                }
+            }
+          if (best == -1)
+            match[v] = v;
+          else
+            {
+              match[v] = best;
+              match[best] = v;
+            }
+        }
+
+      cmap.SetSize(nv);
+      int nc = 0;
+      for (int v = 0; v < nv; v++)
+        if (v <= match[v])
+          {
+            cmap[v] = nc;
+            cmap[match[v]] = nc;
+            nc++;
+          }
+
+      if (nc > 0.95 * nv) return false;
+
+      cg.vwgt.SetSize(nc);
+      cg.vwgt = 0;
+      for (int v = 0; v < nv; v++)
+        cg.vwgt[cmap[v]] += g.vwgt[v];
+
+      // stamp[cv] == current coarse row  =>  pos[cv] is position of edge
+      Array<int> stamp(nc), pos(nc);
+      stamp = -1;
+      cg.firsti.SetSize(nc+1);
+      cg.colnr.SetSize0();
+      cg.ewgt.SetSize0();
+
+      for (int v = 0; v < nv; v++)
+        {
+          if (v > match[v]) continue;
+          int cv = cmap[v];
+          cg.firsti[cv] = cg.colnr.Size();
+
+          for (int w : { v, match[v] })
+            {
+              auto nbs = g.Neighbours(w);
+              auto ews = g.EdgeWeights(w);
+              for (int k : Range(nbs))
+                {
+                  int cu = cmap[nbs[k]];
+                  if (cu == cv) continue;
+                  if (stamp[cu] == cv)
+                    cg.ewgt[pos[cu]] += ews[k];
+                  else
+                    {
+                      stamp[cu] = cv;
+                      pos[cu] = cg.colnr.Size();
+                      cg.colnr.Append (cu);
+                      cg.ewgt.Append (ews[k]);
+                    }
+                }
+              if (w == match[w]) break;   // unmatched vertex
+            }
+        }
+      cg.firsti[nc] = cg.colnr.Size();
+      return true;
+    }
+
+
+    // last vertex of breadth first search, repeated twice
+    int PseudoPeripheralVertex (const WGraph & g, int start)
+    {
+      int nv = g.Size();
+      Array<int> queue(nv);
+      Array<bool> visited(nv);
+      int last = start;
+      for (int rep = 0; rep < 2; rep++)
+        {
+          visited = false;
+          int qfirst = 0, qlast = 0;
+          queue[qlast++] = last;
+          visited[last] = true;
+          while (qfirst < qlast)
+            {
+              int v = queue[qfirst++];
+              last = v;
+              for (int u : g.Neighbours(v))
+                if (!visited[u])
+                  {
+                    visited[u] = true;
+                    queue[qlast++] = u;
+                  }
+            }
+        }
+      return last;
+    }
+
+
+    // breadth first growing of part 0, starting from vertex start
+    void GrowBisection (const WGraph & g, int start, FlatArray<int> part)
+    {
+      int nv = g.Size();
+      size_t total = g.TotalWeight(), w0 = 0;
+      part = 1;
+
+      Array<int> queue(nv);
+      Array<bool> inqueue(nv);
+      inqueue = false;
+      int qfirst = 0, qlast = 0, nextseed = 0;
+      queue[qlast++] = start;
+      inqueue[start] = true;
+
+      while (2*w0 < total)
+        {
+          if (qfirst == qlast)
+            { // disconnected graph, continue with a new component
+              while (nextseed < nv && inqueue[nextseed]) nextseed++;
+              if (nextseed == nv) break;
+              queue[qlast++] = nextseed;
+              inqueue[nextseed] = true;
+            }
+          
+          int v = queue[qfirst++];
+          part[v] = 0;
+          w0 += g.vwgt[v];
+          for (int u : g.Neighbours(v))
+            if (!inqueue[u])
+              {
+                inqueue[u] = true;
+                queue[qlast++] = u;
+              }
+        }
+    }
+
+    
+    size_t EdgeCut (const WGraph & g, FlatArray<int> part)
+    {
+      size_t cut = 0;
+      for (int v = 0; v < g.Size(); v++)
+        {
+          auto nbs = g.Neighbours(v);
+          auto ews = g.EdgeWeights(v);
+          for (int k : Range(nbs))
+            if (part[nbs[k]] != part[v])
+              cut += ews[k];
+        }
+      return cut/2;
+    }
+
+    
+    /*
+      greedy boundary refinement: move boundary vertices to the
+      other part if this reduces the edge cut and keeps the balance,
+      overweighted parts are unloaded first
+    */
+    void RefineBisection (const WGraph & g, FlatArray<int> part)
+    {
+      constexpr double imbalance = 0.05;
+      int nv = g.Size();
+      
+      size_t total = 0, maxvwgt = 0;
+      size_t pw[2] = { 0, 0 };
+      for (int v = 0; v < nv; v++)
+        {
+          pw[part[v]] += g.vwgt[v];
+          total += g.vwgt[v];
+          maxvwgt = max<size_t> (maxvwgt, g.vwgt[v]);
+        }
+      size_t maxw = max<size_t> ((1+imbalance) * total / 2, total/2 + maxvwgt);
+
+      for (int pass = 0; pass < 8; pass++)
+        {
+          int moves = 0;
+          for (int v = 0; v < nv; v++)
+            {
+              int p = part[v];
+              long ext = 0, in = 0;
+              auto nbs = g.Neighbours(v);
+              auto ews = g.EdgeWeights(v);
+              for (int k : Range(nbs))
+                if (part[nbs[k]] == p)
+                  in += ews[k];
+                else
+                  ext += ews[k];
+              if (ext == 0) continue;  // not on the boundary
+
+              size_t vw = g.vwgt[v];
+              long gain = ext - in;
+              bool fits = pw[1-p] + vw <= maxw;
+              bool balances = pw[p] > pw[1-p] + vw;
+              
+              bool move;
+              if (pw[p] > maxw)
+                move = fits;
+              else
+                move = (gain > 0 && fits) || (gain == 0 && balances);
+
+              if (move)
+                {
+                  part[v] = 1-p;
+                  pw[p] -= vw;
+                  pw[1-p] += vw;
+                  moves++;
+                }
+            }
+          if (moves == 0) break;
+        }
+    }
+
+
+    // best of some graph growing bisections
+    void InitialBisection (const WGraph & g, FlatArray<int> part)
+    {
+      int nv = g.Size();
+      Array<int> hpart(nv);
+      size_t bestcut = numeric_limits<size_t>::max();
+      int ntrials = min(nv, 4);
+      
+      for (int trial = 0; trial < ntrials; trial++)
+        {
+          int start = (trial == 0) ? PseudoPeripheralVertex (g, 0) : (size_t(trial) * nv) / ntrials;
+          GrowBisection (g, start, hpart);
+          RefineBisection (g, hpart);
+          size_t cut = EdgeCut (g, hpart);
+          if (cut < bestcut)
+            {
+              bestcut = cut;
+              for (int v = 0; v < nv; v++)
+                part[v] = hpart[v];
+            }
+        }
+    }
+
+
+    /*
+      The cut edges form a bipartite graph between the boundaries of
+      part 0 and part 1. A minimal vertex cover is obtained from a
+      maximal matching (Koenig's theorem). Separator vertices get part = 2.
+    */
+    void EdgeToVertexSeparator (const WGraph & g, FlatArray<int> part)
+    {
+      int nv = g.Size();
+      auto is_left = [&] (int v)
+        {
+          if (part[v] != 0) return false;
+          for (int u : g.Neighbours(v))
+            if (part[u] == 1) return true;
+          return false;
+        };
+
+      Array<int> left;
+      for (int v = 0; v < nv; v++)
+        if (is_left(v))
+          left.Append(v);
+
+      Array<int> mate(nv);
+      mate = -1;
+
+      // greedy initial matching
+      for (int v : left)
+        for (int u : g.Neighbours(v))
+          if (part[u] == 1 && mate[u] == -1)
+            {
+              mate[u] = v;
+              mate[v] = u;
+              break;
+            }
+
+      // augmenting paths by depth first search
+      struct Frame { int v; size_t k; int right; };
+      Array<Frame> stack;
+      Array<int> visited(nv);
+      visited = -1;
+
+      for (int phase = 0; true; phase++)
+        {
+          bool augmented = false;
+          for (int root : left)
+            {
+              if (mate[root] != -1) continue;
+              if (visited[root] == phase) continue;
+              visited[root] = phase;
+              
+              stack.SetSize0();
+              stack.Append (Frame { root, g.firsti[root], -1 });
+              while (stack.Size())
+                {
+                  Frame & top = stack.Last();
+                  if (top.k == g.firsti[top.v+1])
+                    {
+                      stack.SetSize(stack.Size()-1);
+                      continue;
+                    }
+                  int u = g.colnr[top.k++];
+                  if (part[u] != 1) continue;
+                  
+                  if (mate[u] == -1)
+                    {  // flip matching along the path
+                      int r = u;
+                      for (int i = stack.Size()-1; i >= 0; i--)
+                        {
+                          int l = stack[i].v;
+                          int nextr = stack[i].right;
+                          mate[l] = r;
+                          mate[r] = l;
+                          r = nextr;
+                        }
+                      augmented = true;
+                      break;
+                    }
+
+                  int w = mate[u];
+                  if (visited[w] != phase)
+                    {
+                      visited[w] = phase;
+                      stack.Append (Frame { w, g.firsti[w], u });
+                    }
+                }
+            }
+          if (!augmented) break;
+        }
+
+      // alternating search from free left vertices
+      Array<bool> reached(nv);
+      reached = false;
+      Array<int> queue;
+      for (int v : left)
+        if (mate[v] == -1)
+          {
+            reached[v] = true;
+            queue.Append(v);
+          }
+      for (size_t qi = 0; qi < queue.Size(); qi++)
+        {
+          int v = queue[qi];   // left vertex
+          for (int u : g.Neighbours(v))
+            if (part[u] == 1 && !reached[u])
+              {
+                reached[u] = true;
+                int w = mate[u];
+                if (w != -1 && !reached[w])
+                  {
+                    reached[w] = true;
+                    queue.Append(w);
+                  }
+              }
+        }
+      
+      // cover = (left \ reached) + (right & reached)
+      for (int v : left)
+        {
+          if (!reached[v])
+            part[v] = 2;
+          else
+            for (int u : g.Neighbours(v))
+              if (part[u] == 1 && reached[u])
+                part[u] = 2;
+        }
+    }
+    
+
+    // multilevel bisection, returns part 0, 1, or 2 (= separator)
+    void Bisect (const WGraph & g, FlatArray<int> part)
+    {
+      Array<shared_ptr<WGraph>> levels;
+      Array<Array<int>> cmaps;
+
+      const WGraph * cur = &g;
+      while (cur->Size() > coarse_size)
+        {
+          auto cg = make_shared<WGraph>();
+          Array<int> cmap;
+          if (!Coarsen (*cur, *cg, cmap)) break;
+          levels.Append (cg);
+          cmaps.Append (move(cmap));
+          cur = cg.get();
+        }
+
+      Array<int> cpart(cur->Size());
+      InitialBisection (*cur, cpart);
+
+      for (int l = levels.Size()-1; l >= 0; l--)
+        {
+          const WGraph & fine = (l == 0) ? g : *levels[l-1];
+          Array<int> fpart(fine.Size());
+          for (int v = 0; v < fine.Size(); v++)
+            fpart[v] = cpart[cmaps[l][v]];
+          RefineBisection (fine, fpart);
+          cpart = move(fpart);
+        }
+
+      for (int v = 0; v < g.Size(); v++)
+        part[v] = cpart[v];
+      EdgeToVertexSeparator (g, part);
+    }
+  }
+
+
+
+  
+  NestedDissectionOrdering :: NestedDissectionOrdering (Table<int> && agraph)
+    : n(agraph.Size()), order(agraph.Size()), blocknr(agraph.Size()),
+      vertices(agraph.Size()), graph(move(agraph))
+  {
+    ParallelForRange (n, [&] (IntRange r)
+                      {
+                        blocknr.Range(r) = 0;
+                        order.Range(r) = -1;
+                        for (auto i : r)
+                          {
+                            vertices[i].Init(i);
+                            vertices[i].nconnected = 0;
+                          }
+                      });
+  }
+
+  
+  void NestedDissectionOrdering :: Order()
+  {
+    static Timer t("NestedDissectionOrdering::Order");
+    static Timer tdis("NestedDissectionOrdering::Order - dissection");
+    RegionTimer reg(t);
+    tdis.Start();
+
+    using namespace nested_dissection;
+    
+    Array<int> used;
+    for (int i = 0; i < n; i++)
+      if (!vertices[i].Eliminated())
+        used.Append(i);
+    nused = used.Size();
+
+    // sub-graphs of the current level, and their first position in order
+    Array<Array<int>> subgraphs;
+    Array<int> firsts;
+    subgraphs.Append (move(used));
+    firsts.Append (0);
+
+    // subgraph-ids are unique over all levels
+    Array<int> graphnr(n), localnr(n);
+    graphnr = -1;
+    int idoffset = 0;
+
+    while (subgraphs.Size())
+      {
+        for (int i : Range(subgraphs))
+          for (int v : subgraphs[i])
+            graphnr[v] = idoffset+i;
+
+        Array<Array<int>> parts0(subgraphs.Size()), parts1(subgraphs.Size());
+
+        ParallelFor (subgraphs.Size(), [&] (int i)
+          {
+            FlatArray<int> verts = subgraphs[i];
+            int id = idoffset+i;
+            int first = firsts[i];
+            int nv = verts.Size();
+            
+            // small sets are not split further, whatever the leafsize
+            if (nv <= max2(leafsize, 4))
+              {
+                order.Range(first, first+nv) = verts;
+                return;
+              }
+
+            for (int k : Range(verts))
+              localnr[verts[k]] = k;
+
+            WGraph g;
+            g.vwgt.SetSize(nv);
+            g.vwgt = 1;
+            g.firsti.SetSize(nv+1);
+            for (int k : Range(verts))
+              {
+                g.firsti[k] = g.colnr.Size();
+                for (int w : graph[verts[k]])
+                  if (graphnr[w] == id)
+                    g.colnr.Append (localnr[w]);
+              }
+            g.firsti[nv] = g.colnr.Size();
+            g.ewgt.SetSize(g.colnr.Size());
+            g.ewgt = 1;
+
+            Array<int> part(nv);
+            Bisect (g, part);
+
+            Array<int> sep;
+            for (int k : Range(verts))
+              switch (part[k])
+                {
+                case 0: parts0[i].Append (verts[k]); break;
+                case 1: parts1[i].Append (verts[k]); break;
+                default: sep.Append (verts[k]);
+                }
+
+            if (parts0[i].Size() == 0 || parts1[i].Size() == 0 || sep.Size() == 0)
+              { // no proper split, keep as leaf
+                order.Range(first, first+nv) = verts;
+                parts0[i].SetSize0();
+                parts1[i].SetSize0();
+                return;
+              }
+            
+            // separator is eliminated after the two parts
+            int firstsep = first + nv - sep.Size();
+            order.Range(firstsep, first+nv) = sep;
+          });
+
+        idoffset += subgraphs.Size();
+        
+        Array<Array<int>> nextsubgraphs;
+        Array<int> nextfirsts;
+        for (int i : Range(subgraphs))
+          {
+            int n0 = parts0[i].Size();
+            if (n0)
+              {
+                nextsubgraphs.Append (move(parts0[i]));
+                nextfirsts.Append (firsts[i]);
+              }
+            if (parts1[i].Size())
+              {
+                nextsubgraphs.Append (move(parts1[i]));
+                nextfirsts.Append (firsts[i]+n0);
+              }
+          }
+        subgraphs = move(nextsubgraphs);
+        firsts = move(nextfirsts);
+      }
+    tdis.Stop();
+
+    SymbolicFactorization();
+  }
+
+
+
+  /*
+    Column structures of L are the union of the matrix graph and the 
+    structures of the children in the elimination tree. Column j
+    is joined to the supernode of column j-1 if j-1 is its only child,
+    and the structures coincide. Structures are stored unsorted,
+    Allocate sorts the rows anyway.
+  */
+  void NestedDissectionOrdering :: SymbolicFactorization ()
+  {
+    static Timer t("NestedDissectionOrdering::SymbolicFactorization");
+    RegionTimer reg(t);
+
+    Array<int> inv(n);
+    inv = -1;
+    for (int i = 0; i < nused; i++)
+      inv[order[i]] = i;
+
+    // children in elimination tree as linked lists
+    Array<int> firstchild(nused), nextchild(nused);
+    firstchild = -1;
+
+    // structure of supernode masters (new numbering)
+    Array<size_t> firststruct(nused), sizestruct(nused);
+    Array<int> structdata;
+
+    Array<int> marker(nused);
+    marker = -1;
+    Array<int> col;
+
+    for (int j = 0; j < nused; j++)
+      {
+        col.SetSize0();
+        marker[j] = j;
+
+        for (int w : graph[order[j]])
+          {
+            int jj = inv[w];
+            if (jj > j && marker[jj] != j)
+              {
+                marker[jj] = j;
+                col.Append (jj);
+              }
+          }
+
+        // structure of child c are the entries > c of its master
+        int nchilds = 0;
+        for (int c = firstchild[j]; c != -1; c = nextchild[c])
+          {
+            nchilds++;
+            int m = blocknr[c];
+            FlatArray<int> mstruct = structdata.Range(firststruct[m], firststruct[m]+sizestruct[m]);
+            for (int jj : mstruct)
+              if (jj > c && marker[jj] != j)
+                {
+                  marker[jj] = j;
+                  col.Append (jj);
+                }
+          }
+
+        bool slave = false;
+        if (j > 0 && nchilds == 1 && firstchild[j] == j-1)
+          {
+            int m = blocknr[j-1];
+            slave = (col.Size()+1 == sizestruct[m] - (j-1-m));
+          }
+
+        if (slave)
+          blocknr[j] = blocknr[j-1];
+        else
+          {
+            blocknr[j] = j;
+            firststruct[j] = structdata.Size();
+            sizestruct[j] = col.Size();
+            for (int jj : col)
+              structdata.Append (jj);
+          }
+
+        if (col.Size())
+          {
+            int parent = col[0];
+            for (int jj : col)
+              parent = min(parent, jj);
+            nextchild[j] = firstchild[parent];
+            firstchild[parent] = j;
+          }
+      }
+
+    // connected vertices of masters in original numbering
+    connected.SetSize (structdata.Size());
+    for (size_t i = 0; i < structdata.Size(); i++)
+      connected[i] = order[structdata[i]];
+
+    for (int j = 0; j < nused; j++)
+      if (blocknr[j] == j)
+        {
+          auto & vert = vertices[order[j]];
+          vert.nconnected = sizestruct[j];
+          vert.connected = connected.Addr(firststruct[j]);
+        }
+  }
+
+
 }
@@ -199,6 +199,60 @@ namespace ngla
   };
 
 
+
+  /// fill-reducing orderings for the sparse cholesky factorization
+  enum ORDERINGTYPE { MINIMUM_DEGREE_ORDERING, NESTED_DISSECTION_ORDERING };
+
+
+  /*
+    Nested dissection ordering.
+
+    The graph is recursively split by vertex separators, which are
+    numbered last. Separators are computed by a multilevel edge
+    bisection (heavy edge matching, graph growing, boundary refinement)
+    followed by a minimal vertex cover of the cut edges.
+
+    The symbolic factorization provides the supernodes in the same
+    format as the MinimumDegreeOrdering (order, blocknr, and the
+    connected dofs of the master vertices).
+  */
+  class NestedDissectionOrdering
+  {
+  public:
+    ///
+    int n, nused;
+    /// order[i] is the original dof eliminated in step i
+    Array<int> order;
+    /// first dof of the supernode (new numbering)
+    Array<int> blocknr;
+    /// connected are the non-zeros of the L-column of supernode masters
+    Array<MDOVertex> vertices;
+
+  protected:
+    /// symmetric graph, without diagonal
+    Table<int> graph;
+    /// memory for vertices[i].connected
+    Array<int> connected;
+    /// sub-graphs below this size are not dissected any further
+    int leafsize = 64;
+
+  public:
+    ///
+    NestedDissectionOrdering (Table<int> && agraph);
+    ///
+    void SetUnusedVertex (int v) { vertices[v].SetEliminated(true); }
+    ///
+    void SetLeafSize (int aleafsize) { leafsize = aleafsize; }
+    ///
+    void Order();
+    ///
+    int Size () const { return n; }
+
+  protected:
+    /// elimination tree, supernodes, and structure of L
+    void SymbolicFactorization ();
+  };
+
 }
 
 
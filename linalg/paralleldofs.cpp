@@ -128,6 +128,38 @@ namespace ngla
     return make_shared<ParallelDofs>(this->GetCommunicator(), move(tab));
   }
 
+  const RowPartition & ParallelDofs :: GetRowPartition (const MatrixGraph & graph) const
+  {
+    for (auto & part : row_partitions)
+      if (part->timestamp == graph.GetTimeStamp())
+        return *part;
+
+    static Timer t("ParallelDofs::GetRowPartition"); RegionTimer reg(t);
+    auto part = make_shared<RowPartition>();
+    part->timestamp = graph.GetTimeStamp();
+
+    Array<bool> isinterface(graph.Size());
+    ParallelFor (graph.Size(), [&] (size_t row)
+                 {
+                   bool interface = false;
+                   for (auto col : graph.GetRowIndices(row))
+                     if (dist_procs[col].Size())
+                       interface = true;
+                   isinterface[row] = interface;
+                 });
+    for (size_t row : Range(graph.Size()))
+      if (isinterface[row])
+        part->interface.Append(row);
+      else
+        part->interior.Append(row);
+
+    // a few graphs only (system matrix, mass matrix, ...)
+    if (row_partitions.Size() >= 4)
+      row_partitions.RemoveElement(0);
+    row_partitions.Append (part);
+    return *part;
+  }
+
   void ParallelDofs :: EnumerateGlobally (shared_ptr<BitArray> freedofs, 
 					  Array<int> & global_nums,
 					  int & num_glob_dofs) const
@@ -11,9 +11,21 @@
 
 namespace ngla
 {
+  class MatrixGraph;
 
 #ifdef PARALLEL
 
+  /**
+     Splits the rows of a local matrix into rows coupling only to
+     interior dofs and rows coupling to interface dofs.
+   */
+  struct RowPartition
+  {
+    size_t timestamp;
+    Array<int> interior;
+    Array<int> interface;
+  };
+
   /**
      Handles the distribution of degrees of freedom for vectors and matrices
    */
@@ -47,6 +59,9 @@ namespace ngla
     /// entry-size
     int es;
     bool complex;
+
+    /// row partitions of the most recently used matrix graphs
+    mutable Array<shared_ptr<RowPartition>> row_partitions;
     
   public:
     /**
@@ -98,6 +113,9 @@ namespace ngla
 
     void EnumerateGlobally (shared_ptr<BitArray> freedofs, Array<int> & globnum, int & num_glob_dofs) const;
 
+    /// row partition of a graph with columns numbered by these dofs, cached by the graph timestamp
+    const RowPartition & GetRowPartition (const MatrixGraph & graph) const;
+
 
     template <typename T>
     void ReduceDofData (FlatArray<T> data, MPI_Op op) const;
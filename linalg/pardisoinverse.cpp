@@ -546,6 +546,30 @@ namespace ngla
   }
 
 
+  template<class TM, class TV_ROW, class TV_COL>
+  void PardisoInverse<TM,TV_ROW,TV_COL> ::
+  MultMulti (FlatArray<shared_ptr<BaseVector>> x,
+             FlatArray<shared_ptr<BaseVector>> y) const
+  {
+    if (x.Size() != y.Size())
+      throw Exception ("PardisoInverse::MultMulti: number of vectors don't match");
+
+    if constexpr (is_same<TM,TVX>::value)
+      {
+        // Mult solves for all right-hand sides stored one after the other
+        size_t n = height/entrysize;
+        VVector<TVX> hx(x.Size()*n), hy(x.Size()*n);
+        for (size_t i = 0; i < x.Size(); i++)
+          hx.FV().Range(i*n, (i+1)*n) = x[i]->FV<TVX>();
+        Mult (hx, hy);
+        for (size_t i = 0; i < y.Size(); i++)
+          y[i]->FV<TVX>() = hy.FV().Range(i*n, (i+1)*n);
+      }
+    else
+      SparseFactorization::MultMulti (x, y);
+  }
+
+
 
 
   template<>
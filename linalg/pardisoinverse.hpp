@@ -177,6 +177,9 @@ namespace ngla
     ///
     void Mult (const BaseVector & x, BaseVector & y) const override;
     void MultTrans (const BaseVector & x, BaseVector & y) const override;
+    /// one pardiso call with nrhs = x.Size()
+    void MultMulti (FlatArray<shared_ptr<BaseVector>> x,
+                    FlatArray<shared_ptr<BaseVector>> y) const override;
     ///
 
     AutoVector CreateRowVector() const override
@@ -148,6 +148,23 @@ void ExportSparseMatrix(py::module m)
     .def("CreateTranspose", [] (const SparseMatrix<double> & sp)
          { return TransposeMatrix (sp); }, "Return transposed matrix")
 
+    .def("Restrict", [] (const SparseMatrix<T> & self, const SparseMatrix<double> & prol,
+                         shared_ptr<SparseMatrix<T>> cmat)
+         { return dynamic_pointer_cast<SparseMatrix<T>> (self.Restrict (prol, cmat)); },
+         py::arg("prol"), py::arg("cmat")=nullptr, docu_string(R"raw_string(
+Galerkin projection P^T A P.
+
+Parameters:
+
+prol : ngsolve.la.SparseMatrixd
+  prolongation matrix P
+
+cmat : ngsolve.la.SparseMatrix
+  coarse matrix from a previous call with the same sparsity patterns,
+  only the values are recomputed
+
+)raw_string"))
+
     .def("__matmul__", [] (const SparseMatrix<double> & a, const SparseMatrix<double> & b)
          { return MatMult(a,b); }, py::arg("mat"))
     .def("__matmul__", [](shared_ptr<SparseMatrix<double>> a, shared_ptr<BaseMatrix> mb)
@@ -460,6 +477,26 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
                                           }, py::arg("other"), py::arg("conjugate")=py::cast(true), "Computes (complex) InnerProduct"         
          )
     .def("Norm",  [](BaseVector & self) { return self.L2Norm(); }, "Calculate Norm")
+    .def("SetRandom", [](BaseVector & self) { self.SetRandom(); }, "Set vector to random values in [0,1]")
+    .def("AddAddInnerProduct", [](BaseVector & self, double a, BaseVector & x,
+                                  BaseVector & y, double b, BaseVector & z, shared_ptr<BaseVector> w)
+         {
+           return self.AddAddInnerProduct (a, x, y, b, z, w.get());
+         }, py::arg("a"), py::arg("x"), py::arg("y"), py::arg("b"), py::arg("z"), py::arg("w")=nullptr,
+         "self += a*x, y += b*z in one sweep, returns InnerProduct(y,w), or 0 if w is None")
+    .def("AddL2Norm", [](BaseVector & self, double a, BaseVector & x)
+         {
+           return self.AddL2Norm (a, x);
+         }, py::arg("a"), py::arg("x"), "self += a*x in one sweep, returns Norm of the result")
+    .def("MultiAdd", [](BaseVector & self, double s, std::vector<double> c,
+                        std::vector<shared_ptr<BaseVector>> v)
+         {
+           Array<const BaseVector*> pv(v.size());
+           for (size_t i = 0; i < v.size(); i++)
+             pv[i] = v[i].get();
+           self.MultiAdd (s, FlatArray<double>(c.size(), c.data()), pv);
+         }, py::arg("s"), py::arg("coefs"), py::arg("vecs"),
+         "self = s*self + sum_i coefs[i]*vecs[i] in one sweep")
     .def("Range", [](BaseVector & self, int from, int to) -> shared_ptr<BaseVector>
                                    {
                                      return shared_ptr<BaseVector>(self.Range(from,to));
@@ -503,6 +540,77 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
     ;
 
 
+  py::class_<MultiVector, shared_ptr<MultiVector>> (m, "MultiVector",
+                                                    "A set of real vectors stored contiguously.\n"
+                                                    "Block inner products V^T W and linear combinations V c\n"
+                                                    "are computed with one sweep over all vectors")
+    .def(py::init ([] (BaseVector & v, size_t num)
+                   {
+                     return MultiVector::Create (v, num);
+                   }), py::arg("vector"), py::arg("num"),
+         "creates num vectors of the same type as vector, initialized with 0")
+    .def("__len__", [] (MultiVector & self) { return self.Size(); })
+    .def("__getitem__", [] (MultiVector & self, int ind)
+         {
+           if (ind < 0) ind += self.Size();
+           if (ind < 0 || ind >= self.Size())
+             throw py::index_error();
+           return self.Vectors()[ind];
+         }, py::arg("ind"), py::keep_alive<0,1>(), "vector number ind, it shares memory with the MultiVector")
+    .def("__getitem__", [] (MultiVector & self, py::slice inds)
+         {
+           size_t start, step, n;
+           InitSlice (inds, self.Size(), start, step, n);
+           if (step != 1)
+             throw Exception ("slices with non-unit distance not allowed");
+           return self.Range (IntRange(start, start+n));
+         }, py::arg("inds"), "the vectors inds, sharing memory with the MultiVector")
+    .def("__setitem__", [] (MultiVector & self, int ind, BaseVector & v)
+         {
+           if (ind < 0) ind += self.Size();
+           if (ind < 0 || ind >= self.Size())
+             throw py::index_error();
+           self[ind].Set (1.0, v);
+         }, py::arg("ind"), py::arg("vec"))
+    .def("__setitem__", [] (MultiVector & self, py::slice inds, double d)
+         {
+           size_t start, step, n;
+           InitSlice (inds, self.Size(), start, step, n);
+           if (step != 1)
+             throw Exception ("slices with non-unit distance not allowed");
+           self.Range (IntRange(start, start+n)) -> SetScalar(d);
+         }, py::arg("inds"), py::arg("value"))
+    .def("InnerProduct", [] (MultiVector & self, MultiVector & other)
+         {
+           return self.InnerProducts (other);
+         }, py::call_guard<py::gil_scoped_release>(), py::arg("other"),
+         "matrix of all inner products (self[i], other[j])")
+    .def("InnerProduct", [] (MultiVector & self, BaseVector & other)
+         {
+           return self.InnerProducts (other);
+         }, py::call_guard<py::gil_scoped_release>(), py::arg("other"),
+         "vector of inner products (self[i], other)")
+    .def("Mult", [] (MultiVector & self, FlatMatrix<double> c, MultiVector & y)
+         {
+           self.Mult (c, y);
+         }, py::call_guard<py::gil_scoped_release>(), py::arg("c"), py::arg("y"),
+         "y[j] = sum_i c[i,j] self[i]")
+    .def("MultAdd", [] (MultiVector & self, double s, FlatMatrix<double> c, MultiVector & y)
+         {
+           self.MultAdd (s, c, y);
+         }, py::call_guard<py::gil_scoped_release>(), py::arg("value"), py::arg("c"), py::arg("y"),
+         "y[j] += value * sum_i c[i,j] self[i]")
+    .def("MultAdd", [] (MultiVector & self, double s, FlatVector<double> c, BaseVector & y)
+         {
+           self.MultAdd (s, c, y);
+         }, py::call_guard<py::gil_scoped_release>(), py::arg("value"), py::arg("c"), py::arg("y"),
+         "y += value * sum_i c[i] self[i]")
+    .def("Cumulate", [] (MultiVector & self) { self.Cumulate(); })
+    .def("Distribute", [] (MultiVector & self) { self.Distribute(); })
+    .def("GetParallelStatus", [] (MultiVector & self) { return self.GetParallelStatus(); })
+    ;
+
+
 
 
   
@@ -697,6 +805,9 @@ void NGS_DLL_HEADER ExportNgla(py::module &m) {
                                       }, "Interprets the matrix values as a vector")
 
     .def("Mult",         [](BaseMatrix &m, BaseVector &x, BaseVector &y) { m.Mult(x, y); }, py::call_guard<py::gil_scoped_release>(), py::arg("x"), py::arg("y"))
+    .def("Mult",         [](BaseMatrix &m, MultiVector &x, MultiVector &y) { m.Mult(x, y); }, py::call_guard<py::gil_scoped_release>(), py::arg("x"), py::arg("y"),
+         "y[i] = mat * x[i] for all vectors of the MultiVectors")
+    .def("MultAdd",      [](BaseMatrix &m, double s, MultiVector &x, MultiVector &y) { m.MultAdd (s, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
     .def("MultAdd",      [](BaseMatrix &m, double s, BaseVector &x, BaseVector &y) { m.MultAdd (s, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
     .def("MultTrans",    [](BaseMatrix &m, double s, BaseVector &x, BaseVector &y) { y=0; m.MultTransAdd (1.0, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
     .def("MultTransAdd",  [](BaseMatrix &m, double s, BaseVector &x, BaseVector &y) { m.MultTransAdd (s, x, y); }, py::arg("value"), py::arg("x"), py::arg("y"), py::call_guard<py::gil_scoped_release>())
@@ -740,6 +851,11 @@ freedofs : BitArray
 inverse : string
   Solver to use, allowed values are:
     sparsecholesky - internal solver of NGSolve for symmetric matrices
+    sparsecholesky_nd - internal solver with nested dissection ordering, for large 3D problems
+    sparsecholesky_supernodal - as sparsecholesky_nd, but with left-looking supernodal factorization
+                     using dense (BLAS-3) panel updates
+    sparsecholesky_single - as sparsecholesky_supernodal, but stores the factor in single precision,
+                     the solution is corrected by iterative refinement in double precision
     umfpack        - solver by Suitesparse/UMFPACK (if NGSolve was configured with USE_UMFPACK=ON)
     pardiso        - PARDISO, either provided by libpardiso (USE_PARDISO=ON) or Intel MKL (USE_MKL=ON).
                      If neither Pardiso nor Intel MKL was linked at compile-time, NGSolve will look
@@ -918,6 +1034,14 @@ inverse : string
     .def_property_readonly("col_pardofs", [](ParallelMatrix & mat) { return mat.GetColParallelDofs(); })
     .def_property_readonly("local_mat", [](ParallelMatrix & mat) { return mat.GetMatrix(); })
     .def_property_readonly("op_type", [](ParallelMatrix & mat) { return mat.GetOpType(); })
+    .def_property("split_phase",
+                  [](ParallelMatrix & mat) { return mat.GetSplitPhase(); },
+                  [](ParallelMatrix & mat, bool split) { mat.SetSplitPhase(split); },
+                  "overlap the exchange of interface values with the interior rows in MultAdd")
+    .def_property("agglomeration",
+                  [](ParallelMatrix & mat) { return mat.GetAgglomeration(); },
+                  [](ParallelMatrix & mat, int groupsize) { mat.SetAgglomeration(groupsize); },
+                  "ranks per group for Inverse, every group leader factors the whole matrix (0 .. gather on rank 0)")
     ;
 
 
@@ -980,6 +1104,22 @@ inverse : string
                   }))
     ;
 
+  py::class_<SparseMatrixSELL<double>, shared_ptr<SparseMatrixSELL<double>>, BaseMatrix>
+    (m, "SparseMatrixSELL",
+     "sparse matrix in SELL-C-sigma format for SIMD matrix-vector products")
+    .def(py::init([] (const BaseMatrix & mat, size_t sigma) -> shared_ptr<SparseMatrixSELL<double>>
+                  {
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<double>*> (&mat); ptr)
+                      return make_shared<SparseMatrixSELL<double>> (*ptr, sigma);
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<Mat<2,2>>*> (&mat); ptr)
+                      return make_shared<SparseMatrixSELL<double>> (*ptr, sigma);
+                    if (auto ptr = dynamic_cast<const SparseMatrixTM<Mat<3,3>>*> (&mat); ptr)
+                      return make_shared<SparseMatrixSELL<double>> (*ptr, sigma);
+                    throw Exception("cannot create SparseMatrixSELL");
+                  }), py::arg("mat"), py::arg("sigma")=256,
+         "converts a real sparse matrix, sorting rows by length within windows of sigma rows")
+    ;
+
   
   py::class_<BaseBlockJacobiPrecond, shared_ptr<BaseBlockJacobiPrecond>, BaseMatrix>
     (m, "BlockSmoother",
@@ -1011,6 +1151,21 @@ inverse : string
            self.Smooth (u, y /* this is not needed */, y);
          }, py::call_guard<py::gil_scoped_release>(),
          "perform smoothing step (needs non-symmetric storage so symmetric sparse matrix)")
+    .def("MultMulti", [] (SparseFactorization & self, py::list x, py::list y)
+         {
+           if (py::len(x) != py::len(y))
+             throw Exception ("MultMulti: x and y must have the same length");
+           Array<shared_ptr<BaseVector>> cx(py::len(x)), cy(py::len(y));
+           for (size_t i = 0; i < cx.Size(); i++)
+             {
+               cx[i] = x[i].cast<shared_ptr<BaseVector>>();
+               cy[i] = y[i].cast<shared_ptr<BaseVector>>();
+             }
+           py::gil_scoped_release release;
+           self.MultMulti (cx, cy);
+         }, py::arg("x"), py::arg("y"),
+         "solve for a list of right-hand sides x, results are stored in the list y.\n"
+         "The factorization is traversed only once for all vectors")
     ;
 
   py::class_<SparseCholesky<double>, shared_ptr<SparseCholesky<double>>, SparseFactorization> (m, "SparseCholesky_d");
@@ -1142,6 +1297,196 @@ maxsteps : int
 )raw_string"))
     ;
 
+  m.def("PipelinedCGSolver", [](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                                bool iscomplex, bool printrates,
+                                double precision, int maxsteps)
+        {
+          shared_ptr<KrylovSpaceSolver> solver;
+          if(mat->IsComplex()) iscomplex = true;
+
+          if (iscomplex)
+            solver = make_shared<PipelinedCGSolver<Complex>> (mat, pre);
+          else
+            solver = make_shared<PipelinedCGSolver<double>> (mat, pre);
+          solver->SetPrecision(precision);
+          solver->SetMaxSteps(maxsteps);
+          solver->SetPrintRates (printrates);
+          return solver;
+        },
+        py::arg("mat"), py::arg("pre"), py::arg("complex") = false, py::arg("printrates")=true,
+        py::arg("precision")=1e-8, py::arg("maxsteps")=200, docu_string(R"raw_string(
+A pipelined CG Solver. The global reduction of the inner products
+overlaps with the application of the preconditioner and the matrix,
+which hides the latency of the reduction in parallel runs.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input matrix 
+
+pre : ngsolve.la.BaseMatrix
+  input preconditioner matrix
+
+complex : bool
+  input complex, if not set it is deduced from matrix type
+
+printrates : bool
+  input printrates
+
+precision : float
+  input requested precision. PipelinedCGSolver stops if precision is reached.
+
+maxsteps : int
+  input maximal steps. PipelinedCGSolver stops after this steps.
+
+)raw_string"))
+    ;
+
+  m.def("SStepGMRESSolver", [](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                               bool printrates, double precision, int maxsteps, int sstep)
+        {
+          if (mat->IsComplex())
+            throw Exception ("SStepGMRESSolver: only real matrices are supported");
+          auto solver = make_shared<SStepGMRESSolver> (mat, pre);
+          solver->SetPrecision(precision);
+          solver->SetMaxSteps(maxsteps);
+          solver->SetPrintRates (printrates);
+          solver->SetSStep (sstep);
+          return shared_ptr<KrylovSpaceSolver>(solver);
+        },
+        py::arg("mat"), py::arg("pre"), py::arg("printrates")=true,
+        py::arg("precision")=1e-8, py::arg("maxsteps")=200, py::arg("sstep")=4,
+        docu_string(R"raw_string(
+An s-step GMRES Solver for real systems, without restarts. Computes
+sstep Krylov vectors at once and orthogonalizes them blockwise, which
+needs a few global reductions per sstep iterations instead of one
+per inner product.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input matrix 
+
+pre : ngsolve.la.BaseMatrix
+  input preconditioner matrix, applied from the left
+
+printrates : bool
+  input printrates
+
+precision : float
+  input requested precision of the preconditioned residual
+
+maxsteps : int
+  input maximal steps, also the dimension of the Krylov space
+
+sstep : int
+  input number of Krylov vectors per block
+
+)raw_string"))
+    ;
+
+  py::class_<DeflatedCGSolver, shared_ptr<DeflatedCGSolver>, KrylovSpaceSolver> (m, "DeflatedCGSolver",
+    docu_string(R"raw_string(
+A deflated CG Solver for sequences of SPD systems with slowly changing
+matrices. Keeps a recycled space of approximate eigenvectors to the
+smallest eigenvalues between solves, and iterates in its A-orthogonal
+complement. The matrix may change between the solves.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input matrix 
+
+pre : ngsolve.la.BaseMatrix
+  input preconditioner matrix
+
+printrates : bool
+  input printrates
+
+precision : float
+  input requested precision. DeflatedCGSolver stops if precision is reached.
+
+maxsteps : int
+  input maximal steps. DeflatedCGSolver stops after this steps.
+
+nrecycle : int
+  input dimension of the recycled space
+
+)raw_string"))
+    .def(py::init([](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                     bool printrates, double precision, int maxsteps, int nrecycle)
+                  {
+                    if (mat->IsComplex())
+                      throw Exception ("DeflatedCGSolver: only real matrices are supported");
+                    auto solver = make_shared<DeflatedCGSolver> (mat, pre);
+                    solver->SetPrecision(precision);
+                    solver->SetMaxSteps(maxsteps);
+                    solver->SetPrintRates (printrates);
+                    solver->SetNumRecycle (nrecycle);
+                    return solver;
+                  }),
+         py::arg("mat"), py::arg("pre"), py::arg("printrates")=true,
+         py::arg("precision")=1e-8, py::arg("maxsteps")=200, py::arg("nrecycle")=8)
+    .def_property_readonly("nrecycled", &DeflatedCGSolver::GetNumRecycled,
+                           "dimension of the current recycled space")
+    .def("ClearRecycling", &DeflatedCGSolver::ClearRecycling,
+         "forget the recycled space, e.g. if the matrix has changed a lot")
+    ;
+
+  py::class_<GCROSolver, shared_ptr<GCROSolver>, KrylovSpaceSolver> (m, "GCROSolver",
+    docu_string(R"raw_string(
+A restarted GCRO Solver with recycling for sequences of real systems
+with slowly changing matrices. The corrections of the latest restart
+cycles are kept, also between solves, and the GMRES iteration runs in
+the complement of their images. The preconditioner is applied from
+the left.
+
+Parameters:
+
+mat : ngsolve.la.BaseMatrix
+  input matrix 
+
+pre : ngsolve.la.BaseMatrix
+  input preconditioner matrix
+
+printrates : bool
+  input printrates
+
+precision : float
+  input requested precision of the preconditioned residual
+
+maxsteps : int
+  input maximal steps. GCROSolver stops after this steps.
+
+restart : int
+  input number of GMRES steps per restart cycle
+
+nrecycle : int
+  input dimension of the recycled space
+
+)raw_string"))
+    .def(py::init([](shared_ptr<BaseMatrix> mat, shared_ptr<BaseMatrix> pre,
+                     bool printrates, double precision, int maxsteps, int restart, int nrecycle)
+                  {
+                    if (mat->IsComplex())
+                      throw Exception ("GCROSolver: only real matrices are supported");
+                    auto solver = make_shared<GCROSolver> (mat, pre);
+                    solver->SetPrecision(precision);
+                    solver->SetMaxSteps(maxsteps);
+                    solver->SetPrintRates (printrates);
+                    solver->SetRestart (restart);
+                    solver->SetNumRecycle (nrecycle);
+                    return solver;
+                  }),
+         py::arg("mat"), py::arg("pre"), py::arg("printrates")=true,
+         py::arg("precision")=1e-8, py::arg("maxsteps")=200, py::arg("restart")=30,
+         py::arg("nrecycle")=8)
+    .def_property_readonly("nrecycled", &GCROSolver::GetNumRecycled,
+                           "dimension of the current recycled space")
+    .def("ClearRecycling", &GCROSolver::ClearRecycling,
+         "forget the recycled space, e.g. if the matrix has changed a lot")
+    ;
+
   m.def("EigenValues_Preconditioner", [](const BaseMatrix & mat, const BaseMatrix & pre, double tol) {
       EigenSystem eigen(mat, pre);
       eigen.SetPrecision(tol);
@@ -121,27 +121,149 @@ namespace ngla
   SparseCholeskyTM (const SparseMatrixTM<TM> & a, 
                     shared_ptr<BitArray> ainner,
                     shared_ptr<const Array<int>> acluster,
-                    bool allow_refactor)
-    : SparseFactorization (a, ainner, acluster), mat(a)
+                    bool allow_refactor,
+                    ORDERINGTYPE aordering,
+                    bool asupernodal,
+                    bool asingle)
+    : SparseFactorization (a, ainner, acluster), analysis(FindAnalysis (a, aordering)),
+      mdo(nullptr), ordering(aordering),
+      supernodal(asupernodal),
+      single(asingle && !is_same<TSINGLE,TM>::value), mat(a)
   { 
     static Timer t("SparseCholesky - total");
-    static Timer ta("SparseCholesky - allocate");
     RegionTimer reg(t);
     // (*testout) << "matrix = " << a << endl;
     // (*testout) << "diag a = ";
     // for ( int i=0; i<a.Height(); i++ ) (*testout) << i << ", " << a(i,i) << endl;
 
-    int n = a.Height();
-    height = n;
+    height = a.Height();
+    if (single)
+      {
+        refinement_matrix = matrix.lock();
+        if (!refinement_matrix)
+          throw Exception ("SparseCholesky: single precision needs the matrix for iterative refinement");
+      }
 
     int printstat = 0;
+    clock_t starttime, endtime;
+    starttime = clock();
+
+    if (analysis->complete)
+      {
+        static Timer treuse("SparseCholesky - analysis reused");
+        RegionTimer regreuse(treuse);
+        nused = analysis->nused;
+        nze = analysis->nze;
+        maxrow = analysis->maxrow;
+        cout << IM(4) << "SparseCholesky: reuse analysis, saved " << analysis->time << " sec" << endl;
+      }
+    else
+      Analyse (a);
+
+    diag.SetSize(nused);
+    // lfact.SetSize (nze);
+    lfact = NumaInterleavedArray<TM> (nze);
+
+    // lfact = TM(0.0);     // first touch
+    ParallelForRange (nze, [&] (IntRange r)
+                      {
+                        lfact.Range(r) = TM(0.0);
+                      });
     
+    endtime = clock();
     if (printstat)
-      cout << IM(4) << "Minimal degree ordering: N = " << n << endl;
+      (cout) << "allocation time = "
+	     << double (endtime - starttime) / CLOCKS_PER_SEC << " secs" << endl;
     
+    starttime = endtime;
+    FactorNew(a);
+    /*
+#ifdef LAPACK
+    if (a.IsSPD())
+      FactorSPD();
+    else
+#endif
+      Factor(); 
+    */
+
+    /*
+    for (int i = 0; i < n; i++)
+      if (a.GetPositionTest (i,i) == numeric_limits<size_t>::max())
+	diag[order[i]] = TM(0.0);
+
+    if (inner)
+      {
+	for (int i = 0; i < n; i++)
+	  if (!inner->Test(i))
+	    diag[order[i]] = TM(0.0);
+      }
+
+    if (cluster)
+      {
+	for (int i = 0; i < n; i++)
+	  if (!(*cluster)[i])
+	    diag[order[i]] = TM(0.0);
+      }
+    */
+
+    if (printstat)
+      cout << IM(4) << "done" << endl;
+    
+    endtime = clock();
+
+    if (printstat)
+      (cout) << " factoring time = " << double(endtime - starttime) / CLOCKS_PER_SEC << " sec" << endl;
+  }
+  
+
+  
+  // analyses of recent factorizations, for reuse with the same matrix graph.
+  // The cache holds weak references only: an analysis is found as long as
+  // some factorization using it is still alive, e.g. the old inverse while
+  // the new one is set up. Once all of them are released, the next
+  // factorization analyses again.
+  static mutex analysis_cache_mutex;
+
+  template <class TM>
+  Array<weak_ptr<typename SparseCholeskyTM<TM>::Analysis>> & AnalysisCache ()
+  {
+    static Array<weak_ptr<typename SparseCholeskyTM<TM>::Analysis>> cache;
+    return cache;
+  }
+
+  static bool SameDofs (const BitArray * a, const BitArray * b)
+  {
+    if (!a || !b) return !a && !b;
+    if (a->Size() != b->Size()) return false;
+    for (size_t i = 0; i < a->Size(); i++)
+      if (a->Test(i) != b->Test(i)) return false;
+    return true;
+  }
+
+  static bool SameDofs (const Array<int> * a, const Array<int> * b)
+  {
+    if (!a || !b) return !a && !b;
+    if (a->Size() != b->Size()) return false;
+    for (size_t i = 0; i < a->Size(); i++)
+      if ((*a)[i] != (*b)[i]) return false;
+    return true;
+  }
+
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: 
+  OrderMinimumDegree (const SparseMatrixTM<TM> & a)
+  {
+    static Timer ta("SparseCholesky - allocate");
+    int n = a.Height();
+
+    int printstat = 0;
     clock_t starttime, endtime;
     starttime = clock();
     
+    if (printstat)
+      cout << IM(4) << "Minimal degree ordering: N = " << n << endl;
+    
     mdo = new MinimumDegreeOrdering (n);
 
     if (inner)
@@ -230,64 +352,123 @@ namespace ngla
 
     delete mdo;
     mdo = 0;
+  }
 
-    diag.SetSize(nused);
-    // lfact.SetSize (nze);
-    lfact = NumaInterleavedArray<TM> (nze);
 
-    // lfact = TM(0.0);     // first touch
-    ParallelForRange (nze, [&] (IntRange r)
-                      {
-                        lfact.Range(r) = TM(0.0);
-                      });
-    
-    endtime = clock();
-    if (printstat)
-      (cout) << "allocation time = "
-	     << double (endtime - starttime) / CLOCKS_PER_SEC << " secs" << endl;
-    
-    starttime = endtime;
-    FactorNew(a);
-    /*
-#ifdef LAPACK
-    if (a.IsSPD())
-      FactorSPD();
-    else
-#endif
-      Factor(); 
-    */
-
-    /*
-    for (int i = 0; i < n; i++)
-      if (a.GetPositionTest (i,i) == numeric_limits<size_t>::max())
-	diag[order[i]] = TM(0.0);
+  template <class TM>
+  void SparseCholeskyTM<TM> :: 
+  Analyse (const SparseMatrixTM<TM> & a)
+  {
+    static Timer t("SparseCholesky - analysis");
+    static Timer ta("SparseCholesky - allocate");
+    RegionTimer reg(t);
+    double analysis_start = WallTime();
 
-    if (inner)
+    if (ordering == NESTED_DISSECTION_ORDERING)
       {
-	for (int i = 0; i < n; i++)
-	  if (!inner->Test(i))
-	    diag[order[i]] = TM(0.0);
+        ta.Start();
+        OrderNestedDissection (a);
+        ta.Stop();
       }
+    else
+      OrderMinimumDegree (a);
 
+    analysis->graph_timestamp = a.GetTimeStamp();
+    analysis->ordering = ordering;
+    if (inner)
+      analysis->inner = make_shared<BitArray> (*inner);
     if (cluster)
-      {
-	for (int i = 0; i < n; i++)
-	  if (!(*cluster)[i])
-	    diag[order[i]] = TM(0.0);
-      }
-    */
+      analysis->cluster = make_shared<Array<int>> (*cluster);
+
+    analysis->nused = nused;
+    analysis->nze = nze;
+    analysis->maxrow = maxrow;
+    analysis->time = WallTime()-analysis_start;
+    analysis->complete = true;
+
+    lock_guard<mutex> guard(analysis_cache_mutex);
+    auto & cache = AnalysisCache<TM>();
+    for (size_t i = cache.Size(); i-- > 0; )
+      if (cache[i].expired())
+        cache.DeleteElement(i);
+    cache.Append (analysis);
+  }
 
-    if (printstat)
-      cout << IM(4) << "done" << endl;
+
+  template <class TM>
+  shared_ptr<typename SparseCholeskyTM<TM>::Analysis> SparseCholeskyTM<TM> :: 
+  FindAnalysis (const SparseMatrixTM<TM> & a, ORDERINGTYPE aordering) const
+  {
+    lock_guard<mutex> guard(analysis_cache_mutex);
+    for (auto & weak : AnalysisCache<TM>())
+      if (auto an = weak.lock())
+        if (an->graph_timestamp == a.GetTimeStamp() && an->ordering == aordering &&
+            an->order.Size() == size_t(a.Height()) &&
+            SameDofs (an->inner.get(), inner.get()) &&
+            SameDofs (an->cluster.get(), cluster.get()))
+          return an;
+    // filled by Analyse, and published in the cache when complete
+    return make_shared<Analysis>();
+  }
+
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: 
+  OrderNestedDissection (const SparseMatrixTM<TM> & a)
+  {
+    static Timer t("SparseCholesky - nested dissection");
+    static Timer tg("SparseCholesky - nested dissection, graph");
+    RegionTimer reg(t);
     
-    endtime = clock();
+    int n = a.Height();
 
-    if (printstat)
-      (cout) << " factoring time = " << double(endtime - starttime) / CLOCKS_PER_SEC << " sec" << endl;
+    auto used = [&] (int i)
+      {
+        if (inner && !inner->Test(i)) return false;
+        if (cluster && !(*cluster)[i]) return false;
+        return true;
+      };
+
+    auto coupling = [&] (int i, int j)
+      {
+        if (inner) return inner->Test(i) && inner->Test(j);
+        if (cluster) return (*cluster)[i] == (*cluster)[j] && (*cluster)[i];
+        return true;
+      };
+
+    tg.Start();
+    TableCreator<int> creator(n);
+    for ( ; !creator.Done(); creator++)
+      ParallelFor (n, [&] (int i)
+                   {
+                     for (int col : a.GetRowIndices(i))
+                       if (col < i && coupling (i, col))
+                         {
+                           creator.Add (i, col);
+                           creator.Add (col, i);
+                         }
+                   });
+    Table<int> graph = creator.MoveTable();
+    // sorted rows make the ordering deterministic
+    ParallelFor (n, [&] (int i)
+                 {
+                   QuickSort (graph[i]);
+                 });
+    tg.Stop();
+
+    NestedDissectionOrdering nd(move(graph));
+    for (int i = 0; i < n; i++)
+      if (!used(i))
+        nd.SetUnusedVertex(i);
+
+    nd.Order();
+    nused = nd.nused;
+
+    Allocate (nd.order, nd.vertices, nd.blocknr.Data());
   }
-  
 
   
+
   template <class TM>
   void SparseCholeskyTM<TM> :: 
   Allocate (const Array<int> & aorder, 
@@ -525,6 +706,8 @@ namespace ngla
 	cout << IM(4) << "SparseCholesky::FactorNew called with matrix of different size." << endl;
 	return;
       }
+    if (lfact.Size() != nze)   // released by StoreSinglePrecision
+      lfact = NumaInterleavedArray<TM> (nze);
     lfact = TM(0.0);
 
     if (!inner && !cluster)
@@ -566,7 +749,32 @@ namespace ngla
 	    }
 	}
     tf.Stop();
-    FactorSPD(); 
+    if (supernodal)
+      FactorSupernodal();
+    else
+      FactorSPD(); 
+    if (single)
+      StoreSinglePrecision();
+  }
+
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: StoreSinglePrecision ()
+  {
+    static Timer t("SparseCholesky - store single precision");
+    RegionTimer reg(t);
+
+    // both copies are alive during the conversion, the peak memory is
+    // about 1.5 times the double precision factor
+
+    if (lfact_single.Size() != nze)
+      lfact_single = NumaInterleavedArray<TSINGLE> (nze);
+    ParallelForRange (nze, [&] (IntRange r)
+                      {
+                        for (auto i : r)
+                          lfact_single[i] = TSINGLE(lfact[i]);
+                      });
+    lfact = NumaInterleavedArray<TM> ();
   }
  
 
@@ -1501,6 +1709,209 @@ namespace ngla
   
 
 
+  template <class TM>
+  void SparseCholeskyTM<TM> :: FactorSupernodal ()
+  {
+    FactorSPD();
+  }
+
+  template <>
+  void SparseCholeskyTM<double> :: FactorSupernodal ()
+  {
+    FactorSupernodal1(5.3);
+  }
+
+  template <>
+  void SparseCholeskyTM<Complex> :: FactorSupernodal ()
+  {
+    FactorSupernodal1(5.2);
+  }
+
+
+  /*
+    Left-looking supernodal factorization:
+    
+    For every block (supernode) J, the columns of J together with all rows
+    of its structure are gathered into a dense panel. All blocks K updating J
+    (the transposed block-dependency) are already factored, their
+    contribution  L_K D_K L_K^t  restricted to the rows/cols of J is computed 
+    by one gemm (SubADBt), and added to the panel. Then the panel is 
+    factored by the dense LDL^t kernel. Block J only writes to its own
+    panel, so no locks are needed.
+
+    While the factorization is running, the segment of a finished block in
+    lfact holds the external rows as dense column-major matrix 
+    (next x mi, leading dimension next), followed by the strictly lower part
+    of the diagonal block, packed column-wise. Both fit exactly into the
+    segment. The row-wise layout is restored at the end.
+  */
+  template <class TM> template<typename T>
+  void SparseCholeskyTM<TM> :: FactorSupernodal1 (T dummy) 
+  {
+    if (!task_manager)
+      {
+        RunWithTaskManager ([&] ()
+                            {
+                              FactorSupernodal1(dummy);
+                            });
+        return;
+      }
+
+    static Timer factor_timer("SparseCholesky::Factor supernodal");
+    static Timer timer_restore("SparseCholesky::Factor supernodal - restore layout");
+    RegionTimer reg (factor_timer);
+
+    size_t n = nused;
+    if (n > 2000){
+      cout << IM(4) << " factor supernodal " << flush;
+    }
+
+    size_t * hfirstinrow = firstinrow.Addr(0);
+    TM * hlfact = lfact.Addr(0);
+    TM * hdiag = diag.Addr(0);
+
+    // blocks K updating block J
+    TableCreator<int> creator_trans(block_dependency.Size());
+    for ( ; !creator_trans.Done(); creator_trans++)
+      ParallelFor (block_dependency.Size(), [&] (int i)
+                   {
+                     for (int j : block_dependency[i])
+                       creator_trans.Add(j, i);
+                   });
+    auto block_dep_trans = creator_trans.MoveTable();
+
+    // the factored external rows of a block
+    auto ext_panel = [&] (int bnr)
+      {
+        size_t mi = BlockDofs(bnr).Size();
+        size_t next = BlockExtDofs(bnr).Size();
+        return SliceMatrix<TM,ColMajor> (next, mi, next, hlfact+hfirstinrow[blocks[bnr]]);
+      };
+    
+    RunParallelDependency
+      (block_dependency, block_dep_trans, [&] (int blocknr)
+       {
+         IntRange block = BlockDofs(blocknr);
+         size_t mi = block.Size();
+         if (mi == 0) return;
+         
+         size_t i1 = block.First();
+         FlatArray<int> extdofs = BlockExtDofs(blocknr);
+         size_t next = extdofs.Size();
+         size_t nk = mi + next;
+         
+         ArrayMem<TM,1000> panelmem(nk*mi);
+         FlatMatrix<TM,ColMajor> panel(nk, mi, panelmem.Addr(0));
+         panel = TM(0.0);
+         for (size_t j = 0; j < mi; j++)
+           {
+             panel(j,j) = hdiag[i1+j];
+             panel.Col(j).Range(j+1,nk) = FlatVector<TM>(nk-j-1, hlfact+hfirstinrow[i1+j]);
+           }
+
+         for (int k : block_dep_trans[blocknr])
+           {
+             FlatArray<int> extk = BlockExtDofs(k);
+             const int * pk = extk.Data();
+             size_t p0 = lower_bound (pk, pk+extk.Size(), int(i1)) - pk;
+             size_t p1 = lower_bound (pk+p0, pk+extk.Size(), int(block.Next())) - pk;
+             size_t nr = extk.Size()-p0;
+             size_t nc = p1-p0;
+             if (nc == 0) continue;
+
+             // position of the rows of block k within the panel
+             ArrayMem<int,256> rel(nr);
+             for (size_t r = 0; r < nc; r++)
+               rel[r] = pk[p0+r]-i1;
+             const int * pj = extdofs.Data();
+             size_t pos = 0;
+             for (size_t r = nc; r < nr; r++)
+               {
+                 pos = lower_bound (pj+pos, pj+next, pk[p0+r]) - pj;
+                 rel[r] = mi+pos;
+               }
+
+             auto lk = ext_panel(k);
+             IntRange blockk = BlockDofs(k);
+             SliceVector<TM> diagk(blockk.Size(), 1, hdiag+blockk.First());
+
+             if (rel[nr-1]-rel[0] == nr-1)
+               {
+                 // rows are contiguous in the panel: update in place
+                 auto target = panel.Rows(rel[0], rel[0]+nr).Cols(rel[0], rel[0]+nc);
+                 MySubADBt<TM,ColMajor> (lk.Rows(p0,p0+nr), diagk, lk.Rows(p0,p1), target, true);
+               }
+             else
+               {
+                 ArrayMem<TM,1000> wmem(nr*nc);
+                 FlatMatrix<TM,ColMajor> w(nr, nc, wmem.Addr(0));
+                 w = TM(0.0);
+                 MySubADBt<TM,ColMajor> (lk.Rows(p0,p0+nr), diagk, lk.Rows(p0,p1), w, true);
+                 for (size_t c = 0; c < nc; c++)
+                   for (size_t r = c; r < nr; r++)
+                     panel(rel[r], rel[c]) += w(r,c);
+               }
+           }
+
+         auto A11 = panel.Rows(0,mi);
+         auto B   = panel.Rows(mi,nk);
+         CalcLDL (A11);
+         if (next)
+           CalcLDL_SolveL (A11, B);
+
+         for (size_t j = 0; j < mi; j++)
+           hdiag[i1+j] = A11(j,j);
+         TM * hext = hlfact + hfirstinrow[i1];
+         for (size_t j = 0; j < mi; j++)
+           FlatVector<TM>(next, hext+j*next) = B.Col(j);
+         TM * tri = hext + next*mi;
+         for (size_t j = 0; j < mi; j++)
+           for (size_t k = j+1; k < mi; k++)
+             *tri++ = A11(k,j);
+       });
+
+    // back to row-wise storage, and scale with the inverse diagonal
+    timer_restore.Start();
+    ParallelFor (blocks.Size()-1, [&] (size_t blocknr)
+      {
+        IntRange block = BlockDofs(blocknr);
+        size_t mi = block.Size();
+        if (mi == 0) return;
+
+        size_t i1 = block.First();
+        size_t next = BlockExtDofs(blocknr).Size();
+        size_t first = hfirstinrow[i1];
+        size_t size = hfirstinrow[block.Next()] - first;
+        
+        ArrayMem<TM,1000> seg(size);
+        for (size_t i = 0; i < size; i++)
+          seg[i] = hlfact[first+i];
+        
+        FlatMatrix<TM,ColMajor> ext(next, mi, seg.Addr(0));
+        TM * tri = seg.Addr(0) + next*mi;
+        for (size_t j = 0; j < mi; j++)
+          {
+            TM ai = hdiag[i1+j];
+            TM * col = hlfact + hfirstinrow[i1+j];
+            for (size_t k = j+1; k < mi; k++)
+              *col++ = *tri++ * ai;
+            for (size_t e = 0; e < next; e++)
+              *col++ = ext(e,j) * ai;
+          }
+      }, TasksPerThread(5));
+    timer_restore.Stop();
+
+    if (n > 2000){
+      cout << IM(4) << endl;
+    }
+  }
+
+
+
+
+  
+
+
   template <class TM, class TV_ROW, class TV_COL>
   void SparseCholesky<TM, TV_ROW, TV_COL> :: 
   Mult (const BaseVector & x, BaseVector & y) const
@@ -1640,6 +2051,16 @@ namespace ngla
   template <class TM, class TV_ROW, class TV_COL>
   void SparseCholesky<TM, TV_ROW, TV_COL> :: 
   SolveReordered (FlatVector<TVX> hy) const
+  {
+    if (single)
+      SolveReordered1 (hy, lfact_single.Data());
+    else
+      SolveReordered1 (hy, lfact.Data());
+  }
+
+  template <class TM, class TV_ROW, class TV_COL> template <typename TF>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  SolveReordered1 (FlatVector<TVX> hy, TF * hlfact) const
   {
     static Timer timer1("SparseCholesky<d,d,d>::MultAdd fac1");
     static Timer timer2("SparseCholesky<d,d,d>::MultAdd fac2");
@@ -1738,11 +2159,11 @@ namespace ngla
                                      size_t size = range.end()-i-1;
                                      if (size > 0)
                                        {
-                                         FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                         FlatVector<TF> vlfact(size, hlfact+firstinrow[i]);
                                          
                                          auto hyr = hy.Range(i+1, range.end());
                                          for (size_t j = 0; j < size; j++)
-                                           hyr(j) -= Trans(vlfact(j)) * hyi;
+                                           hyr(j) -= Trans(TM(vlfact(j))) * hyi;
                                        }
                                      if (extdofs.Size() == 0)
                                        {
@@ -1750,9 +2171,9 @@ namespace ngla
                                          continue;
                                        }
                                      size_t first = firstinrow[i] + range.end()-i-1;
-                                     FlatVector<TM> ext_lfact (extdofs.Size(), &lfact[first]);
+                                     FlatVector<TF> ext_lfact (extdofs.Size(), hlfact+first);
                                      for (size_t j = 0; j < temp.Size(); j++)
-                                       temp(j) += Trans(ext_lfact(j)) * hyi;
+                                       temp(j) += Trans(TM(ext_lfact(j))) * hyi;
                                    }
                                  
                                  for (size_t j : Range(extdofs))
@@ -1766,12 +2187,12 @@ namespace ngla
                                    {
                                      size_t size = range.end()-i-1;
                                      if (size == 0) continue;
-                                     FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                     FlatVector<TF> vlfact(size, hlfact+firstinrow[i]);
 
                                      TVX hyi = hy(i);
                                      auto hyr = hy.Range(i+1, range.end());
                                      for (size_t j = 0; j < hyr.Size(); j++)
-                                       hyr(j) -= Trans(vlfact(j)) * hyi;
+                                       hyr(j) -= Trans(TM(vlfact(j))) * hyi;
                                    }
 
                                }
@@ -1792,11 +2213,11 @@ namespace ngla
                                        {
                                          size_t first = firstinrow[i] + range.end()-i-1;
                                          
-                                         FlatVector<TM> ext_lfact (all_extdofs.Size(), &lfact[first]);
+                                         FlatVector<TF> ext_lfact (all_extdofs.Size(), hlfact+first);
  
                                          TVX hyi = hy(i);
                                          for (size_t j = 0; j < temp.Size(); j++)
-                                           temp(j) += Trans(ext_lfact(myr.begin()+j)) * hyi;
+                                           temp(j) += Trans(TM(ext_lfact(myr.begin()+j))) * hyi;
                                        }
                                      
                                      for (size_t j : Range(extdofs))
@@ -1848,23 +2269,23 @@ namespace ngla
                                    for (auto i : range)
                                      {
                                        size_t first = firstinrow[i] + range.end()-i-1;
-                                       FlatVector<TM> ext_lfact (extdofs.Size(), &lfact[first]);
+                                       FlatVector<TF> ext_lfact (extdofs.Size(), hlfact+first);
                                        
                                        TVX val(0.0);
                                        for (auto j : Range(extdofs))
-                                         val += ext_lfact(j) * temp(j);
+                                         val += TM(ext_lfact(j)) * temp(j);
                                        hy(i) -= val;
                                      }
                                  for (size_t i = range.end()-1; i-- > range.begin(); )
                                    {
                                      size_t size = range.end()-i-1;
                                      if (size == 0) continue;
-                                     FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                     FlatVector<TF> vlfact(size, hlfact+firstinrow[i]);
                                      auto hyr = hy.Range(i+1, range.end());
 
                                      TVX hyi = hy(i);
                                      for (size_t j = 0; j < vlfact.Size(); j++)
-                                       hyi -= vlfact(j) * hyr(j);
+                                       hyi -= TM(vlfact(j)) * hyr(j);
                                      hy(i) = hyi;
                                    }
                                  
@@ -1877,12 +2298,12 @@ namespace ngla
                                    {
                                      size_t size = range.end()-i-1;
                                      if (size == 0) continue;
-                                     FlatVector<TM> vlfact(size, &lfact[firstinrow[i]]);
+                                     FlatVector<TF> vlfact(size, hlfact+firstinrow[i]);
                                      auto hyr = hy.Range(i+1, range.end());
 
                                      TVX hyi = hy(i);
                                      for (size_t j = 0; j < vlfact.Size(); j++)
-                                       hyi -= vlfact(j) * hyr(j);
+                                       hyi -= TM(vlfact(j)) * hyr(j);
                                      hy(i) = hyi;
                                    }
 
@@ -1904,11 +2325,11 @@ namespace ngla
                                      for (auto i : range)
                                        {
                                          size_t first = firstinrow[i] + range.end()-i-1;
-                                         FlatVector<TM> ext_lfact (all_extdofs.Size(), &lfact[first]);
+                                         FlatVector<TF> ext_lfact (all_extdofs.Size(), hlfact+first);
     
                                          TVX val(0.0);
                                          for (auto j : Range(extdofs))
-                                           val += ext_lfact(myr.begin()+j) * temp(j);
+                                           val += TM(ext_lfact(myr.begin()+j)) * temp(j);
                                          AtomicAdd (hy(i), -val);
                                        }
                                    }
@@ -1926,7 +2347,7 @@ namespace ngla
   {
     static Timer timer("SparseCholesky<d,d,d>::MultAdd");
     RegionTimer reg (timer);
-    timer.AddFlops (2.0*lfact.Size());
+    timer.AddFlops (2.0*this->nze);
 
     // int n = Height();
     
@@ -1937,14 +2358,26 @@ namespace ngla
     Vector<TVX> hy1(nused);
     FlatVector<TVX> hy(hy1);
 
-    ParallelFor (Range(height), [&] (int i)
-                 {
-                   if (order[i] != -1)
-                     hy(order[i]) = fx(i);
-                 });
-
-
-    SolveReordered(hy);
+    if (single)
+      {
+        Vector<TVX> hx(height);
+        SolveRefined (fx, hx);
+        ParallelFor (Range(height), [&] (int i)
+                     {
+                       if (order[i] != -1)
+                         hy(order[i]) = hx(i);
+                     });
+      }
+    else
+      {
+        ParallelFor (Range(height), [&] (int i)
+                     {
+                       if (order[i] != -1)
+                         hy(order[i]) = fx(i);
+                     });
+        
+        SolveReordered(hy);
+      }
 
     if (inner)
       {
@@ -1981,6 +2414,64 @@ namespace ngla
   
 
 
+  /*
+    Mixed precision solve: L is stored in single precision, the
+    residual is computed in double precision with the original matrix.
+    hx = A^{-1} fx on the used dofs, zero elsewhere.
+    Stops if the correction is at rounding level, or stagnates.
+  */
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  SolveRefined (FlatVector<TVX> fx, FlatVector<TVX> hx) const
+  {
+    static Timer timer("SparseCholesky::SolveRefined");
+    static Timer timerres("SparseCholesky::SolveRefined - residual");
+    RegionTimer reg (timer);
+
+    // with clusters L ignores the couplings between clusters, but the matrix does not.
+    auto hmat = dynamic_pointer_cast<const SparseMatrix<TM,TV,TV>> (refinement_matrix);
+    if (!hmat)
+      throw Exception ("SparseCholesky::SolveRefined: no matrix for refinement");
+    int maxsteps = cluster ? 1 : 10;
+
+    Vector<TVX> r(height);
+    Vector<TVX> hy(this->nused);
+    VFlatVector<TVX> vx(height, hx.Data());
+    VFlatVector<TVX> vr(height, r.Data());
+
+    hx = TVX(0.0);
+    r = fx;
+    double norm0 = 0, lastcorr = 0;
+    for (int step = 0; step < maxsteps; step++)
+      {
+        if (step > 0)
+          {
+            RegionTimer regres (timerres);
+            r = fx;
+            hmat->MultAdd (-1.0, vx, vr);
+          }
+
+        ParallelFor (Range(height), [&] (int i)
+                     {
+                       if (order[i] != -1)
+                         hy(order[i]) = r(i);
+                     });
+        SolveReordered (hy);
+        ParallelFor (Range(height), [&] (int i)
+                     {
+                       if (order[i] != -1)
+                         hx(i) += hy(order[i]);
+                     });
+
+        double corr = L2Norm (hy);
+        if (step == 0) norm0 = corr;
+        if (corr <= 1e-14 * norm0) break;
+        if (step > 0 && corr > 0.5 * lastcorr) break;
+        lastcorr = corr;
+      }
+  }
+
+
   template <class TM, class TV_ROW, class TV_COL>
   void SparseCholesky<TM, TV_ROW, TV_COL> :: 
   Smooth (BaseVector & u, const BaseVector & f, BaseVector & y) const
@@ -2018,6 +2509,261 @@ namespace ngla
 
 
 
+  /*
+    Block-solve for k right-hand sides, one column of hy per rhs.
+    Same micro-tasks as SolveReordered, but the external part of every
+    block is applied to all right-hand sides by one gemm, such that lfact
+    is streamed only once. The external entries of up to 'chunk' columns
+    are copied into a small dense buffer first, since their distance in
+    lfact is not constant.
+  */
+  template <class TM, class TV_ROW, class TV_COL> template <typename T, typename TF>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  SolveReorderedMulti (SliceMatrix<T,ColMajor> hy, TF * hlfact) const
+  {
+    static Timer timer1("SparseCholesky::MultMulti fac1");
+    static Timer timer2("SparseCholesky::MultMulti fac2");
+
+    size_t k = hy.Width();
+    size_t chunk = 128;
+
+    // external entries of columns cols, restricted to ext-rows myr
+    auto gather_ext = [&] (IntRange range, IntRange cols, IntRange myr, FlatMatrix<T> et)
+      {
+        for (size_t i : cols)
+          {
+            size_t first = firstinrow[i] + range.end()-i-1;
+            FlatVector<TF> ext_lfact(myr.Size(), hlfact+first+myr.First());
+            auto eti = et.Row(i-cols.First());
+            for (size_t j = 0; j < myr.Size(); j++)
+              eti(j) = T(ext_lfact(j));
+          }
+      };
+
+    auto ext_range = [&] (const MicroTask & task, FlatArray<int> all_extdofs)
+      {
+        if (task.type == MicroTask::LB_BLOCK)
+          return IntRange(0, all_extdofs.Size());
+        return IntRange(Range(all_extdofs).Split (task.bblock, task.nbblocks));
+      };
+    
+    timer1.Start();
+    RunParallelDependency (micro_dependency, micro_dependency_trans,
+                           [&] (int nr) 
+                           {
+                             auto task = microtasks[nr];
+                             size_t blocknr = task.blocknr;
+                             auto range = BlockDofs (blocknr);
+                             if (range.Size()==0) return;
+
+                             if (task.type != MicroTask::B_BLOCK)
+                               for (size_t l = 0; l < k; l++)
+                                 {
+                                   auto hyl = hy.Col(l);
+                                   for (auto i : range)
+                                     {
+                                       size_t size = range.end()-i-1;
+                                       if (size == 0) continue;
+                                       FlatVector<TF> vlfact(size, hlfact+firstinrow[i]);
+                                       T hyi = hyl(i);
+                                       for (size_t j = 0; j < size; j++)
+                                         hyl(i+1+j) -= T(vlfact(j)) * hyi;
+                                     }
+                                 }
+
+                             if (task.type == MicroTask::L_BLOCK) return;
+                             
+                             auto all_extdofs = BlockExtDofs (blocknr);
+                             if (all_extdofs.Size() == 0) return;
+                             auto myr = ext_range (task, all_extdofs);
+                             auto extdofs = all_extdofs.Range(myr);
+
+                             ArrayMem<T,2048> tempmem(extdofs.Size()*k);
+                             FlatMatrix<T,ColMajor> temp(extdofs.Size(), k, tempmem.Addr(0));
+                             temp = T(0.0);
+                             
+                             ArrayMem<T,2048> etmem(min(chunk, range.Size())*extdofs.Size());
+                             for (size_t i0 = range.First(); i0 < range.Next(); i0 += chunk)
+                               {
+                                 IntRange cols(i0, min(i0+chunk, size_t(range.Next())));
+                                 FlatMatrix<T> et(cols.Size(), extdofs.Size(), etmem.Addr(0));
+                                 gather_ext (range, cols, myr, et);
+                                 temp += Trans(et) * hy.Rows(cols);
+                               }
+
+                             for (size_t j : Range(extdofs))
+                               for (size_t l = 0; l < k; l++)
+                                 AtomicAdd (hy(extdofs[j], l), -temp(j,l));
+                           });
+    timer1.Stop();
+
+    // solve with the diagonal
+    const TM * hdiag = diag.Data();
+    ParallelFor (hy.Height(), [&] (size_t i)
+                 {
+                   for (size_t l = 0; l < k; l++)
+                     hy(i,l) = hdiag[i] * hy(i,l);
+                 });
+
+    timer2.Start();
+    RunParallelDependency (micro_dependency_trans, micro_dependency,
+                           [&] (int nr) 
+                           {
+                             auto task = microtasks[nr];
+                             size_t blocknr = task.blocknr;
+                             auto range = BlockDofs (blocknr);
+                             if (range.Size()==0) return;
+
+                             auto all_extdofs = BlockExtDofs (blocknr);
+                             if (task.type != MicroTask::L_BLOCK && all_extdofs.Size() != 0)
+                               { 
+                                 auto myr = ext_range (task, all_extdofs);
+                                 auto extdofs = all_extdofs.Range(myr);
+
+                                 ArrayMem<T,2048> gmem(extdofs.Size()*k);
+                                 FlatMatrix<T,ColMajor> g(extdofs.Size(), k, gmem.Addr(0));
+                                 for (size_t j : Range(extdofs))
+                                   for (size_t l = 0; l < k; l++)
+                                     g(j,l) = hy(extdofs[j],l);
+
+                                 ArrayMem<T,2048> etmem(min(chunk, range.Size())*extdofs.Size());
+                                 ArrayMem<T,2048> tempmem(min(chunk, range.Size())*k);
+                                 for (size_t i0 = range.First(); i0 < range.Next(); i0 += chunk)
+                                   {
+                                     IntRange cols(i0, min(i0+chunk, size_t(range.Next())));
+                                     FlatMatrix<T> et(cols.Size(), extdofs.Size(), etmem.Addr(0));
+                                     gather_ext (range, cols, myr, et);
+                                     if (task.type == MicroTask::LB_BLOCK)
+                                       {
+                                         auto hyc = hy.Rows(cols);
+                                         hyc -= et * g;
+                                       }
+                                     else
+                                       {
+                                         // several B-blocks update the same rows
+                                         FlatMatrix<T,ColMajor> temp(cols.Size(), k, tempmem.Addr(0));
+                                         temp = et * g;
+                                         for (size_t i = 0; i < cols.Size(); i++)
+                                           for (size_t l = 0; l < k; l++)
+                                             AtomicAdd (hy(cols.First()+i, l), -temp(i,l));
+                                       }
+                                   }
+                               }
+                             
+                             if (task.type == MicroTask::B_BLOCK) return;
+                             
+                             for (size_t l = 0; l < k; l++)
+                               {
+                                 auto hyl = hy.Col(l);
+                                 for (size_t i = range.end()-1; i-- > range.begin(); )
+                                   {
+                                     size_t size = range.end()-i-1;
+                                     FlatVector<TF> vlfact(size, hlfact+firstinrow[i]);
+                                     T hyi = hyl(i);
+                                     for (size_t j = 0; j < size; j++)
+                                       hyi -= T(vlfact(j)) * hyl(i+1+j);
+                                     hyl(i) = hyi;
+                                   }
+                               }
+                           });
+    timer2.Stop();
+  }
+
+
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  MultMulti (FlatArray<shared_ptr<BaseVector>> x,
+             FlatArray<shared_ptr<BaseVector>> y) const
+  {
+    if constexpr (is_same<TM,TVX>::value &&
+                  (is_same<TM,double>::value || is_same<TM,Complex>::value))
+      {
+        static Timer timer("SparseCholesky::MultMulti");
+        RegionTimer reg (timer);
+        if (x.Size() != y.Size())
+          throw Exception ("SparseCholesky::MultMulti: number of vectors don't match");
+        size_t k = x.Size();
+        timer.AddFlops (2.0*this->nze*k);
+
+        // with single precision L, refine all right-hand sides together
+        auto hmat = dynamic_pointer_cast<const SparseMatrix<TM,TV,TV>> (refinement_matrix);
+        if (single && !hmat)
+          throw Exception ("SparseCholesky::MultMulti: no matrix for refinement");
+        int maxsteps = (single && !cluster) ? 10 : 1;
+        Array<shared_ptr<BaseVector>> res(maxsteps > 1 ? k : 0);
+        for (auto & r : res)
+          r = make_shared<VVector<TVX>> (height);
+        for (size_t l = 0; l < k; l++)
+          y[l]->FV<TVX>() = TVX(0.0);
+
+        Matrix<TVX,ColMajor> hy(this->nused, k);
+        double norm0 = 0, lastcorr = 0;
+        for (int step = 0; step < maxsteps; step++)
+          {
+            for (size_t l = 0; l < k; l++)
+              {
+                if (step > 0)
+                  {
+                    *res[l] = *x[l];
+                    hmat->MultAdd (-1.0, *y[l], *res[l]);
+                  }
+                const FlatVector<TVX> fx = (step > 0 ? res[l] : x[l])->FV<TVX> ();
+                auto hyl = hy.Col(l);
+                ParallelFor (Range(height), [&] (int i)
+                             {
+                               if (order[i] != -1)
+                                 hyl(order[i]) = fx(i);
+                             });
+              }
+
+            if (single)
+              SolveReorderedMulti<TVX> (hy, lfact_single.Data());
+            else
+              SolveReorderedMulti<TVX> (hy, lfact.Data());
+
+            double corr = 0;
+            for (size_t l = 0; l < k; l++)
+              {
+                FlatVector<TVX> fy = y[l]->FV<TVX> ();
+                auto hyl = hy.Col(l);
+                ParallelFor (Range(height), [&] (int i)
+                             {
+                               if (order[i] != -1)
+                                 fy(i) += hyl(order[i]);
+                             });
+                corr = max(corr, L2Norm(hyl));
+              }
+            
+            if (step == 0) norm0 = corr;
+            if (corr <= 1e-14 * norm0) break;
+            if (step > 0 && corr > 0.5 * lastcorr) break;
+            lastcorr = corr;
+          }
+
+        for (size_t l = 0; l < k; l++)
+          {
+            FlatVector<TVX> fy = y[l]->FV<TVX> ();
+            ParallelFor (Range(height), [&] (int i)
+                         {
+                           bool use;
+                           if (inner)
+                             use = inner->Test(i);
+                           else if (cluster)
+                             use = (*cluster)[i] != 0;
+                           else
+                             use = order[i] != -1;
+                           if (!use) fy(i) = TVX(0.0);
+                         });
+          }
+      }
+    else
+      SparseFactorization::MultMulti (x, y);
+  }
+
+  
+
+
+
   SparseFactorization ::     
   SparseFactorization (const BaseSparseMatrix & amatrix,
 		       shared_ptr<BitArray> ainner,
@@ -2064,6 +2810,17 @@ namespace ngla
     matrix.lock()->MultAdd2 (-1, hvec2, y, inner.get(), cluster.get());
     }
   }
+
+
+  void SparseFactorization  :: 
+  MultMulti (FlatArray<shared_ptr<BaseVector>> x,
+             FlatArray<shared_ptr<BaseVector>> y) const
+  {
+    if (x.Size() != y.Size())
+      throw Exception ("SparseFactorization::MultMulti: number of vectors don't match");
+    for (size_t i = 0; i < x.Size(); i++)
+      Mult (*x[i], *y[i]);
+  }
   
 
 
@@ -2175,7 +2932,7 @@ namespace ngla
 	for ( ; j < firstinrow[i]; j++, j_ri++)
 	  {
 	    ost << rowindex2[j_ri] << "("
-		<< lfact[j] 
+		<< (single ? TM(lfact_single[j]) : lfact[j])
 		<< ")  ";
 	  }
 	ost << endl;
@@ -31,6 +31,17 @@ namespace ngla
 
     virtual void Smooth (BaseVector & u, const BaseVector & f, BaseVector & y) const;
 
+    /// y[i] = A^{-1} x[i] for a set of right-hand sides.
+    /// The default calls Mult for every vector, factorizations with a
+    /// block-solve go through the factor only once.
+    virtual void MultMulti (FlatArray<shared_ptr<BaseVector>> x,
+                            FlatArray<shared_ptr<BaseVector>> y) const;
+
+    using BaseMatrix::Mult;
+    /// forwards to MultMulti
+    virtual void Mult (const MultiVector & x, MultiVector & y) const override
+    { MultMulti (x.Vectors(), y.Vectors()); }
+
     int VHeight() const { return matrix.lock()->VWidth();}
     int VWidth() const { return matrix.lock()->VHeight();}
 
@@ -47,10 +58,18 @@ namespace ngla
 
 
 
+  // entry type of a factor stored in single precision
+  template <typename TM> struct SinglePrecision { typedef TM TYPE; };
+  template <> struct SinglePrecision<double> { typedef float TYPE; };
+  template <> struct SinglePrecision<Complex> { typedef complex<float> TYPE; };
+
+
   /**
      A sparse cholesky factorization.
      The unknowns are reordered by the minimum degree
-     ordering algorithm
+     ordering algorithm, or by nested dissection.
+     The factorization is either right-looking with scattered
+     updates, or left-looking supernodal with dense panel updates.
 
      computs A = L D L^t
      L is stored column-wise
@@ -61,7 +80,47 @@ namespace ngla
 	   // class TV_COL = typename mat_traits<TM>::TV_COL>
   class NGS_DLL_HEADER SparseCholeskyTM : public SparseFactorization
   {
+  public:      // needed for gcc 4.9, why  ??? 
+    class MicroTask
+    {
+    public:
+      int blocknr;
+      enum BT { L_BLOCK, B_BLOCK, LB_BLOCK };
+      BT type;
+      int bblock;
+      int nbblocks;
+    };
+
+    /*
+      The symbolic factorization: ordering, structure of L, supernodes and
+      task graphs. It depends only on the matrix graph, the used dofs, and
+      the ordering type, and is shared by all factorizations of matrices
+      with the same graph.
+    */
+    class Analysis
+    {
+    public:
+      bool complete = false;  // set when the symbolic factorization is done
+      size_t graph_timestamp;
+      ORDERINGTYPE ordering;
+      shared_ptr<BitArray> inner;
+      shared_ptr<Array<int>> cluster;
+      double time;         // time needed to compute it
+
+      int nused;
+      size_t nze;
+      int maxrow;
+      Array<int> order, inv_order, blocknrs, rowindex2, blocks;
+      Array<size_t> firstinrow, firstinrow_ri;
+      Table<int> block_dependency;
+      Array<MicroTask> microtasks;
+      Table<int> micro_dependency, micro_dependency_trans;
+    };
+
   protected:
+    // the symbolic factorization, the arrays below refer to it
+    shared_ptr<Analysis> analysis;
+
     // height of the matrix
     int height;
     // number of real unknowns
@@ -70,15 +129,19 @@ namespace ngla
     size_t nze;
 
     // the reordering (original dofnr i -> order[i])
-    Array<int> order;
-    Array<int> inv_order;
+    Array<int> & order = analysis->order;
+    Array<int> & inv_order = analysis->inv_order;
     
     // L-factor in compressed storage
     // Array<TM, size_t> lfact;
     NumaInterleavedArray<TM> lfact;
 
+    // L-factor in single precision, lfact is released after factorization
+    typedef typename SinglePrecision<TM>::TYPE TSINGLE;
+    NumaInterleavedArray<TSINGLE> lfact_single;
+
     // index-array to lfact
-    Array<size_t> firstinrow;
+    Array<size_t> & firstinrow = analysis->firstinrow;
 
     // diagonal 
     Array<TM> diag;
@@ -86,39 +149,39 @@ namespace ngla
 
     // row-indices of non-zero entries
     // all row-indices within one block are identic, and stored just once
-    Array<int> rowindex2;
+    Array<int> & rowindex2 = analysis->rowindex2;
     // index-array to rowindex
-    Array<size_t> firstinrow_ri;
+    Array<size_t> & firstinrow_ri = analysis->firstinrow_ri;
     
     // blocknr of dof
-    Array<int> blocknrs;
+    Array<int> & blocknrs = analysis->blocknrs;
 
     // block i has dofs  [blocks[i], blocks[i+1])
-    Array<int> blocks; 
+    Array<int> & blocks = analysis->blocks;
 
     // dependency graph for elimination
-    Table<int> block_dependency; 
+    Table<int> & block_dependency = analysis->block_dependency;
 
-  public:      // needed for gcc 4.9, why  ??? 
-    class MicroTask
-    {
-    public:
-      int blocknr;
-      enum BT { L_BLOCK, B_BLOCK, LB_BLOCK };
-      BT type;
-      int bblock;
-      int nbblocks;
-    };
-  protected:
-    
-    Array<MicroTask> microtasks;
-    Table<int> micro_dependency;     
-    Table<int> micro_dependency_trans;     
+    Array<MicroTask> & microtasks = analysis->microtasks;
+    Table<int> & micro_dependency = analysis->micro_dependency;
+    Table<int> & micro_dependency_trans = analysis->micro_dependency_trans;
 
 
     //
     MinimumDegreeOrdering * mdo;
 
+    // fill-reducing ordering used
+    ORDERINGTYPE ordering;
+
+    // left-looking supernodal factorization with dense panel updates
+    bool supernodal;
+
+    // store L in single precision (only for double and Complex)
+    bool single;
+    // with single precision, the solve refines with the original matrix,
+    // so we keep it alive as long as the factorization
+    shared_ptr<BaseSparseMatrix> refinement_matrix;
+
     // maximal non-zero entries in a column
     int maxrow;
 
@@ -132,7 +195,10 @@ namespace ngla
     SparseCholeskyTM (const SparseMatrixTM<TM> & a, 
                                      shared_ptr<BitArray> ainner = nullptr,
                                      shared_ptr<const Array<int>> acluster = nullptr,
-                                     bool allow_refactor = 0);
+                                     bool allow_refactor = 0,
+                                     ORDERINGTYPE aordering = MINIMUM_DEGREE_ORDERING,
+                                     bool asupernodal = false,
+                                     bool asingle = false);
     ///
     virtual ~SparseCholeskyTM ();
     ///
@@ -143,6 +209,14 @@ namespace ngla
     void Allocate (const Array<int> & aorder, 
 		   const Array<MDOVertex> & vertices,
 		   const int * blocknr);
+    /// ordering and symbolic factorization
+    void Analyse (const SparseMatrixTM<TM> & a);
+    /// the analysis of a matrix with the same graph if available, else an empty one
+    shared_ptr<Analysis> FindAnalysis (const SparseMatrixTM<TM> & a,
+                                       ORDERINGTYPE aordering) const;
+    ///
+    void OrderMinimumDegree (const SparseMatrixTM<TM> & a);
+    void OrderNestedDissection (const SparseMatrixTM<TM> & a);
     ///
     void Factor (); 
 #ifdef LAPACK
@@ -150,6 +224,12 @@ namespace ngla
     template <typename T>
     void FactorSPD1 (T dummy); 
 #endif
+    /// supernodal factorization, falls back to FactorSPD for block-matrices
+    void FactorSupernodal ();
+    template <typename T>
+    void FactorSupernodal1 (T dummy);
+    /// converts lfact to lfact_single, and releases lfact
+    void StoreSinglePrecision ();
 
     virtual bool SupportsUpdate() const { return true; }     
     virtual void Update()
@@ -174,7 +254,7 @@ namespace ngla
 
     virtual Array<MemoryUsage> GetMemoryUsage () const
     {
-      return { MemoryUsage ("SparseChol", nze*sizeof(TM), 1) };
+      return { MemoryUsage ("SparseChol", nze*(single ? sizeof(TSINGLE) : sizeof(TM)), 1) };
     }
 
     virtual size_t NZE () const { return nze; }
@@ -216,10 +296,15 @@ namespace ngla
     using BASE::cluster;
 
     using BASE::lfact;
+    using BASE::lfact_single;
+    using BASE::single;
+    using BASE::refinement_matrix;
     using BASE::diag;
     using BASE::order;
     using BASE::inv_order;
     using BASE::firstinrow;
+    using BASE::firstinrow_ri;
+    using BASE::rowindex2;
 
     using BASE::blocks;
     using typename BASE::MicroTask;
@@ -238,8 +323,11 @@ namespace ngla
     SparseCholesky (const SparseMatrixTM<TM> & a, 
 		    shared_ptr<BitArray> ainner = nullptr,
 		    shared_ptr<const Array<int>> acluster = nullptr,
-		    bool allow_refactor = 0)
-      : SparseCholeskyTM<TM> (a, ainner, acluster, allow_refactor) { ; }
+		    bool allow_refactor = 0,
+		    ORDERINGTYPE aordering = MINIMUM_DEGREE_ORDERING,
+		    bool asupernodal = false,
+		    bool asingle = false)
+      : SparseCholeskyTM<TM> (a, ainner, acluster, allow_refactor, aordering, asupernodal, asingle) { ; }
 
     ///
     virtual ~SparseCholesky () { ; }
@@ -257,10 +345,21 @@ namespace ngla
 
     void Smooth (BaseVector & u, const BaseVector & f, BaseVector & y) const override;
 
+    void MultMulti (FlatArray<shared_ptr<BaseVector>> x,
+                    FlatArray<shared_ptr<BaseVector>> y) const override;
+
     void SolveBlock (int i, FlatVector<TV> hy) const;
     void SolveBlockT (int i, FlatVector<TV> hy) const;
   private:
     void SolveReordered(FlatVector<TVX> hy) const;
+    // TF is the stored entry type of L, TM or TSINGLE
+    template <typename TF>
+    void SolveReordered1 (FlatVector<TVX> hy, TF * hlfact) const;
+    // solve followed by iterative refinement with the original matrix
+    void SolveRefined (FlatVector<TVX> fx, FlatVector<TVX> hx) const;
+    // one column per right-hand side, scalar types only
+    template <typename T, typename TF>
+    void SolveReorderedMulti (SliceMatrix<T,ColMajor> hy, TF * hlfact) const;
   };
 
 
@@ -39,11 +39,14 @@ namespace ngla
   }  
   
 
+  static atomic<size_t> graph_timestamp(0);
+  
   MatrixGraph :: MatrixGraph (const Array<int> & elsperrow, int awidth)
   {
     size = elsperrow.Size();
     width = awidth;
     owner = true;
+    timestamp = ++graph_timestamp;
 
     firsti.SetSize (size+1);
     nze = 0;
@@ -84,6 +87,7 @@ namespace ngla
     colnr = NumaDistributedArray<int> (as*max_elsperrow+1);
     firsti.SetSize (as+1);
     owner = true;
+    timestamp = ++graph_timestamp;
     
     for (int i = 0; i < as*max_elsperrow; i++)
       colnr[i] = -1;
@@ -103,15 +107,25 @@ namespace ngla
     size = graph.size;
     width = graph.width;
     nze = graph.nze;
-    owner = false;
+    // stolen arrays belong to this graph, and count for its memory usage
+    owner = stealgraph;
+    timestamp = graph.timestamp;
+
+    compressed_timestamp = graph.compressed_timestamp;
 
     if (stealgraph)
       {
 	firsti.Swap (graph.firsti);
 	colnr.Swap (graph.colnr);
+        basecol.Swap (graph.basecol);
+        coldelta.Swap (graph.coldelta);
+        widecolnr.Swap (graph.widecolnr);
+        widefirst.Swap (graph.widefirst);
+        colnr_released = graph.colnr_released.exchange(false);
       }
     else
       {
+        graph.EnsureColumnIndices();
 	firsti.SetSize (size+1);
 	// colnr.SetSize (nze);
         colnr = NumaDistributedArray<int> (nze);
@@ -120,6 +134,10 @@ namespace ngla
 	  firsti[i] = graph.firsti[i];
 	for (size_t i = 0; i < nze; i++)
 	  colnr[i] = graph.colnr[i];
+        basecol = graph.basecol;
+        coldelta = graph.coldelta;
+        widecolnr = graph.widecolnr;
+        widefirst = graph.widefirst;
       }
     // inversetype = agraph.GetInverseType();
     CalcBalancing ();
@@ -134,8 +152,15 @@ namespace ngla
     width = move(graph.width);
     nze = move(graph.nze);
     owner = true;
+    timestamp = graph.timestamp;
+    compressed_timestamp = graph.compressed_timestamp;
     firsti.Swap (graph.firsti);
     colnr.Swap (graph.colnr);
+    basecol.Swap (graph.basecol);
+    coldelta.Swap (graph.coldelta);
+    widecolnr.Swap (graph.widecolnr);
+    widefirst.Swap (graph.widefirst);
+    colnr_released = graph.colnr_released.exchange(false);
     CalcBalancing ();
   }
 
@@ -836,6 +861,7 @@ namespace ngla
             size = ndof;
             width = awidth;
             owner = true;
+            timestamp = ++graph_timestamp;
             
             firsti.SetSize (size+1);
             /*
@@ -1009,11 +1035,104 @@ namespace ngla
   {
     cout << "compress not implemented" << endl; 
   }
+
+
+  void MatrixGraph :: CompressColumnIndices()
+  {
+    static Timer timer ("MatrixGraph - CompressColumnIndices");
+    RegionTimer reg (timer);
+
+    if (!HasCompressedColumnIndices())
+      {
+        EnsureColumnIndices();
+        basecol.SetSize (size);
+        coldelta.SetSize (nze);
+    
+        ParallelFor (size, [&] (size_t i)
+                     {
+                       auto cols = GetRowIndices(i);
+                       basecol[i] = -1;
+                       if (cols.Size() == 0)
+                         {
+                           basecol[i] = 0;
+                           return;
+                         }
+
+                       // rows are sorted, unused positions (-1) at the end
+                       int minc = cols[0], maxc = cols[cols.Size()-1];
+                       if (minc < 0 || maxc < minc ||
+                           maxc-minc > numeric_limits<uint16_t>::max())
+                         return;  // keep 32-bit indices of this row
+                   
+                       basecol[i] = minc;
+                       for (size_t j = 0; j < cols.Size(); j++)
+                         coldelta[firsti[i]+j] = cols[j]-minc;
+                     });
+
+        // rows kept in 32 bit are copied to widecolnr
+        widefirst.SetSize0();
+        size_t nwide = 0;
+        for (int i = 0; i < size; i++)
+          if (basecol[i] < 0)
+            {
+              basecol[i] = -1-int(widefirst.Size());
+              widefirst.Append (nwide);
+              nwide += firsti[i+1]-firsti[i];
+            }
+        widecolnr.SetSize (nwide);
+        ParallelFor (size, [&] (size_t i)
+                     {
+                       if (basecol[i] >= 0) return;
+                       auto cols = GetRowIndices(i);
+                       size_t first = widefirst[-basecol[i]-1];
+                       for (size_t j = 0; j < cols.Size(); j++)
+                         widecolnr[first+j] = cols[j];
+                     });
+        compressed_timestamp = timestamp;
+      }
+
+    // MultAdd only reads the compressed indices. Other users, like
+    // smoothers, factorizations, or the assembling, rebuild colnr.
+    colnr = NumaDistributedArray<int> ();
+    colnr_released = true;
+  }
+
+
+  void MatrixGraph :: ExpandColumnIndices() const
+  {
+    static mutex expand_mutex;
+    lock_guard<mutex> guard(expand_mutex);
+    if (!colnr_released) return;
+
+    static Timer timer ("MatrixGraph - ExpandColumnIndices");
+    RegionTimer reg (timer);
+
+    // may be called from within a parallel loop, so we stay sequential
+    colnr = NumaDistributedArray<int> (nze+1);
+    colnr[nze] = 0;
+    for (int i = 0; i < size; i++)
+      {
+        size_t first = firsti[i];
+        size_t last = firsti[i+1];
+        int base = basecol[i];
+        if (base < 0)
+          {
+            const int * pcol = WideRowIndices(i);
+            for (size_t j = first; j < last; j++)
+              colnr[j] = pcol[j-first];
+          }
+        else
+          for (size_t j = first; j < last; j++)
+            colnr[j] = base+coldelta[j];
+      }
+    colnr_released.store(false, memory_order_release);
+  }
   
 
   /// returns position of Element (i, j), exception for unused
   size_t MatrixGraph :: GetPosition (int i, int j) const
   {
+    EnsureColumnIndices();
     /*
       for (int k = firsti[i]; k < firsti[i+1]; k++)
       if (colnr[k] == j) return k;
@@ -1044,6 +1163,7 @@ namespace ngla
   /// returns position of Element (i, j), -1 for unused
   size_t MatrixGraph :: GetPositionTest (int i, int j) const
   {
+    EnsureColumnIndices();
     /*
       for (int k = firsti[i]; k < firsti[i+1]; k++)
       if (colnr[k] == j) return k;
@@ -1071,6 +1191,7 @@ namespace ngla
   
   size_t MatrixGraph :: CreatePosition (int i, int j)
   {
+    EnsureColumnIndices();
     size_t first = firsti[i]; 
     size_t last = firsti[i+1];
     /*
@@ -1100,6 +1221,7 @@ namespace ngla
 	if (colnr[k] == -1)
 	  {
 	    colnr[k] = j;
+            timestamp = ++graph_timestamp;
 	    return k;
 	  }
 	
@@ -1114,6 +1236,7 @@ namespace ngla
 	      colnr[l] = colnr[l-1];
 
 	    colnr[k] = j;
+            timestamp = ++graph_timestamp;
 	    return k;
 	  }
       }
@@ -1151,6 +1274,7 @@ namespace ngla
   void MatrixGraph :: 
   GetPositionsSorted (int row, int n, int * pos) const
   {
+    EnsureColumnIndices();
     if (n == 1)
       {
 	pos[0] = GetPosition (row, pos[0]);
@@ -1201,7 +1325,7 @@ namespace ngla
     static Timer timer ("MatrixGraph - CalcBalancing");
     RegionTimer reg (timer);
 
-    balance.Calc (size, [&] (int row) { return 1 + GetRowIndices(row).Size(); });
+    balance.Calc (size, [&] (int row) { return 1 + firsti[row+1]-firsti[row]; });
   }
   
   void MatrixGraph :: FindSameNZE()
@@ -1227,6 +1351,7 @@ namespace ngla
   
   ostream & MatrixGraph :: Print (ostream & ost) const
   {
+    EnsureColumnIndices();
     for (int i = 0; i < size; i++)
       {
 	ost << "Row " << i << ":";
@@ -1241,7 +1366,13 @@ namespace ngla
 
   Array<MemoryUsage> MatrixGraph :: GetMemoryUsage () const
   {
-    return { { "MatrixGraph", (nze+size)*sizeof(int), 1 } };
+    Array<MemoryUsage> mu;
+    mu += { "MatrixGraph", (colnr.Size()+size)*sizeof(int), 1 };
+    if (HasCompressedColumnIndices())
+      mu += { "MatrixGraph compressed",
+              (size+widecolnr.Size())*sizeof(int) + widefirst.Size()*sizeof(size_t)
+              + nze*sizeof(uint16_t), 1 };
+    return mu;
   }
 
 
@@ -1270,10 +1401,13 @@ namespace ngla
     else if (ainversetype == "masterinverse") SetInverseType ( MASTERINVERSE );
     else if (ainversetype == "sparsecholesky") SetInverseType ( SPARSECHOLESKY );
     else if (ainversetype == "umfpack")       SetInverseType ( UMFPACK );
+    else if (ainversetype == "sparsecholesky_nd") SetInverseType ( SPARSECHOLESKY_ND );
+    else if (ainversetype == "sparsecholesky_supernodal") SetInverseType ( SPARSECHOLESKY_SUPERNODAL );
+    else if (ainversetype == "sparsecholesky_single") SetInverseType ( SPARSECHOLESKY_SINGLE );
     else
       {
         throw Exception (ToString("undefined inverse ")+ainversetype+
-                         "\nallowed is: 'sparsecholesky', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'umfpack'");
+                         "\nallowed is: 'sparsecholesky', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'umfpack', 'sparsecholesky_nd', 'sparsecholesky_supernodal', 'sparsecholesky_single'");
       }
     return old_invtype;
   }
@@ -1535,335 +1669,24 @@ namespace ngla
   shared_ptr<BaseSparseMatrix>
   SparseMatrixSymmetric<TM,TV> :: Restrict (const SparseMatrixTM<double> & prol,
 					    shared_ptr<BaseSparseMatrix> acmat ) const
-  {
-    static Timer t ("sparsematrix - restrict");
-    static Timer tbuild ("sparsematrix - restrict, build matrix");
-    static Timer tcomp ("sparsematrix - restrict, compute matrix");
-    RegionTimer reg(t);
-    
-    int n = this->Height();
-
-    auto cmat = dynamic_pointer_cast<SparseMatrixSymmetric<TM,TV>>(acmat);
- 
-    // if no coarse matrix, build up matrix-graph!
-    if ( !cmat )
-      {
-        RegionTimer reg(tbuild);
-
-	Array<int> marks(n);
-	Array<INT<2> > e2v;
-	for (int i = 0; i < n; i++)
-	  for (int j = 0; j < this->GetRowIndices(i).Size(); j++)
-	    {
-	      int col = this->GetRowIndices(i)[j];
-	      FlatArray<int> prol_rowind = prol.GetRowIndices(i);
-	      FlatArray<int> prol_colind = prol.GetRowIndices(col);
-
-	      for (int k = 0; k < prol_rowind.Size(); k++)
-		for (int l = 0; l < prol_colind.Size(); l++)
-		  {
-		    int kk = prol_rowind[k];
-		    int ll = prol_colind[l];
-		    
-		    if (kk >= ll) swap (kk,ll);
-		    e2v.Append (INT<2> (kk,ll));
-		  }
-	    }
-
-	int nc = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  nc = max2 (nc, e2v[i][1]);
-	nc++;
-
-	// *testout << "e2v = " << endl << e2v << endl;
-        
-        // count all entries in row with multiplicity
-	Array<int> cnt(nc);
-	cnt = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  cnt[e2v[i][1]]++;
-
-	Table<int> v2e(cnt);
-	cnt = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  {
-	    int v1 = e2v[i][1];
-	    v2e[v1][cnt[v1]++] = i;
-	  }
-	
-	cnt = 0;
-	marks = -1;
-
-        // count all entries in row withOUT multiplicity
-	for (int i = 0; i < nc; i++)
-	  for (int j = 0; j < v2e[i].Size(); j++)
-	    {
-	      int jj = v2e[i][j];
-	      int v0 = e2v[jj][0];
-	      if (marks[v0] != i) 
-		{
-		  cnt[i]++;
-		  marks[v0] = i;
-		}
-	    }
-
-	cmat = make_shared<SparseMatrixSymmetric<TM,TV>> (cnt);
-
-	marks = -1;
-	for (int i = 0; i < nc; i++)
-	  for (int j = 0; j < v2e[i].Size(); j++)
-	    {
-	      int jj = v2e[i][j];
-	      int v0 = e2v[jj][0];
-	      if (marks[v0] != i) 
-		{
-		  marks[v0] = i;
-		  cmat -> CreatePosition (i, v0);
-		}
-	    }
-      }
-
-    *cmat = 0.;
-    RegionTimer reg2(tcomp);
-	  
-    for (int i = 0; i < n; i++)
-      {
-        FlatArray<int> mat_ri = this->GetRowIndices(i);
-        FlatVector<TM> mat_rval = this->GetRowValues(i);
-
-        for (int j = 0; j < mat_ri.Size(); j++)
-          {
-            int col = mat_ri[j];
-            TM mat_val = mat_rval[j]; 
-
-            FlatArray<int> prol_ri_i = prol.GetRowIndices(i);
-            FlatArray<int> prol_ri_col = prol.GetRowIndices(col);
-            FlatVector<double> prol_rval_i = prol.GetRowValues(i);
-            FlatVector<double> prol_rval_col = prol.GetRowValues(col);
-
-            for (int k = 0; k < prol_ri_i.Size(); k++)
-              for (int l = 0; l < prol_ri_col.Size(); l++)
-                {
-                  int kk = prol_ri_i[k];
-                  int ll = prol_ri_col[l];
-                  
-                  if ( kk>=ll && kk < cmat->Height() )
-                    {
-                      (*cmat)(kk,ll) += 
-                        prol_rval_i[k] * prol_rval_col[l] * mat_val; 
-                    }
-                  
-                  if (ll >= kk && i != col && ll < cmat->Height() )
-                    {
-                      (*cmat)(ll,kk) += 
-                        prol_rval_col[l] * prol_rval_i[k] * Trans(mat_val); 
-                    }
-                  
-                }
-          }
-      }
-    return cmat;
-  }
-  
-
-
-
-  template <> shared_ptr<BaseSparseMatrix>
-  SparseMatrix<double> :: Restrict (const SparseMatrixTM<double> & prol,
-                                    shared_ptr<BaseSparseMatrix> acmat ) const
-  {
-    static Timer t ("sparsematrix - restrict");
-    RegionTimer reg(t);
-
-    auto prolT = TransposeMatrix(prol);
-
-    auto prod1 = MatMult<double, double, double>(*this, prol);
-    auto prod = MatMult<double, double, double>(*prolT, *prod1);
-    return prod;
-  }
-
-  template <> shared_ptr<BaseSparseMatrix>
-  SparseMatrix<std::complex<double>> :: Restrict (const SparseMatrixTM<double> & prol,
-                                                  shared_ptr<BaseSparseMatrix> acmat ) const
-  {
-    static Timer t ("sparsematrix - restrict");
-    RegionTimer reg(t);
-    // new version
-    auto prolT = TransposeMatrix(prol);
-
-    auto prod1 = MatMult<std::complex<double>, std::complex<double>, double>(*this, prol);
-    auto prod = MatMult<std::complex<double>, double, std::complex<double>>(*prolT, *prod1);
-    return prod;
-  }
-
-
-
-
-
-  template <> shared_ptr<BaseSparseMatrix>
-  SparseMatrixSymmetric<double,double> :: Restrict (const SparseMatrixTM<double> & prol,
-                                                    shared_ptr<BaseSparseMatrix> acmat ) const
   {
     static Timer t ("sparsematrixsymmetric - restrict");
     RegionTimer reg(t);
-    // new version
-    auto prolT = TransposeMatrix(prol);
-    auto full = MakeFullMatrix(*this);
-
-    auto prod1 = MatMult<double, double, double>(*full, prol);
-    auto prod = MatMult<double, double, double>(*prolT, *prod1);
-
-    auto prodhalf = GetSymmetricMatrix (*prod);
-    return prodhalf;
-
-
-#ifdef OLD
-
-    static Timer t ("sparsematrix - restrict");
-    static Timer tbuild ("sparsematrix - restrict, build matrix");
-    static Timer tbuild1 ("sparsematrix - restrict, build matrix1");
-    static Timer tbuild2 ("sparsematrix - restrict, build matrix2");
-    static Timer tbuild3 ("sparsematrix - restrict, build matrix3");
-    static Timer tbuild4 ("sparsematrix - restrict, build matrix4");
-    static Timer tcomp ("sparsematrix - restrict, compute matrix");
-    RegionTimer reg(t);
-    
-    int n = this->Height();
 
-    SparseMatrixSymmetric<double,double>* cmat = 
-      dynamic_cast< SparseMatrixSymmetric<double,double>* > ( acmat );
- 
-    // if no coarse matrix, build up matrix-graph!
-    if ( !cmat )
-      {
-        RegionTimer reg(tbuild);
-        tbuild1.Start();
-	Array<INT<2> > e2v;
-	for (int i = 0; i < n; i++)
-	  for (int j = 0; j < this->GetRowIndices(i).Size(); j++)
-	    {
-	      int col = this->GetRowIndices(i)[j];
+    if (!this->galerkin || !this->galerkin->IsSymmetric())
+      this->galerkin = make_shared<GalerkinProduct<TM>> (true);
+    GalerkinProduct<TM> & rap = *this->galerkin;
+    rap.Setup (*this, prol);
 
-	      for (int kk : prol.GetRowIndices(i))
-		for (int ll : prol.GetRowIndices(col))
-		  {
-                    /*
-		    if (kk >= ll) swap (kk,ll);
-		    e2v.Append (INT<2> (kk,ll));
-                    */
-                    INT<2> i2 = (kk<ll) ? INT<2>(kk,ll) : INT<2>(ll,kk);
-                    e2v.Append (i2);
-		  }
-	    }
-
-	int nc = 0;
-        for (auto vpair : e2v)
-          nc = max2 (nc, vpair[1]);
-	nc++;
-
-        tbuild1.Stop();
-        tbuild2.Start();
-
-        // count all entries in row with multiplicity
-	Array<int> cnt(nc);
-	cnt = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  cnt[e2v[i][1]]++;
-
-	Table<int> v2e(cnt);
-	cnt = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  {
-	    int v1 = e2v[i][1];
-	    v2e[v1][cnt[v1]++] = i;
-	  }
-
-        tbuild2.Stop();
-        tbuild3.Start();
-	
-	cnt = 0;
-	Array<int> marks(n);
-	marks = -1;
-
-        // count all entries in row withOUT multiplicity
-	for (int i = 0; i < nc; i++)
-	  for (int j = 0; j < v2e[i].Size(); j++)
-	    {
-	      int jj = v2e[i][j];
-	      int v0 = e2v[jj][0];
-	      if (marks[v0] != i) 
-		{
-		  cnt[i]++;
-		  marks[v0] = i;
-		}
-	    }
-
-        tbuild3.Stop();
-        tbuild4.Start();
-
-	cmat = new SparseMatrixSymmetric<double,double> (cnt);
-
-	marks = -1;
-	for (int i = 0; i < nc; i++)
-	  for (int j = 0; j < v2e[i].Size(); j++)
-	    {
-	      int jj = v2e[i][j];
-	      int v0 = e2v[jj][0];
-	      if (marks[v0] != i) 
-		{
-		  marks[v0] = i;
-		  cmat -> CreatePosition (i, v0);
-		}
-	    }
-
-        tbuild4.Stop();
-      }
-
-    *cmat = 0.;
-    RegionTimer reg2(tcomp);
-
-    // #pragma omp parallel for	  
-    for (int i = 0; i < n; i++)
+    // reuse the graph of a given coarse matrix, only values are recomputed
+    auto cmat = dynamic_pointer_cast<SparseMatrixSymmetric<TM,TV>>(acmat);
+    if (!cmat)
       {
-        FlatArray<int> mat_ri = this->GetRowIndices(i);
-        FlatVector<double> mat_rval = this->GetRowValues(i);
-
-        for (int j = 0; j < mat_ri.Size(); j++)
-          {
-            int col = mat_ri[j];
-            double mat_val = mat_rval[j]; 
-
-            FlatArray<int> prol_rowind = prol.GetRowIndices(i);
-            FlatArray<int> prol_colind = prol.GetRowIndices(col);
-            FlatVector<double> prol_rowval = prol.GetRowValues(i);
-            FlatVector<double> prol_colval = prol.GetRowValues(col);
-
-            for (int k = 0; k < prol_rowind.Size(); k++)
-              for (int l = 0; l < prol_colind.Size(); l++)
-                {
-                  int kk = prol_rowind[k];
-                  int ll = prol_colind[l];
-                  
-                  if ( kk>=ll && kk < cmat->Height() )
-                    {
-                      auto val = prol_rowval[k] * prol_colval[l] * mat_val;
-                      // #pragma omp atomic                      
-                      (*cmat)(kk,ll) += val;
-                    }
-                  
-                  if (ll >= kk && i != col && ll < cmat->Height() )
-                    {
-                      auto val = prol_colval[l] * prol_rowval[k] * Trans(mat_val);
-                      // #pragma omp atomic                      
-                      (*cmat)(ll,kk) += val;
-                    }
-                  
-                }
-          }
+        cmat = make_shared<SparseMatrixSymmetric<TM,TV>> (rap.RowSizes());
+        rap.Graph (*cmat);
       }
+    rap.Compute (*cmat);
     return cmat;
-#endif
-
   }
 
 
@@ -1911,6 +1734,12 @@ namespace ngla
 	throw Exception ("SparseMatrix::InverseMatrix:  MumpsInverse not available");
 #endif
       }
+    else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_ND )
+      return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset, nullptr, false, NESTED_DISSECTION_ORDERING);
+    else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SUPERNODAL )
+      return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset, nullptr, false, NESTED_DISSECTION_ORDERING, true);
+    else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SINGLE )
+      return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset, nullptr, false, NESTED_DISSECTION_ORDERING, true, true);
     else
       return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset);
   }
@@ -1952,6 +1781,12 @@ namespace ngla
 	throw Exception ("SparseMatrix::InverseMatrix:  MumpsInverse not available");
 #endif
       }
+    else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_ND )
+      return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters, false, NESTED_DISSECTION_ORDERING);
+    else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SUPERNODAL )
+      return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters, false, NESTED_DISSECTION_ORDERING, true);
+    else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SINGLE )
+      return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters, false, NESTED_DISSECTION_ORDERING, true, true);
     else
       return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters);
   }
@@ -27,6 +27,9 @@ namespace ngla
 
 
 
+  template <class TM>
+  class GalerkinProduct;
+
   class BaseJacobiPrecond;
 
   template<class TM, 
@@ -83,9 +86,9 @@ namespace ngla
     /// non-zero elements
     size_t nze; 
 
-    /// column numbers
+    /// column numbers, released while compressed indices are used
     // Array<int, size_t> colnr;
-    NumaDistributedArray<int> colnr;
+    mutable NumaDistributedArray<int> colnr;
 
     /// pointer to first in row
     Array<size_t> firsti;
@@ -99,6 +102,23 @@ namespace ngla
     /// owner of arrays ?
     bool owner;
 
+    /// new timestamp whenever the sparsity pattern is created or changed
+    size_t timestamp;
+
+    /// first column of every row for delta-compressed rows,
+    /// -1-k for the k-th row kept in 32 bit
+    Array<int> basecol;
+    /// column offsets to basecol, at the same positions as colnr
+    Array<uint16_t> coldelta;
+    /// column numbers of the rows kept in 32 bit
+    Array<int> widecolnr;
+    /// k-th row kept in 32 bit starts at widecolnr[widefirst[k]]
+    Array<size_t> widefirst;
+    /// timestamp of the graph the compressed indices were built for
+    size_t compressed_timestamp = 0;
+    /// colnr is released, it is rebuilt from the compressed indices on demand
+    mutable atomic<bool> colnr_released{false};
+
   public:
     /// arbitrary number of els/row
     MatrixGraph (const Array<int> & elsperrow, int awidth);
@@ -134,11 +154,31 @@ namespace ngla
 
     size_t NZE() const { return nze; }
 
+    /// equal timestamps imply the same sparsity pattern
+    size_t GetTimeStamp() const { return timestamp; }
+
+    /// stores 16-bit column offsets for all rows spanning less than 2^16 columns,
+    /// and releases the 32-bit column numbers
+    void CompressColumnIndices();
+    /// compressed indices are valid as long as the pattern is unchanged
+    bool HasCompressedColumnIndices() const
+    { return basecol.Size() && compressed_timestamp == timestamp; }
+    /// rebuilds the 32-bit column numbers, if they have been released
+    void EnsureColumnIndices() const
+    { if (colnr_released.load(memory_order_acquire)) ExpandColumnIndices(); }
+    void ExpandColumnIndices() const;
+    /// column numbers of a row kept in 32 bit by the compression
+    const int * WideRowIndices (size_t i) const
+    { return widecolnr.Data() + widefirst[-basecol[i]-1]; }
+
     FlatArray<int> GetRowIndices(size_t i) const
       // { return FlatArray<int> (int(firsti[i+1]-firsti[i]), &colnr[firsti[i]]); }
       // { return FlatArray<int> (int(firsti[i+1]-firsti[i]), &colnr[firsti[i]]); }
       // { return FlatArray<int> (int(firsti[i+1]-firsti[i]), colnr+firsti[i]); }
-    { return FlatArray<int> (firsti[i+1]-firsti[i], colnr+firsti[i]); }      
+    {
+      EnsureColumnIndices();
+      return FlatArray<int> (firsti[i+1]-firsti[i], colnr+firsti[i]);
+    }
 
     size_t First (int i) const { return firsti[i]; }
     FlatArray<size_t> GetFirstArray () const  { return firsti; } 
@@ -241,6 +281,15 @@ namespace ngla
       throw Exception ("BaseSparseMatrix::Restrict");
     }
 
+    /// y += s A x, only the contributions of the stored entries in the given rows
+    virtual void MultAddRows (double s, const BaseVector & x, BaseVector & y,
+                              FlatArray<int> rows) const
+    {
+      throw Exception ("BaseSparseMatrix::MultAddRows");
+    }
+    /// MultAddRows is implemented
+    virtual bool HasMultAddRows () const { return false; }
+
     virtual INVERSETYPE SetInverseType ( INVERSETYPE ainversetype ) const override
     {
 
@@ -269,6 +318,8 @@ namespace ngla
     NumaDistributedArray<TM> data;
     VFlatVector<typename mat_traits<TM>::TSCAL> asvec;
     TM nul;
+    /// symbolic data of the Galerkin product P^T A P, reused by Restrict
+    mutable shared_ptr<GalerkinProduct<TM>> galerkin;
 
   public:
     typedef TM TENTRY;
@@ -398,6 +449,8 @@ namespace ngla
     using SparseMatrixTM<TM>::colnr;
     using SparseMatrixTM<TM>::data;
     using SparseMatrixTM<TM>::balance;
+    using SparseMatrixTM<TM>::basecol;
+    using SparseMatrixTM<TM>::coldelta;
 
 
     typedef typename mat_traits<TM>::TSCAL TSCAL;
@@ -471,6 +524,7 @@ namespace ngla
     ///
     inline TVY RowTimesVector (int row, const FlatVector<TVX> vec) const
     {
+      this->EnsureColumnIndices();
       typedef typename mat_traits<TVY>::TSCAL TTSCAL;
       TVY sum = TTSCAL(0);
       for (size_t j = firsti[row]; j < firsti[row+1]; j++)
@@ -478,9 +532,34 @@ namespace ngla
       return sum;
     }
 
+    ///
+    inline TVY RowTimesVectorCompressed (int row, const FlatVector<TVX> vec) const
+    {
+      typedef typename mat_traits<TVY>::TSCAL TTSCAL;
+      TVY sum = TTSCAL(0);
+      size_t first = firsti[row];
+      size_t last = firsti[row+1];
+      const TM * datap = data.Addr(0);
+
+      int base = basecol[row];
+      if (base < 0)
+        {
+          const int * pcol = this->WideRowIndices(row);
+          for (size_t j = first; j < last; j++)
+            sum += datap[j] * vec(pcol[j-first]);
+          return sum;
+        }
+
+      const uint16_t * pdelta = coldelta.Data();
+      for (size_t j = first; j < last; j++)
+	sum += datap[j] * vec(base+pdelta[j]);
+      return sum;
+    }
+
     ///
     void AddRowTransToVector (int row, TVY el, FlatVector<TVX> vec) const
     {
+      this->EnsureColumnIndices();
       size_t first = firsti[row];
       size_t last = firsti[row+1];
 
@@ -494,6 +573,7 @@ namespace ngla
     ///
     void AddRowConjTransToVector (int row, TVY el, FlatVector<TVX> vec) const
     {
+      this->EnsureColumnIndices();
       size_t first = firsti[row];
       size_t last = firsti[row+1];
 
@@ -505,7 +585,16 @@ namespace ngla
     }
 
 
+    using BaseMatrix::Mult;
+    virtual void Mult (const MultiVector & x, MultiVector & y) const override
+    {
+      y.SetScalar (0.0);
+      MultAdd (1, x, y);
+    }
+
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    /// traverses the matrix once for a block of vectors (scalar entries)
+    virtual void MultAdd (double s, const MultiVector & x, MultiVector & y) const override;
     virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
     virtual void MultAdd (Complex s, const BaseVector & x, BaseVector & y) const override;
     virtual void MultTransAdd (Complex s, const BaseVector & x, BaseVector & y) const override;
@@ -514,6 +603,10 @@ namespace ngla
     virtual void MultAdd1 (double s, const BaseVector & x, BaseVector & y,
 			   const BitArray * ainner = NULL,
 			   const Array<int> * acluster = NULL) const override;
+
+    virtual void MultAddRows (double s, const BaseVector & x, BaseVector & y,
+                              FlatArray<int> rows) const override;
+    virtual bool HasMultAddRows () const override { return true; }
     
     virtual void DoArchive (Archive & ar) override;
   };
@@ -560,6 +653,8 @@ namespace ngla
     using SparseMatrixTM<TM>::firsti;
     using SparseMatrixTM<TM>::colnr;
     using SparseMatrixTM<TM>::data;
+    using SparseMatrixTM<TM>::basecol;
+    using SparseMatrixTM<TM>::coldelta;
 
     typedef typename mat_traits<TM>::TSCAL TSCAL;
     typedef TV TV_COL;
@@ -665,6 +760,12 @@ namespace ngla
     ///
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
 
+    /// only the lower triangle is stored, go vector by vector
+    virtual void MultAdd (double s, const MultiVector & x, MultiVector & y) const override
+    {
+      BaseMatrix::MultAdd (s, x, y);
+    }
+
     virtual void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override
     {
       MultAdd (s, x, y);
@@ -685,6 +786,10 @@ namespace ngla
     virtual void MultAdd2 (double s, const BaseVector & x, BaseVector & y,
 			   const BitArray * ainner = NULL,
 			   const Array<int> * acluster = NULL) const override;
+
+    /// lower row and its transpose for every given row
+    virtual void MultAddRows (double s, const BaseVector & x, BaseVector & y,
+                              FlatArray<int> rows) const override;
     
 
 
@@ -692,10 +797,12 @@ namespace ngla
 
     using SparseMatrix<TM,TV,TV>::RowTimesVector;
     using SparseMatrix<TM,TV,TV>::AddRowTransToVector;
+    using SparseMatrix<TM,TV,TV>::RowTimesVectorCompressed;
 
 
     TV_COL RowTimesVectorNoDiag (int row, const FlatVector<TVX> vec) const
     {
+      this->EnsureColumnIndices();
       size_t last = firsti[row+1];
       size_t first = firsti[row];
       if (last == first) return TVY(0);
@@ -711,6 +818,7 @@ namespace ngla
 
     void AddRowTransToVectorNoDiag (int row, TVY el, FlatVector<TVX> vec) const
     {
+      this->EnsureColumnIndices();
       size_t first = firsti[row];
       size_t last = firsti[row+1];
 
@@ -720,6 +828,29 @@ namespace ngla
       for (size_t j = first; j < last; j++)
         vec[colnr[j]] += Trans(data[j]) * el;
     }
+
+    void AddRowTransToVectorNoDiagCompressed (int row, TVY el, FlatVector<TVX> vec) const
+    {
+      size_t first = firsti[row];
+      size_t last = firsti[row+1];
+      if (first == last) return;
+
+      int base = basecol[row];
+      if (base < 0)
+        {
+          const int * pcol = this->WideRowIndices(row);
+          if (pcol[last-1-first] == row) last--;
+          for (size_t j = first; j < last; j++)
+            vec[pcol[j-first]] += Trans(data[j]) * el;
+          return;
+        }
+
+      if (base+coldelta[last-1] == row) last--;
+
+      const uint16_t * pdelta = coldelta.Data();
+      for (size_t j = first; j < last; j++)
+        vec[base+pdelta[j]] += Trans(data[j]) * el;
+    }
   
     BaseSparseMatrix & AddMerge (double s, const SparseMatrixSymmetric  & m2);
 
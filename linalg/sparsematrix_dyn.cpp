@@ -185,4 +185,180 @@ namespace ngla
 
   template class SparseMatrixVariableBlocks<double>;  
 
+
+
+
+  template <typename TSCAL>
+  void SparseMatrixSELL<TSCAL> ::
+  Setup (const MatrixGraph & graph, FlatArray<TSCAL> bdata, size_t sigma)
+  {
+    static Timer t("SparseMatrixSELL - setup");
+    RegionTimer reg(t);
+
+    height = bheight*bh;
+    width = bwidth*bw;
+    size_t bs = bh*bw;
+    
+    // scalar entries of every row, with the upper part of symmetric matrices
+    TableCreator<int> creator_col(height);
+    TableCreator<TSCAL> creator_val(height);
+    for ( ; !creator_col.Done(); creator_col++, creator_val++)
+      for (size_t i = 0; i < bheight; i++)
+        {
+          auto cols = graph.GetRowIndices(i);
+          for (size_t j = 0; j < cols.Size(); j++)
+            {
+              int col = cols[j];
+              if (col < 0) continue;    // unused position
+              FlatMatrix<TSCAL> block(bh, bw, &bdata[(graph.First(i)+j)*bs]);
+              for (int k = 0; k < bh; k++)
+                for (int l = 0; l < bw; l++)
+                  {
+                    creator_col.Add (i*bh+k, col*bw+l);
+                    creator_val.Add (i*bh+k, block(k,l));
+                    if (symmetric && size_t(col) != i)
+                      {
+                        creator_col.Add (col*bh+l, i*bw+k);
+                        creator_val.Add (col*bh+l, block(k,l));
+                      }
+                  }
+            }
+        }
+    Table<int> rowcols = creator_col.MoveTable();
+    Table<TSCAL> rowvals = creator_val.MoveTable();
+
+    Array<int> rowlen(height);
+    nze = 0;
+    for (size_t i = 0; i < height; i++)
+      {
+        rowlen[i] = rowcols[i].Size();
+        nze += rowlen[i];
+      }
+
+    // sort by row length within windows of sigma rows
+    Array<int> sorted(height);
+    for (size_t i = 0; i < height; i++)
+      sorted[i] = i;
+    sigma = max(sigma, size_t(C));
+    for (size_t first = 0; first < height; first += sigma)
+      QuickSortI (rowlen, sorted.Range(first, min(first+sigma, height)));
+
+    nchunks = (height+C-1) / C;
+    rows.SetSize(nchunks*C);
+    rows = -1;
+    rows.Range(0, height) = sorted;
+
+    firsti.SetSize(nchunks+1);
+    firsti[0] = 0;
+    for (size_t c = 0; c < nchunks; c++)
+      {
+        int maxlen = 0;
+        for (int l = 0; l < C; l++)
+          if (rows[c*C+l] != -1)
+            maxlen = max(maxlen, rowlen[rows[c*C+l]]);
+        firsti[c+1] = firsti[c] + maxlen;
+      }
+    
+    colnr.SetSize(firsti[nchunks]*C);
+    data.SetSize(firsti[nchunks]*C);
+    ParallelFor (nchunks, [&] (size_t c)
+                 {
+                   for (int l = 0; l < C; l++)
+                     {
+                       int row = rows[c*C+l];
+                       size_t len = (row != -1) ? rowcols[row].Size() : 0;
+                       // padding reads an x-value of the row anyway
+                       int padcol = len ? rowcols[row][len-1] : 0;
+                       for (size_t k = 0; k < firsti[c+1]-firsti[c]; k++)
+                         {
+                           size_t pos = (firsti[c]+k)*C+l;
+                           colnr[pos] = k < len ? rowcols[row][k] : padcol;
+                           data[pos] = k < len ? rowvals[row][k] : TSCAL(0.0);
+                         }
+                     }
+                 });
+  }
+
+  
+  template <typename TSCAL>
+  void SparseMatrixSELL<TSCAL> ::
+  MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SparseMatrixSELL::MultAdd");
+    RegionTimer reg(t);
+    t.AddFlops (2*nze);
+
+    auto fx = x.FV<TSCAL>();
+    auto fy = y.FV<TSCAL>();
+    ParallelForRange
+      (nchunks, [&] (IntRange myrange)
+       {
+         for (size_t c : myrange)
+           {
+             const TSCAL * pdata = data.Data() + firsti[c]*C;
+             const int * pcol = colnr.Data() + firsti[c]*C;
+             SIMD<double> sum(0.0);
+             for (size_t k = firsti[c]; k < firsti[c+1]; k++, pdata += C, pcol += C)
+               sum = FMA (SIMD<double>(pdata),
+                          SIMD<double>([pcol,fx] (int l) { return fx(pcol[l]); }),
+                          sum);
+             for (int l = 0; l < C; l++)
+               if (int row = rows[c*C+l]; row != -1)
+                 fy(row) += s * sum[l];
+           }
+       }, TasksPerThread(4));
+  }
+
+  
+  template <typename TSCAL>
+  void SparseMatrixSELL<TSCAL> ::
+  MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    if (symmetric)
+      {
+        MultAdd (s, x, y);
+        return;
+      }
+    
+    static Timer t("SparseMatrixSELL::MultTransAdd");
+    RegionTimer reg(t);
+    t.AddFlops (2*nze);
+
+    auto fx = x.FV<TSCAL>();
+    auto fy = y.FV<TSCAL>();
+    ParallelForRange
+      (nchunks, [&] (IntRange myrange)
+       {
+         for (size_t c : myrange)
+           {
+             const TSCAL * pdata = data.Data() + firsti[c]*C;
+             const int * pcol = colnr.Data() + firsti[c]*C;
+             const int * prow = rows.Data() + c*C;
+             SIMD<double> sx([prow,fx,s] (int l)
+                             { return prow[l] != -1 ? s*fx(prow[l]) : 0.0; });
+             for (size_t k = firsti[c]; k < firsti[c+1]; k++, pdata += C, pcol += C)
+               {
+                 SIMD<double> prod = SIMD<double>(pdata) * sx;
+                 for (int l = 0; l < C; l++)
+                   AtomicAdd (fy(pcol[l]), prod[l]);
+               }
+           }
+       }, TasksPerThread(4));
+  }
+
+  
+  template <typename TSCAL>  
+  AutoVector SparseMatrixSELL<TSCAL> :: CreateRowVector () const
+  {
+    return CreateBaseVector(bwidth, false, bw);
+  }
+
+  template <typename TSCAL>  
+  AutoVector SparseMatrixSELL<TSCAL> :: CreateColVector () const
+  {
+    return CreateBaseVector(bheight, false, bh);
+  }
+
+  template class SparseMatrixSELL<double>;
+
 }
@@ -79,6 +79,68 @@ namespace ngla
 
 
 
+
+  /**
+     Sparse matrix in SELL-C-sigma format, for SIMD matrix-vector products.
+     Chunks of C = SIMD<double>::Size() rows are stored column by column,
+     every chunk padded to its longest row. Within windows of sigma rows,
+     rows are sorted by length to keep the padding small.
+     Block entries are expanded to scalar rows, and symmetric storage
+     is expanded to the full matrix.
+  */
+  template <class TSCAL>
+  class NGS_DLL_HEADER SparseMatrixSELL : public S_BaseMatrix<TSCAL>
+  {
+  protected:
+    static constexpr int C = SIMD<double>::Size();
+    // block rows, block size of the original matrix
+    size_t bheight, bwidth;
+    int bh, bw;
+    // scalar rows and columns
+    size_t height, width;
+    size_t nze;
+    bool symmetric;
+    size_t nchunks;
+    // the rows of chunk c are rows[c*C+l], -1 for padding
+    Array<int> rows;
+    // chunk c has the chunk-columns [firsti[c], firsti[c+1])
+    Array<size_t> firsti;
+    // C entries per chunk-column
+    Array<int> colnr;
+    Array<TSCAL> data;
+
+    void Setup (const MatrixGraph & graph, FlatArray<TSCAL> bdata, size_t sigma);
+    
+  public:
+    template <typename TM>
+    SparseMatrixSELL (const SparseMatrixTM<TM> & mat, size_t sigma = 256)
+      : bheight(mat.Height()), bwidth(mat.Width()),
+        bh(mat_traits<TM>::HEIGHT), bw(mat_traits<TM>::WIDTH)
+    {
+      symmetric = dynamic_cast<const SparseMatrixSymmetricTM<TM>*> (&mat) != nullptr;
+      Array<TSCAL> bdata(mat.NZE()*bh*bw);
+      auto matvec = mat.AsVector().template FV<TM>();
+      for (size_t i = 0; i < mat.NZE(); i++)
+        FlatMatrix<TSCAL> (bh, bw, &bdata[i*bh*bw]) = matvec(i);
+      Setup (mat, bdata, sigma);
+    }
+
+    int VHeight() const override { return bheight; }
+    int VWidth() const override { return bwidth; }
+    size_t NZE () const override { return nze; }
+
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    AutoVector CreateRowVector () const override;
+    AutoVector CreateColVector () const override;
+
+    Array<MemoryUsage> GetMemoryUsage () const override
+    {
+      return { MemoryUsage ("SparseMatrixSELL", data.Size()*(sizeof(TSCAL)+sizeof(int)), 1) };
+    }
+  };
+
 }
 #endif
   
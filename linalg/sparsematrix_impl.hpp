@@ -22,6 +22,7 @@ namespace ngla
   PrefetchRow (int rownr) const
   {
 #ifdef __GNUC__
+    this->EnsureColumnIndices();
     size_t fi = firsti[rownr], fin = firsti[rownr+1];
     int * pi = &colnr[fi], * pin = &colnr[fin];
     while (pi < pin)
@@ -132,6 +133,7 @@ namespace ngla
   {
     static Timer t("SparseMatrix::MultAdd"); RegionTimer reg(t);
     t.AddFlops (this->NZE());
+    bool compressed = this->HasCompressedColumnIndices();
 
     if (task_manager)
       {
@@ -149,8 +151,12 @@ namespace ngla
              
              auto myrange = balance[mypart].Split (num_in_part, tasks_per_part);
 
-             for (auto row : myrange) 
-               fy(row) += s * RowTimesVector (row, fx);
+             if (compressed)
+               for (auto row : myrange) 
+                 fy(row) += s * RowTimesVectorCompressed (row, fx);
+             else
+               for (auto row : myrange) 
+                 fy(row) += s * RowTimesVector (row, fx);
 
            });
 	return;
@@ -161,9 +167,57 @@ namespace ngla
     FlatVector<TVY> fy = y.FV<TVY>(); 
 
     int h = this->Height();
-    for (int i = 0; i < h; i++)
-      fy(i) += s * RowTimesVector (i, fx);
+    if (compressed)
+      for (int i = 0; i < h; i++)
+        fy(i) += s * RowTimesVectorCompressed (i, fx);
+    else
+      for (int i = 0; i < h; i++)
+        fy(i) += s * RowTimesVector (i, fx);
+  }
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseMatrix<TM,TV_ROW,TV_COL> ::
+  MultAdd (double s, const MultiVector & x, MultiVector & y) const
+  {
+    if constexpr (is_same<TM,double>::value && is_same<TV_ROW,double>::value)
+      {
+        static Timer t("SparseMatrix::MultAdd (MultiVector)"); RegionTimer reg(t);
+        if (x.Size() != y.Size())
+          throw Exception ("SparseMatrix::MultAdd: number of vectors don't match");
+        t.AddFlops (double(this->NZE()) * x.Size());
+
+        FlatMatrix<double> fx = x.FM();
+        FlatMatrix<double> fy = y.FM();
+        size_t m = x.Size();
+        this->EnsureColumnIndices();
+
+        // a row of the matrix is loaded once for BS vectors
+        constexpr size_t BS = 8;
+        ParallelForRange (this->Height(), [&] (IntRange r)
+          {
+            double sum[BS];
+            for (size_t first = 0; first < m; first += BS)
+              {
+                size_t nb = min2 (BS, m-first);
+                for (auto row : r)
+                  {
+                    for (size_t l = 0; l < nb; l++)
+                      sum[l] = 0;
+                    for (size_t j = firsti[row]; j < firsti[row+1]; j++)
+                      {
+                        double val = data[j];
+                        size_t col = colnr[j];
+                        for (size_t l = 0; l < nb; l++)
+                          sum[l] += val * fx(first+l, col);
+                      }
+                    for (size_t l = 0; l < nb; l++)
+                      fy(first+l, row) += s * sum[l];
+                  }
+              }
+          });
+      }
+    else
+      BaseMatrix::MultAdd (s, x, y);
   }
 
   template <class TM, class TV_ROW, class TV_COL>
@@ -193,6 +247,23 @@ namespace ngla
   
   
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseMatrix<TM,TV_ROW,TV_COL> ::
+  MultAddRows (double s, const BaseVector & x, BaseVector & y,
+               FlatArray<int> rows) const
+  {
+    static Timer t("SparseMatrix::MultAddRows"); RegionTimer reg(t);
+
+    FlatVector<TVX> fx = x.FV<TVX>(); 
+    FlatVector<TVY> fy = y.FV<TVY>(); 
+
+    ParallelForRange (rows.Size(), [&] (IntRange r)
+                      {
+                        for (auto i : r)
+                          fy(rows[i]) += s * RowTimesVector (rows[i], fx);
+                      }, TasksPerThread(4));
+  }
+
   template <class TM, class TV_ROW, class TV_COL>
   void SparseMatrix<TM,TV_ROW,TV_COL> ::
   MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
@@ -264,6 +335,7 @@ namespace ngla
     ar & this->width;
     ar & this->nze;
     ar & firsti;
+    this->EnsureColumnIndices();
     ar & colnr;
     ar & data;
     cout << "sparsemat, doarch, sizeof (firstint) = " << firsti.Size() << endl;
@@ -319,6 +391,12 @@ namespace ngla
 	  throw Exception ("SparseMatrix::InverseMatrix: MumpsInverse not available");
 #endif
 	}
+      else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_ND )
+	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset, nullptr, false, NESTED_DISSECTION_ORDERING);
+      else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SUPERNODAL )
+	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset, nullptr, false, NESTED_DISSECTION_ORDERING, true);
+      else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SINGLE )
+	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset, nullptr, false, NESTED_DISSECTION_ORDERING, true, true);
       else
 	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, subset);
       //#endif
@@ -388,6 +466,12 @@ namespace ngla
 	  throw Exception ("SparseMatrix::InverseMatrix:  MumpsInverse not available");
 #endif
 	}
+      else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_ND )
+	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters, false, NESTED_DISSECTION_ORDERING);
+      else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SUPERNODAL )
+	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters, false, NESTED_DISSECTION_ORDERING, true);
+      else if ( BaseSparseMatrix :: GetInverseType()  == SPARSECHOLESKY_SINGLE )
+	return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters, false, NESTED_DISSECTION_ORDERING, true, true);
       else
 	{
 	  return make_shared<SparseCholesky<TM,TV_ROW,TV_COL>> (*this, nullptr, clusters);
@@ -401,6 +485,7 @@ namespace ngla
   ostream & SparseMatrixTM<TM> ::
   Print (ostream & ost) const
   {
+    this->EnsureColumnIndices();
     for (int i = 0; i < size; i++)
       {
 	ost << "Row " << i << ":";
@@ -465,137 +550,302 @@ namespace ngla
   }
 
 
-  template<class TM, class TV_ROW, class TV_COL>
-  shared_ptr<BaseSparseMatrix>
-  SparseMatrix<TM,TV_ROW,TV_COL> :: Restrict (const SparseMatrixTM<double> & prol,
-                                  shared_ptr<BaseSparseMatrix> acmat ) const
+  /*
+    Hash table for accumulating one sparse row, maps column numbers to
+    consecutive slots in order of insertion. One instance per task,
+    it is cleared (not reallocated) between rows.
+   */
+  class SparseRowHash
   {
-    static Timer t ("sparsematrix - restrict");
-    static Timer tbuild ("sparsematrix - restrict, build matrix");
-    static Timer tcomp ("sparsematrix - restrict, compute matrix");
-    RegionTimer reg(t);
-    
-    int n = this->Height();
+    Array<int> keys, vals, slots, used;
+    size_t mask;
+  public:
+    SparseRowHash (size_t size = 256) { Init(size); }
 
-    auto cmat = dynamic_pointer_cast<SparseMatrixTM<TM>> (acmat);
- 
-    // if no coarse matrix, build up matrix-graph!
-    if ( !cmat )
-      {
-        RegionTimer reg(tbuild);
+    void Init (size_t size)
+    {
+      keys.SetSize(size);
+      vals.SetSize(size);
+      keys = -1;
+      mask = size-1;
+    }
 
-	Array<int> marks(n);
-	Array<INT<2> > e2v;
-	for (int i = 0; i < n; i++)
-	  for (int j = 0; j < this->GetRowIndices(i).Size(); j++)
-	    {
-	      int col = this->GetRowIndices(i)[j];
-	      FlatArray<int> prol_rowind = prol.GetRowIndices(i);
-	      FlatArray<int> prol_colind = prol.GetRowIndices(col);
-
-	      for (int k = 0; k < prol_rowind.Size(); k++)
-		for (int l = 0; l < prol_colind.Size(); l++)
-		  {
-		    int kk = prol_rowind[k];
-		    int ll = prol_colind[l];
-		    
-		    // if (kk >= ll) swap (kk,ll);
-		    e2v.Append (INT<2> (kk,ll));
-		  }
-	    }
+    size_t Size() const { return used.Size(); }
+    /// columns in order of insertion
+    FlatArray<int> Used() const { return used; }
 
-	int nc = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  nc = max2 (nc, e2v[i][1]);
-	nc++;
+    /// slot of column col, inserted if new
+    int Insert (int col)
+    {
+      if (2*(used.Size()+1) > keys.Size())
+        Rehash();
+      size_t pos = (size_t(col)*2654435761u) & mask;
+      while (keys[pos] != -1)
+        {
+          if (keys[pos] == col) return vals[pos];
+          pos = (pos+1) & mask;
+        }
+      keys[pos] = col;
+      vals[pos] = used.Size();
+      slots.Append (pos);
+      used.Append (col);
+      return vals[pos];
+    }
 
-	// *testout << "e2v = " << endl << e2v << endl;
-        
-        // count all entries in row with multiplicity
-	Array<int> cnt(nc);
-	cnt = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  cnt[e2v[i][1]]++;
-
-	Table<int> v2e(cnt);
-	cnt = 0;
-	for (int i = 0; i < e2v.Size(); i++)
-	  {
-	    int v1 = e2v[i][1];
-	    v2e[v1][cnt[v1]++] = i;
-	  }
-	
-	cnt = 0;
-	marks = -1;
+    /// slot of column col, -1 if not present
+    int Find (int col) const
+    {
+      size_t pos = (size_t(col)*2654435761u) & mask;
+      while (keys[pos] != -1)
+        {
+          if (keys[pos] == col) return vals[pos];
+          pos = (pos+1) & mask;
+        }
+      return -1;
+    }
 
-        // count all entries in row withOUT multiplicity
-	for (int i = 0; i < nc; i++)
-	  for (int j = 0; j < v2e[i].Size(); j++)
-	    {
-	      int jj = v2e[i][j];
-	      int v0 = e2v[jj][0];
-	      if (marks[v0] != i) 
-		{
-		  cnt[i]++;
-		  marks[v0] = i;
-		}
-	    }
+    void Clear ()
+    {
+      for (auto pos : slots)
+        keys[pos] = -1;
+      slots.SetSize0();
+      used.SetSize0();
+    }
 
-	cmat = make_shared<SparseMatrix<TM,TV_ROW,TV_COL>> (cnt);
+  private:
+    void Rehash ()
+    {
+      Array<int> hused(used);
+      Clear();
+      Init (2*keys.Size());
+      for (auto col : hused)
+        Insert (col);
+    }
+  };
 
-	marks = -1;
-	for (int i = 0; i < nc; i++)
-	  for (int j = 0; j < v2e[i].Size(); j++)
-	    {
-	      int jj = v2e[i][j];
-	      int v0 = e2v[jj][0];
-	      if (marks[v0] != i) 
-		{
-		  marks[v0] = i;
-		  cmat -> CreatePosition (i, v0);
-		}
-	    }
-      }
 
-    cmat->AsVector() = 0.0;
-    RegionTimer reg2(tcomp);
-	  
-    for (int i = 0; i < n; i++)
-      {
-        FlatArray<int> mat_ri = this->GetRowIndices(i);
-        FlatVector<TM> mat_rval = this->GetRowValues(i);
+  /*
+    Galerkin triple product  C = P^T A P.
 
-        for (int j = 0; j < mat_ri.Size(); j++)
-          {
-            int col = mat_ri[j];
-            TM mat_val = mat_rval[j]; 
+    Rows of C are computed in parallel, every task accumulates in its
+    own SparseRowHash. The symbolic phase (RowSizes, Graph) is needed
+    only once per sparsity pattern, the numeric phase (Compute) can
+    be repeated when the values of A or P change.
+    For symmetric storage A and C store the lower triangle, the strict
+    upper triangle of A is accessed by a transposed index.
+    The fine matrix keeps the object, P^T and the transposed index are
+    rebuilt only if the graph of A or P changed.
+   */
+  template <class TM>
+  class GalerkinProduct
+  {
+    const SparseMatrixTM<TM> * mat = nullptr;
+    const SparseMatrixTM<double> * prol = nullptr;
+    bool symmetric;
+    size_t mat_timestamp = 0, prol_timestamp = 0;
+    shared_ptr<SparseMatrixTM<double>> prolT;
+    /// position in prolT of every entry of prol
+    Array<size_t> prolT_pos;
+    struct UpperEntry { int row; int pos; };
+    Table<UpperEntry> upper;
+
+  public:
+    GalerkinProduct (bool asymmetric)
+      : symmetric(asymmetric) { ; }
+
+    bool IsSymmetric () const { return symmetric; }
+
+    /// sets A and P, the values of P^T are copied from P
+    void Setup (const SparseMatrixTM<TM> & amat, const SparseMatrixTM<double> & aprol)
+    {
+      static Timer t ("GalerkinProduct - setup");
+      static Timer tv ("GalerkinProduct - setup values");
+      mat = &amat;
+      prol = &aprol;
+
+      if (prolT && prol_timestamp == prol->GetTimeStamp())
+        {
+          RegionTimer reg(tv);
+          FlatVector<double> prolT_vals = prolT->AsVector().FV<double>();
+          ParallelFor (prol->Height(), [&] (size_t i)
+                       {
+                         size_t first = prol->First(i);
+                         auto vals = prol->GetRowValues(i);
+                         for (size_t k = 0; k < vals.Size(); k++)
+                           prolT_vals(prolT_pos[first+k]) = vals[k];
+                       });
+        }
+      else
+        {
+          RegionTimer reg(t);
+          prolT = TransposeMatrix (*prol);
+          prolT_pos.SetSize (prol->NZE());
+          ParallelFor (prol->Height(), [&] (size_t i)
+                       {
+                         size_t first = prol->First(i);
+                         auto cols = prol->GetRowIndices(i);
+                         for (size_t k = 0; k < cols.Size(); k++)
+                           prolT_pos[first+k] = prolT->GetPosition (cols[k], i);
+                       });
+          prol_timestamp = prol->GetTimeStamp();
+        }
+
+      if (!symmetric || (upper.Size() && mat_timestamp == mat->GetTimeStamp()))
+        return;
+
+      RegionTimer reg(t);
+      size_t n = mat->Height();
+      Array<int> cnt(n);
+      cnt = 0;
+      ParallelFor (n, [&] (size_t i)
+                   {
+                     for (int c : mat->GetRowIndices(i))
+                       if (c != int(i)) AsAtomic (cnt[c]) ++;
+                   });
+      upper = Table<UpperEntry> (cnt);
+      cnt = 0;
+      ParallelFor (n, [&] (size_t i)
+                   {
+                     auto cols = mat->GetRowIndices(i);
+                     for (int k : Range(cols))
+                       if (cols[k] != int(i))
+                         upper[cols[k]][AsAtomic(cnt[cols[k]])++] = UpperEntry { int(i), k };
+                   });
+      ParallelFor (n, [&] (size_t i)
+                   {
+                     QuickSort (upper[i], [] (UpperEntry a, UpperEntry b) { return a.row < b.row; });
+                   });
+      mat_timestamp = mat->GetTimeStamp();
+    }
+
+    /// number of entries per row of C
+    Array<int> RowSizes () const
+    {
+      static Timer t ("GalerkinProduct - symbolic");
+      RegionTimer reg(t);
+      Array<int> cnt(prolT->Height());
+      ParallelForRange
+        (prolT->Height(), [&] (IntRange r)
+         {
+           SparseRowHash hash;
+           for (auto row : r)
+             {
+               ProductRow (row, hash, [] (int slot, double val, auto aval) { ; });
+               cnt[row] = hash.Size();
+               hash.Clear();
+             }
+         }, TasksPerThread(4));
+      return cnt;
+    }
 
-            FlatArray<int> prol_ri_i = prol.GetRowIndices(i);
-            FlatArray<int> prol_ri_col = prol.GetRowIndices(col);
-            FlatVector<double> prol_rval_i = prol.GetRowValues(i);
-            FlatVector<double> prol_rval_col = prol.GetRowValues(col);
+    /// sets the (sorted) column indices of C, cmat allocated with RowSizes
+    void Graph (SparseMatrixTM<TM> & cmat) const
+    {
+      static Timer t ("GalerkinProduct - graph");
+      RegionTimer reg(t);
+      ParallelForRange
+        (prolT->Height(), [&] (IntRange r)
+         {
+           SparseRowHash hash;
+           for (auto row : r)
+             {
+               ProductRow (row, hash, [] (int slot, double val, auto aval) { ; });
+               auto cols = cmat.GetRowIndices(row);
+               cols = hash.Used();
+               QuickSort (cols);
+               hash.Clear();
+             }
+         }, TasksPerThread(4));
+    }
+
+    /// numeric phase, the graph of cmat must contain the graph of the product
+    void Compute (SparseMatrixTM<TM> & cmat) const
+    {
+      static Timer t ("GalerkinProduct - numeric");
+      RegionTimer reg(t);
+      atomic<bool> graph_ok(true);
+      ParallelForRange
+        (prolT->Height(), [&] (IntRange r)
+         {
+           SparseRowHash hash;
+           for (auto row : r)
+             {
+               auto cols = cmat.GetRowIndices(row);
+               auto vals = cmat.GetRowValues(row);
+               for (auto c : cols)
+                 hash.Insert (c);
+               int nused = hash.Size();
+               vals = TM(0.0);
+               ProductRow (row, hash, [&] (int slot, double val, auto aval)
+                           {
+                             if (slot < nused)
+                               vals[slot] += val * aval;
+                             else
+                               graph_ok = false;
+                           });
+               hash.Clear();
+             }
+         }, TasksPerThread(4));
+      if (!graph_ok)
+        throw Exception ("Restrict: coarse matrix does not contain the graph of P^T A P");
+    }
 
-            for (int k = 0; k < prol_ri_i.Size(); k++)
-              for (int l = 0; l < prol_ri_col.Size(); l++)
+  private:
+    // C(row,J) += P(i,row) A(i,j) P(j,J), calls func(slot, P(i,row) P(j,J), A(i,j))
+    template <typename TFUNC>
+    void ProductRow (int row, SparseRowHash & hash, TFUNC func) const
+    {
+      auto prolT_cols = prolT->GetRowIndices(row);
+      auto prolT_vals = prolT->GetRowValues(row);
+      for (int k : Range(prolT_cols))
+        {
+          int i = prolT_cols[k];
+          double pval = prolT_vals[k];
+          auto Add = [&] (int j, const TM & aval)
+            {
+              auto prol_cols = prol->GetRowIndices(j);
+              auto prol_vals = prol->GetRowValues(j);
+              for (int l : Range(prol_cols))
                 {
-                  int kk = prol_ri_i[k];
-                  int ll = prol_ri_col[l];
-                  
-                  if ( /*kk>=ll &&*/ kk < cmat->Height() )
-                    {
-                      (*cmat)(kk,ll) += 
-                        prol_rval_i[k] * prol_rval_col[l] * mat_val; 
-                    }
-                  
-                  // if (ll >= kk && i != col && ll < cmat->Height() )
-                  //   {
-                  //     (*cmat)(ll,kk) += 
-                  //       prol_rval_col[l] * prol_rval_i[k] * Trans(mat_val); 
-                  //   }
-                  
+                  int col = prol_cols[l];
+                  if (symmetric && col > row) continue;
+                  func (hash.Insert(col), pval * prol_vals[l], aval);
                 }
-          }
+            };
+
+          auto mat_cols = mat->GetRowIndices(i);
+          auto mat_vals = mat->GetRowValues(i);
+          for (int l : Range(mat_cols))
+            Add (mat_cols[l], mat_vals[l]);
+          if (symmetric)
+            for (auto e : upper[i])
+              Add (e.row, Trans (mat->GetRowValues(e.row)[e.pos]));
+        }
+    }
+  };
+
+
+  template<class TM, class TV_ROW, class TV_COL>
+  shared_ptr<BaseSparseMatrix>
+  SparseMatrix<TM,TV_ROW,TV_COL> :: Restrict (const SparseMatrixTM<double> & prol,
+                                  shared_ptr<BaseSparseMatrix> acmat ) const
+  {
+    static Timer t ("sparsematrix - restrict");
+    RegionTimer reg(t);
+
+    if (!this->galerkin || this->galerkin->IsSymmetric())
+      this->galerkin = make_shared<GalerkinProduct<TM>> (false);
+    GalerkinProduct<TM> & rap = *this->galerkin;
+    rap.Setup (*this, prol);
+
+    // reuse the graph of a given coarse matrix, only values are recomputed
+    auto cmat = dynamic_pointer_cast<SparseMatrixTM<TM>> (acmat);
+    if (!cmat)
+      {
+        cmat = make_shared<SparseMatrix<TM,TV_ROW,TV_COL>> (rap.RowSizes(), prol.Width());
+        rap.Graph (*cmat);
       }
+    rap.Compute (*cmat);
     return cmat;
   }
 
@@ -716,6 +966,16 @@ namespace ngla
     const FlatVector<TV_ROW> fx = x.FV<TV_ROW>();
     FlatVector<TV_COL> fy = y.FV<TV_COL>();
 
+    if (this->HasCompressedColumnIndices())
+      {
+        for (int i = 0; i < this->Height(); i++)
+          {
+            fy(i) += s * RowTimesVectorCompressed (i, fx);
+            AddRowTransToVectorNoDiagCompressed (i, s * fx(i), fy);
+          }
+        return;
+      }
+    
     for (int i = 0; i < this->Height(); i++)
       {
 	fy(i) += s * RowTimesVector (i, fx);
@@ -723,6 +983,25 @@ namespace ngla
       }
   }
 
+  template <class TM, class TV>
+  void SparseMatrixSymmetric<TM,TV> :: 
+  MultAddRows (double s, const BaseVector & x, BaseVector & y,
+               FlatArray<int> rows) const
+  {
+    static Timer timer("SparseMatrixSymmetric::MultAddRows");
+    RegionTimer reg (timer);
+
+    const FlatVector<TV_ROW> fx = x.FV<TV_ROW>();
+    FlatVector<TV_COL> fy = y.FV<TV_COL>();
+
+    // transposed rows scatter into fy, stay sequential as MultAdd does
+    for (int i : rows)
+      {
+	fy(i) += s * RowTimesVector (i, fx);
+	AddRowTransToVectorNoDiag (i, s * fx(i), fy);
+      }
+  }
+
   template <class TM, class TV>
   void SparseMatrixSymmetric<TM,TV> :: 
   MultAdd1 (double s, const BaseVector & x, BaseVector & y,
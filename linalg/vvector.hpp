@@ -15,6 +15,8 @@ namespace ngla
     TSCAL * pdata;
     int es;
     bool ownmem;
+    /// keeps external memory alive (e.g. a file mapping)
+    shared_ptr<void> memory_owner;
     
   public:
     S_BaseVectorPtr (size_t as, int aes, void * adata) throw()
@@ -41,6 +43,7 @@ namespace ngla
       this->size = as;
       pdata = new TSCAL[as*es];
       ownmem = true;
+      memory_owner = nullptr;
     }
 
     void AssignMemory (size_t as, void * adata)
@@ -48,6 +51,17 @@ namespace ngla
       this->size = as; 
       this->pdata = static_cast<TSCAL*> (adata); 
     }
+
+    /// use external memory, which is kept alive by owner.
+    /// Own memory is released as in SetSize, views of it become invalid
+    void AssignMemory (size_t as, void * adata, shared_ptr<void> owner)
+    {
+      if (ownmem) delete [] pdata;
+      this->size = as;
+      pdata = static_cast<TSCAL*> (adata);
+      ownmem = false;
+      memory_owner = owner;
+    }
     
     virtual ~S_BaseVectorPtr ();
 
@@ -71,6 +85,13 @@ namespace ngla
     virtual AutoVector CreateVector () const override;
 
     virtual ostream & Print (ostream & ost) const override;
+
+    virtual double AddAddInnerProduct (double a, const BaseVector & x,
+                                       BaseVector & y, double b, const BaseVector & z,
+                                       const BaseVector * w) override;
+    virtual double AddL2Norm (double a, const BaseVector & x) override;
+    virtual BaseVector & MultiAdd (double s, FlatArray<double> c,
+                                   FlatArray<const BaseVector*> v) override;
   };
 
 
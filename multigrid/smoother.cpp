@@ -232,6 +232,91 @@ namespace ngmg
 
 
 
+  ChebyshevSmoother :: 
+  ChebyshevSmoother  (const MeshAccess & ama,
+                      const BilinearForm & abiform, const Flags & aflags)
+    : Smoother(aflags), biform(abiform)
+  {
+    Update();
+  }
+
+  void ChebyshevSmoother :: Update (bool force_update)
+  {
+    int level = biform.GetNLevels();
+    if (level <= 0) return;
+    if (cheb.Size() == level && !force_update && !updateall)
+      return;
+
+    bool block = flags.StringFlagDefined ("blocktype");
+    int degree = int (flags.GetNumFlag ("chebyshev_degree", 3));
+    double ratio = flags.GetNumFlag ("chebyshev_ratio", 30);
+    int evsteps = int (flags.GetNumFlag ("chebyshev_evsteps", 10));
+
+    if (block)
+      {
+        while (smoothing_blocks.Size() < level)
+          smoothing_blocks.Append(nullptr);
+        if (!smoothing_blocks.Last())
+          smoothing_blocks.Last() = biform.GetFESpace()->CreateSmoothingBlocks(flags);
+      }
+
+    int oldsize = cheb.Size();
+    cheb.SetSize (level);
+    int startlevel = (updateall || force_update) ? 0 : oldsize;
+    for (int i = startlevel; i < level; i++)
+      {
+        auto mat = biform.GetMatrixPtr(i);
+        if (!mat)
+          {
+            cheb[i] = nullptr;
+            continue;
+          }
+        // with MPI, the Jacobi preconditioner is built from the local matrix,
+        // its (block-)diagonal is cumulated over the parallel dofs. The Lanczos
+        // estimate and the smoothing steps use the parallel matrix.
+        auto locmat = mat;
+        if (auto pmat = dynamic_pointer_cast<ParallelMatrix> (mat))
+          locmat = pmat->GetMatrix();
+        auto & smat = dynamic_cast<const BaseSparseMatrix&> (*locmat);
+        shared_ptr<BaseMatrix> dinv;
+        if (block && smoothing_blocks[i])
+          dinv = smat.CreateBlockJacobiPrecond (smoothing_blocks[i]);
+        else
+          dinv = smat.CreateJacobiPrecond (biform.GetFESpace()->GetFreeDofs());
+        cheb[i] = make_shared<ChebyshevJacobi> (mat, dinv, degree, ratio, evsteps);
+      }
+  }
+
+  void ChebyshevSmoother :: PreSmooth (int level, BaseVector & u, 
+                                       const BaseVector & f, int steps) const
+  {
+    cheb[level]->Smooth (u, f, steps);
+  }
+
+  void ChebyshevSmoother :: PostSmooth (int level, BaseVector & u, 
+                                        const BaseVector & f, int steps) const
+  {
+    cheb[level]->Smooth (u, f, steps);
+  }
+
+  void ChebyshevSmoother :: Residuum (int level, BaseVector & u, 
+                                      const BaseVector & f, BaseVector & d) const
+  {
+    d = f - biform.GetMatrix(level) * u;
+  }
+  
+  AutoVector ChebyshevSmoother :: CreateVector(int level) const
+  {
+    return biform.GetMatrix(level).CreateColVector();
+  }
+
+
+
+
+
+
+
+
   /*
 
 
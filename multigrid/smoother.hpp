@@ -219,6 +219,44 @@ namespace ngmg
 
 
 
+  /**
+     Chebyshev-Jacobi smoother.
+     Point Jacobi, or block Jacobi if the flag blocktype is set. Only
+     matrix-vector products and Jacobi steps, thread and MPI parallel.
+     Flags: chebyshev_degree, chebyshev_ratio, chebyshev_evsteps.
+  */
+  class ChebyshevSmoother : public Smoother
+  {
+    ///
+    const BilinearForm & biform;
+    ///
+    Array<shared_ptr<ChebyshevJacobi>> cheb;
+    ///
+    Array<shared_ptr<Table<int>>> smoothing_blocks;
+
+  public:
+    ///
+    ChebyshevSmoother (const MeshAccess & ama,
+                       const BilinearForm & abiform, const Flags & aflags);
+  
+    ///
+    virtual void Update (bool force_update = 0);
+    ///
+    virtual void PreSmooth (int level, ngla::BaseVector & u, 
+			    const ngla::BaseVector & f, int steps) const;
+    ///
+    virtual void PostSmooth (int level, ngla::BaseVector & u, 
+			     const ngla::BaseVector & f, int steps) const;
+    ///
+    virtual void Residuum (int level, ngla::BaseVector & u, 
+			   const ngla::BaseVector & f, ngla::BaseVector & d) const;
+    ///
+    virtual AutoVector CreateVector(int level) const;
+  };
+
+
+
+
 #ifdef XXX_OBSOLETE
   /**
      Matrix - vector multiplication by smoothing step.
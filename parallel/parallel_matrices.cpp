@@ -15,33 +15,23 @@ namespace ngla
 
 #ifdef PARALLEL
   
-  template <typename TM> AutoVector MasterInverse<TM> :: CreateRowVector () const
-  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
-  template <typename TM> AutoVector MasterInverse<TM> :: CreateColVector () const
-  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
-  
-  template <typename TM>
-  MasterInverse<TM> :: MasterInverse (const SparseMatrixTM<TM> & mat, 
-				      shared_ptr<BitArray> subset, 
-				      shared_ptr<ParallelDofs> hpardofs)
-    
-    : BaseMatrix(hpardofs), loc2glob(hpardofs -> GetCommunicator().Size())
+  /*
+    consecutive global numbers for the master dofs in the subset,
+    the other entries of global_nums are -1
+  */
+  static int MasterNumbering (const ParallelDofs & pardofs, shared_ptr<BitArray> subset,
+                              Array<int> & global_nums)
   {
-    inv = nullptr;
-    
-    auto & comm = paralleldofs->GetCommunicator();
+    auto & comm = pardofs.GetCommunicator();
     int id = comm.Rank();
     int ntasks = comm.Size();
+    int ndof = pardofs.GetNDofLocal();
 
-    // consistent enumeration
-    
-    int ndof = paralleldofs->GetNDofLocal();
-
-    Array<int> global_nums(ndof);
+    global_nums.SetSize(ndof);
     global_nums = -1;
     int num_master_dofs = 0;
     for (int i = 0; i < ndof; i++)
-      if (paralleldofs -> IsMasterDof (i) && (!subset || (subset && subset->Test(i))))
+      if (pardofs.IsMasterDof (i) && (!subset || (subset && subset->Test(i))))
 	global_nums[i] = num_master_dofs++;
     
 
@@ -63,8 +53,75 @@ namespace ngla
       if (global_nums[i] != -1)
 	global_nums[i] += first_master_dof[id];
 
-    paralleldofs -> ScatterDofData (global_nums);
+    pardofs.ScatterDofData (global_nums);
+    return num_glob_dofs;
+  }
+
+
+  /// assemble a sparse matrix from (row, col, value) triplets
+  template <typename TM>
+  static shared_ptr<SparseMatrixTM<TM>> AssembleTriplets (int n, bool symmetric,
+                                                           FlatArray<int> rows, FlatArray<int> cols,
+                                                           FlatArray<TM> vals)
+  {
+    DynamicTable<int> graph(n);
+    for (int i = 0; i < rows.Size(); i++)
+      {
+        int r = rows[i], c = cols[i];
+        if (symmetric && (r < c)) swap (r, c);
+        graph.AddUnique (r, c);
+      }
+
+    Array<int> els_per_row(n);
+    for (int i = 0; i < n; i++)
+      els_per_row[i] = graph[i].Size();
+
+    shared_ptr<SparseMatrixTM<TM>> matrix;
+    if (symmetric)
+      matrix = make_shared<SparseMatrixSymmetric<TM>> (els_per_row);
+    else
+      matrix = make_shared<SparseMatrix<TM>> (els_per_row);
+
+    for (int i = 0; i < rows.Size(); i++)
+      {
+        int r = rows[i], c = cols[i];
+        if (symmetric && (r < c)) swap (r, c);
+        matrix->CreatePosition(r, c);
+      }
+    matrix->AsVector() = 0.0;
+
+    for (int i = 0; i < rows.Size(); i++)
+      {
+        int r = rows[i], c = cols[i];
+        if (symmetric && (r < c)) swap (r, c);
+        (*matrix)(r,c) += vals[i];
+      }
+    return matrix;
+  }
+
+  
+  template <typename TM> AutoVector MasterInverse<TM> :: CreateRowVector () const
+  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
+  template <typename TM> AutoVector MasterInverse<TM> :: CreateColVector () const
+  { return make_shared<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
+  
+  template <typename TM>
+  MasterInverse<TM> :: MasterInverse (const SparseMatrixTM<TM> & mat, 
+				      shared_ptr<BitArray> subset, 
+				      shared_ptr<ParallelDofs> hpardofs)
+    
+    : BaseMatrix(hpardofs), loc2glob(hpardofs -> GetCommunicator().Size())
+  {
+    inv = nullptr;
+    
+    auto & comm = paralleldofs->GetCommunicator();
+    int id = comm.Rank();
+    int ntasks = comm.Size();
 
+    // consistent enumeration
+    
+    Array<int> global_nums;
+    int num_glob_dofs = MasterNumbering (*paralleldofs, subset, global_nums);
 
     /*
     cout << "TESTING" << endl;
@@ -219,44 +276,10 @@ namespace ngla
 	cout << IM(5) << endl;
 
 
-	cout << IM(4) << "now build graph" << endl;
-
-	// build matrix
-	DynamicTable<int> graph(num_glob_dofs);
-	cout << IM(3) << "n = " << num_glob_dofs << endl;
-	for (int i = 0; i < rows.Size(); i++)
-	  {
-	    int r = rows[i], c = cols[i];
-	    if (symmetric && (r < c)) swap (r, c);
-	    graph.AddUnique (r, c);
-	  }
-
-	// *testout << "graphi = " << endl << graph << endl;
-
-	Array<int> els_per_row(num_glob_dofs);
-	for (int i = 0; i < num_glob_dofs; i++)
-	  els_per_row[i] = graph[i].Size();
-
 	cout << IM(4) << "now build matrix" << endl;
+	cout << IM(3) << "n = " << num_glob_dofs << endl;
 
-	// SparseMatrixSymmetric<TM> matrix(els_per_row);
-        auto matrix = symmetric ? make_shared<SparseMatrixSymmetric<TM>> (els_per_row)
-	  : make_shared<SparseMatrix<TM>> (els_per_row);
-
-	for (int i = 0; i < rows.Size(); i++)
-	  {
-	    int r = rows[i], c = cols[i];
-	    if (symmetric && (r < c) ) swap (r, c);
-	    matrix->CreatePosition(r, c);
-	  }
-	matrix->AsVector() = 0.0;
-
-	for (int i = 0; i < rows.Size(); i++)
-	  {
-	    int r = rows[i], c = cols[i];
-	    if (symmetric && (r < c)) swap (r, c);
-	    (*matrix)(r,c) += vals[i];
-	  }
+	auto matrix = AssembleTriplets<TM> (num_glob_dofs, symmetric, rows, cols, vals);
 
 	cout << IM(4) << "have matrix, now invert" << endl;
 
@@ -361,40 +384,234 @@ namespace ngla
 
 
 
+  /// gather arrays of varying length, to rank 0 or to all ranks
+  template <typename T>
+  static void GatherArrays (FlatArray<T> send, Array<T> & recv,
+                            Array<int> & cnt, Array<int> & displ,
+                            MPI_Comm comm, bool all)
+  {
+    int rank, size;
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    int n = send.Size();
+    cnt.SetSize (size);
+    displ.SetSize (size+1);
+    if (all)
+      MPI_Allgather (&n, 1, MPI_INT, cnt.Data(), 1, MPI_INT, comm);
+    else
+      MPI_Gather (&n, 1, MPI_INT, cnt.Data(), 1, MPI_INT, 0, comm);
+
+    displ[0] = 0;
+    if (all || rank == 0)
+      for (int i = 0; i < size; i++)
+        displ[i+1] = displ[i] + cnt[i];
+    recv.SetSize ( (all || rank == 0) ? displ[size] : 0);
+
+    MPI_Datatype type = MyGetMPIType<T>();
+    if (all)
+      MPI_Allgatherv (send.Data(), n, type, recv.Data(), cnt.Data(), displ.Data(), type, comm);
+    else
+      MPI_Gatherv (send.Data(), n, type, recv.Data(), cnt.Data(), displ.Data(), type, 0, comm);
+  }
+
+
+  template <typename TM> AutoVector AgglomeratedInverse<TM> :: CreateRowVector () const
+  {
+    typedef typename mat_traits<TM>::TV_ROW TV;
+    return make_shared<ParallelVVector<TV>> (paralleldofs->GetNDofLocal(), paralleldofs);
+  }
+  template <typename TM> AutoVector AgglomeratedInverse<TM> :: CreateColVector () const
+  {
+    typedef typename mat_traits<TM>::TV_ROW TV;
+    return make_shared<ParallelVVector<TV>> (paralleldofs->GetNDofLocal(), paralleldofs);
+  }
+
+  template <typename TM>
+  AgglomeratedInverse<TM> :: AgglomeratedInverse (const SparseMatrixTM<TM> & mat, 
+                                                  shared_ptr<BitArray> subset, 
+                                                  shared_ptr<ParallelDofs> hpardofs,
+                                                  int groupsize)
+    : BaseMatrix(hpardofs)
+  {
+    static Timer t("AgglomeratedInverse - setup"); RegionTimer reg(t);
+    
+    if (groupsize < 1)
+      throw Exception ("AgglomeratedInverse: groupsize must be positive, got "+ToString(groupsize));
+    
+    auto & comm = paralleldofs->GetCommunicator();
+    int id = comm.Rank();
+
+    Array<int> global_nums;
+    num_glob_dofs = MasterNumbering (*paralleldofs, subset, global_nums);
+
+    // the first rank of every group is its leader
+    MPI_Comm_split (comm, id / groupsize, id, &group_comm);
+    bool leader = (id % groupsize) == 0;
+    MPI_Comm_split (comm, leader ? 0 : MPI_UNDEFINED, id, &leader_comm);
+
+    int ndof = paralleldofs->GetNDofLocal();
+    Array<int> sel_glob;
+    for (int i = 0; i < ndof; i++)
+      if (global_nums[i] != -1)
+        {
+          select.Append (i);
+          sel_glob.Append (global_nums[i]);
+        }
+    GatherArrays<int> (sel_glob, group_glob, group_cnt, group_displ, group_comm, false);
+    
+    Array<int> rows, cols;
+    Array<TM> vals;
+    for (int row = 0; row < mat.Height(); row++)
+      if (global_nums[row] != -1)
+        {
+          FlatArray<int> rcols = mat.GetRowIndices(row);
+          FlatVector<TM> rvals = mat.GetRowValues(row);
+          for (int j = 0; j < rcols.Size(); j++)
+            if (global_nums[rcols[j]] != -1)
+              {
+                rows.Append (global_nums[row]);
+                cols.Append (global_nums[rcols[j]]);
+                vals.Append (rvals[j]);
+              }
+        }
+
+    // collect the entries of the group on its leader
+    Array<int> grows, gcols, cnt, displ;
+    Array<TM> gvals;
+    GatherArrays<int> (rows, grows, cnt, displ, group_comm, false);
+    GatherArrays<int> (cols, gcols, cnt, displ, group_comm, false);
+    GatherArrays<TM> (vals, gvals, cnt, displ, group_comm, false);
+    
+    if (!leader) return;
+
+    // every leader gets the whole matrix, and factors it redundantly
+    GatherArrays<int> (grows, rows, cnt, displ, leader_comm, true);
+    GatherArrays<int> (gcols, cols, cnt, displ, leader_comm, true);
+    GatherArrays<TM> (gvals, vals, cnt, displ, leader_comm, true);
+
+    int nleaders;
+    MPI_Comm_size (leader_comm, &nleaders);
+    cout << IM(3) << "create agglomerated inverse, n = " << num_glob_dofs
+         << ", groups = " << nleaders << endl;
+
+    bool symmetric = (dynamic_cast<const SparseMatrixSymmetric<TM>*>(&mat) != NULL);
+    auto matrix = AssembleTriplets<TM> (num_glob_dofs, symmetric, rows, cols, vals);
+    matrix->SetInverseType (mat.GetInverseType());
+    inv = matrix->InverseMatrix ();
+  }
+
+  template <typename TM>
+  AgglomeratedInverse<TM> :: ~AgglomeratedInverse ()
+  {
+    // communicators can't be freed after MPI_Finalize, e.g. at exit of python
+    int finalized;
+    MPI_Finalized (&finalized);
+    if (finalized) return;
+    if (group_comm != MPI_COMM_NULL) MPI_Comm_free (&group_comm);
+    if (leader_comm != MPI_COMM_NULL) MPI_Comm_free (&leader_comm);
+  }
+
+  template <typename TM>
+  void AgglomeratedInverse<TM> :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("AgglomeratedInverse::MultAdd"); RegionTimer reg(t);
+    typedef typename mat_traits<TM>::TV_ROW TV;
+    typedef typename mat_traits<TM>::TSCAL TSCAL;
+
+    bool is_x_cum = (dynamic_cast_ParallelBaseVector(x) . Status() == CUMULATED);
+    y.Cumulate();
+
+    FlatVector<TV> fx = x.FV<TV> ();
+    FlatVector<TV> fy = y.FV<TV> ();
+
+    // the leaders sum up over all groups, so a cumulated vector
+    // contributes only by its master dofs
+    Array<TV> lx (select.Size());
+    for (int i = 0; i < select.Size(); i++)
+      lx[i] = (!is_x_cum || paralleldofs->IsMasterDof(select[i])) ? fx(select[i]) : TV(0.0);
+
+    MPI_Datatype type = MyGetMPIType<TV>();
+    Array<TV> gx(group_glob.Size()), gy(group_glob.Size());
+    MPI_Gatherv (lx.Data(), lx.Size(), type,
+                 gx.Data(), group_cnt.Data(), group_displ.Data(), type, 0, group_comm);
+
+    if (leader_comm != MPI_COMM_NULL)
+      {
+        VVector<TV> hx(num_glob_dofs), hy(num_glob_dofs);
+        hx = 0.0;
+        for (int i = 0; i < group_glob.Size(); i++)
+          hx(group_glob[i]) += gx[i];
+
+        // predefined reductions need the scalar type
+        MPI_Allreduce (MPI_IN_PLACE, hx.FV().Data(), num_glob_dofs*sizeof(TV)/sizeof(TSCAL),
+                       MyGetMPIType<TSCAL>(), MPI_SUM, leader_comm);
+        
+        hy = (*inv) * hx;
+        for (int i = 0; i < group_glob.Size(); i++)
+          gy[i] = hy(group_glob[i]);
+      }
+
+    MPI_Scatterv (gy.Data(), group_cnt.Data(), group_displ.Data(), type,
+                  lx.Data(), lx.Size(), type, 0, group_comm);
+
+    for (int i = 0; i < select.Size(); i++)
+      fy(select[i]) += s * lx[i];
+  }
+
+
   template class MasterInverse<double>;
   template class MasterInverse<Complex>;
+  template class AgglomeratedInverse<double>;
+  template class AgglomeratedInverse<Complex>;
 
 #if MAX_SYS_DIM >= 1
   template class MasterInverse<Mat<1,1,double> >;
   template class MasterInverse<Mat<1,1,Complex> >;
+  template class AgglomeratedInverse<Mat<1,1,double> >;
+  template class AgglomeratedInverse<Mat<1,1,Complex> >;
 #endif
 #if MAX_SYS_DIM >= 2
   template class MasterInverse<Mat<2,2,double> >;
   template class MasterInverse<Mat<2,2,Complex> >;
+  template class AgglomeratedInverse<Mat<2,2,double> >;
+  template class AgglomeratedInverse<Mat<2,2,Complex> >;
 #endif
 #if MAX_SYS_DIM >= 3
   template class MasterInverse<Mat<3,3,double> >;
   template class MasterInverse<Mat<3,3,Complex> >;
+  template class AgglomeratedInverse<Mat<3,3,double> >;
+  template class AgglomeratedInverse<Mat<3,3,Complex> >;
 #endif
 #if MAX_SYS_DIM >= 4
   template class MasterInverse<Mat<4,4,double> >;
   template class MasterInverse<Mat<4,4,Complex> >;
+  template class AgglomeratedInverse<Mat<4,4,double> >;
+  template class AgglomeratedInverse<Mat<4,4,Complex> >;
 #endif
 #if MAX_SYS_DIM >= 5
   template class MasterInverse<Mat<5,5,double> >;
   template class MasterInverse<Mat<5,5,Complex> >;
+  template class AgglomeratedInverse<Mat<5,5,double> >;
+  template class AgglomeratedInverse<Mat<5,5,Complex> >;
 #endif
 #if MAX_SYS_DIM >= 6
   template class MasterInverse<Mat<6,6,double> >;
   template class MasterInverse<Mat<6,6,Complex> >;
+  template class AgglomeratedInverse<Mat<6,6,double> >;
+  template class AgglomeratedInverse<Mat<6,6,Complex> >;
 #endif
 #if MAX_SYS_DIM >= 7
   template class MasterInverse<Mat<7,7,double> >;
   template class MasterInverse<Mat<7,7,Complex> >;
+  template class AgglomeratedInverse<Mat<7,7,double> >;
+  template class AgglomeratedInverse<Mat<7,7,Complex> >;
 #endif
 #if MAX_SYS_DIM >= 8
   template class MasterInverse<Mat<8,8,double> >;
   template class MasterInverse<Mat<8,8,Complex> >;
+  template class AgglomeratedInverse<Mat<8,8,double> >;
+  template class AgglomeratedInverse<Mat<8,8,Complex> >;
 #endif
 
 
@@ -481,6 +698,28 @@ namespace ngla
   {
     const auto & xpar = dynamic_cast_ParallelBaseVector(x);
     auto & ypar = dynamic_cast_ParallelBaseVector(y);
+
+#ifdef PARALLEL
+    /*
+      split-phase C2D: rows coupling only to interior dofs don't need
+      the cumulated interface values of x, compute them while the
+      messages are in flight. Other local matrices take the regular path.
+    */
+    auto spmat = dynamic_pointer_cast<BaseSparseMatrix> (mat);
+    if (split_phase && spmat && spmat->HasMultAddRows() && op == C2D && row_paralleldofs &&
+        xpar.Status() == DISTRIBUTED && xpar.GetParallelDofs() == row_paralleldofs)
+      {
+        static Timer t("ParallelMatrix::MultAdd split-phase"); RegionTimer reg(t);
+        const RowPartition & part = row_paralleldofs->GetRowPartition (*spmat);
+        y.Distribute();
+        xpar.StartCumulate();
+        spmat->MultAddRows (s, *xpar.GetLocalVector(), *ypar.GetLocalVector(), part.interior);
+        xpar.FinishCumulate();
+        spmat->MultAddRows (s, *xpar.GetLocalVector(), *ypar.GetLocalVector(), part.interface);
+        return;
+      }
+#endif
+
     if (op & char(2))
       x.Cumulate();
     else
@@ -583,6 +822,9 @@ namespace ngla
 #endif
 
 #ifdef PARALLEL
+    if (agglomeration > 0)
+      return make_shared<AgglomeratedInverse<TM>> (*dmat, subset, paralleldofs, agglomeration);
+    else
       return make_shared<MasterInverse<TM>> (*dmat, subset, paralleldofs);
 #endif
     throw Exception ("ParallelMatrix: don't know how to invert");
@@ -25,6 +25,12 @@ namespace ngla
     shared_ptr<ParallelDofs> row_paralleldofs, col_paralleldofs;
 
     PARALLEL_OP op;
+
+    /// overlap the exchange of interface values with the interior rows
+    bool split_phase = true;
+
+    /// ranks per group for the agglomerated inverse, 0 .. gather on master
+    int agglomeration = 0;
     
   public:
     ParallelMatrix (shared_ptr<BaseMatrix> amat, shared_ptr<ParallelDofs> apardofs,
@@ -60,6 +66,12 @@ namespace ngla
 
     PARALLEL_OP GetOpType () const { return op; }
 
+    void SetSplitPhase (bool asplit_phase) { split_phase = asplit_phase; }
+    bool GetSplitPhase () const { return split_phase; }
+
+    void SetAgglomeration (int agroupsize) { agglomeration = agroupsize; }
+    int GetAgglomeration () const { return agglomeration; }
+
     virtual shared_ptr<BaseMatrix> InverseMatrix (shared_ptr<BitArray> subset = 0) const override;
     template <typename TM>
     shared_ptr<BaseMatrix> InverseMatrixTM (shared_ptr<BitArray> subset = 0) const;
@@ -100,6 +112,37 @@ namespace ngla
   };
 
 
+
+  /*
+    Coarse solver without a single master rank: the ranks are split
+    into groups, the leader of each group gathers the contributions
+    of its group (MPI_Gatherv), the leaders exchange them and every
+    leader holds a redundant factorization of the whole matrix. 
+    The solution is returned to the group by MPI_Scatterv.
+   */
+  template <typename TM>
+  class AgglomeratedInverse : public BaseMatrix
+  {
+    shared_ptr<BaseMatrix> inv;     // only on group leaders
+    MPI_Comm group_comm, leader_comm;
+    Array<int> select;              // local dofs in the subset
+    Array<int> group_glob;          // leader: global numbers of the group's dofs
+    Array<int> group_cnt, group_displ;
+    int num_glob_dofs;
+  public:
+    AgglomeratedInverse (const SparseMatrixTM<TM> & mat, shared_ptr<BitArray> asubset, 
+                         shared_ptr<ParallelDofs> apardofs, int groupsize);
+    virtual ~AgglomeratedInverse () override;
+    virtual bool IsComplex() const override { return mat_traits<TM>::IS_COMPLEX; } 
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    virtual int VHeight() const override { return paralleldofs->GetNDofLocal(); }
+    virtual int VWidth() const override { return paralleldofs->GetNDofLocal(); }
+
+    AutoVector CreateRowVector() const override;
+    AutoVector CreateColVector() const override;
+  };
+
   
   class FETI_Jump_Matrix : public BaseMatrix
   {
@@ -27,6 +27,9 @@ namespace ngla
     Array<MPI_Request> sreqs;
     Array<MPI_Request> rreqs;
 
+    /// StartCumulate posted messages, FinishCumulate has to wait for them
+    mutable bool cumulate_pending = false;
+
   public:
     ParallelBaseVector ()
     { ; }
@@ -75,6 +78,11 @@ namespace ngla
     { return local_vec; }
     
     virtual void Cumulate () const; 
+
+    /// split-phase Cumulate: post sends and receives of the interface values ...
+    void StartCumulate () const;
+    /// ... and add the received values. Interior values may be used in between.
+    void FinishCumulate () const;
     
     virtual void Distribute() const = 0;
     // { cerr << "ERROR -- Distribute called for BaseVector, is not parallel" << endl; }
@@ -195,6 +203,17 @@ namespace ngla
     virtual AutoVector CreateVector () const;
 
     virtual double L2Norm () const;
+
+    // the local kernels of S_BaseVectorPtr don't know about the parallel status
+    virtual double AddAddInnerProduct (double a, const BaseVector & x,
+                                       BaseVector & y, double b, const BaseVector & z,
+                                       const BaseVector * w)
+    { return BaseVector::AddAddInnerProduct (a, x, y, b, z, w); }
+    virtual double AddL2Norm (double a, const BaseVector & x)
+    { return BaseVector::AddL2Norm (a, x); }
+    virtual BaseVector & MultiAdd (double s, FlatArray<double> c,
+                                   FlatArray<const BaseVector*> v)
+    { return BaseVector::MultiAdd (s, c, v); }
   };
  
 
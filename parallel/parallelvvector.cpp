@@ -107,9 +107,15 @@ namespace ngla
   
 
   void ParallelBaseVector :: Cumulate () const
+  {
+    StartCumulate();
+    FinishCumulate();
+  }
+
+  void ParallelBaseVector :: StartCumulate () const
   {
 #ifdef PARALLEL
-    if (status != DISTRIBUTED) return;
+    if (status != DISTRIBUTED || cumulate_pending) return;
     
     // int ntasks = paralleldofs->GetNTasks();
     auto exprocs = paralleldofs->GetDistantProcs();
@@ -128,6 +134,20 @@ namespace ngla
     //   MPI_Startall(sreqs.Size(), &sreqs[0]);
     // }
 
+    cumulate_pending = true;
+#endif
+  }
+
+  void ParallelBaseVector :: FinishCumulate () const
+  {
+#ifdef PARALLEL
+    if (!cumulate_pending) return;
+    cumulate_pending = false;
+
+    auto exprocs = paralleldofs->GetDistantProcs();
+    int nexprocs = exprocs.Size();
+    ParallelBaseVector * constvec = const_cast<ParallelBaseVector * > (this);
+
     MyMPI_WaitAll (sreqs);
     
     // cumulate
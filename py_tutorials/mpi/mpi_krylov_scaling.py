@@ -0,0 +1,63 @@
+# Strong scaling of the Krylov space solvers, call with:
+# for np in 1 2 4 8 16; do mpirun -np $np ngspy mpi_krylov_scaling.py; done
+
+# Compares the classical CG and GMRES solvers with the pipelined CG
+# and s-step GMRES solvers, which need less global communication.
+# The problem size is fixed, only the number of ranks varies.
+
+from netgen.csg import unit_cube
+import netgen.meshing
+from ngsolve import *
+import time
+
+comm = mpi_world
+rank = comm.rank
+np = comm.size
+
+maxh = 0.05
+order = 2
+maxsteps = 500
+
+if rank==0:
+    mesh = unit_cube.GenerateMesh(maxh=maxh)
+    mesh.Save("scaling_mesh.vol")
+comm.Barrier()
+
+ngmesh = netgen.meshing.Mesh(dim=3, comm=comm)
+ngmesh.Load("scaling_mesh.vol")
+mesh = Mesh(ngmesh)
+
+V = H1(mesh, order=order, dirichlet=[1,2,3,4])
+u,v = V.TnT()
+
+a = BilinearForm (V)
+a += SymbolicBFI(grad(u)*grad(v))
+c = Preconditioner(a, type="local")
+a.Assemble()
+
+f = LinearForm (V)
+f += SymbolicLFI(32 * (y*(1-y)+x*(1-x)) * v)
+f.Assemble()
+
+gfu = GridFunction (V)
+
+solvers = [ ("CG", lambda : CGSolver(a.mat, c.mat, printrates=False, precision=1e-8, maxsteps=maxsteps)),
+            ("PipelinedCG", lambda : PipelinedCGSolver(a.mat, c.mat, printrates=False, precision=1e-8, maxsteps=maxsteps)),
+            ("GMRES", lambda : GMRESSolver(a.mat, c.mat, printrates=False, precision=1e-8, maxsteps=maxsteps)),
+            ("SStepGMRES", lambda : SStepGMRESSolver(a.mat, c.mat, printrates=False, precision=1e-8, maxsteps=maxsteps, sstep=4)) ]
+
+if rank==0:
+    print ("ndof =", V.ndofglobal)
+    print ("{:>4} {:>12} {:>6} {:>10} {:>12}".format("np", "solver", "steps", "time", "time/step"))
+
+for name, create in solvers:
+    inv = create()
+    gfu.vec[:] = 0
+    comm.Barrier()
+    ts = time.time()
+    gfu.vec.data = inv * f.vec
+    comm.Barrier()
+    te = time.time() - ts
+    steps = inv.GetSteps()
+    if rank==0:
+        print ("{:>4} {:>12} {:>6} {:>10.4f} {:>12.3e}".format(np, name, steps, te, te/max(steps,1)))
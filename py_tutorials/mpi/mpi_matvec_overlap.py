@@ -0,0 +1,65 @@
+# Overlapping communication and computation in the parallel matrix-vector
+# product, call on a single node with:
+# mpirun -np 8 ngspy mpi_matvec_overlap.py
+
+# The split-phase product posts the exchange of interface values, applies
+# the interior rows of the local matrix while the messages are in flight,
+# and finishes the interface rows afterwards.
+
+from netgen.csg import unit_cube
+import netgen.meshing
+from ngsolve import *
+import time
+
+comm = mpi_world
+rank = comm.rank
+np = comm.size
+
+maxh = 0.05
+order = 3
+nmult = 100
+
+if rank==0:
+    mesh = unit_cube.GenerateMesh(maxh=maxh)
+    mesh.Save("overlap_mesh.vol")
+comm.Barrier()
+
+ngmesh = netgen.meshing.Mesh(dim=3, comm=comm)
+ngmesh.Load("overlap_mesh.vol")
+mesh = Mesh(ngmesh)
+
+V = H1(mesh, order=order)
+u,v = V.TnT()
+
+a = BilinearForm (V)
+a += SymbolicBFI(grad(u)*grad(v)+u*v)
+a.Assemble()
+
+x = a.mat.CreateRowVector()
+y = a.mat.CreateColVector()
+yref = a.mat.CreateColVector()
+
+if rank==0:
+    print ("ndof =", V.ndofglobal, ", np =", np)
+    print ("{:>12} {:>12}".format("split_phase", "time/mult"))
+
+for split in [False, True]:
+    a.mat.split_phase = split
+    comm.Barrier()
+    ts = time.time()
+    for i in range(nmult):
+        # a distributed input vector, so every product has to communicate
+        x[:] = 1
+        x.SetParallelStatus(PARALLEL_STATUS.DISTRIBUTED)
+        y.data = a.mat * x
+    comm.Barrier()
+    te = time.time() - ts
+    if rank==0:
+        print ("{:>12} {:>12.3e}".format(str(split), te/nmult))
+    if split:
+        y.data -= yref
+        err = Norm(y)
+        if rank==0:
+            print ("difference to the blocking product:", err)
+    else:
+        yref.data = y
@@ -59,6 +59,7 @@ c = Preconditioner(a, type="direct", inverse = "masterinverse") # direct solve w
 #c = Preconditioner(a, type="bddc", inverse = "mumps")   # BBDC + mumps for coarse inverse
 #c = Preconditioner(a, type="hypre")                             # BoomerAMG (use only for order 1)
 #c = Preconditioner(a, type="bddc", usehypre = True)     # BDDC + BoomerAMG for coarse matrix
+#c = Preconditioner(a, type="bddc", coarsesolver = "agglomerate", coarsegroupsize = 64)  # coarse inverse redundantly on one rank per group
 
 a.Assemble()
 
@@ -17,10 +17,11 @@ from netgen import Redraw
 from pyngcore import BitArray, TaskManager, SetNumThreads
 from .ngstd import Timers, Timer, IntRange
 from .bla import Matrix, Vector, InnerProduct, Norm
-from .la import BaseMatrix, BaseVector, BlockVector, BlockMatrix, \
+from .la import BaseMatrix, BaseVector, BlockVector, MultiVector, BlockMatrix, \
     CreateVVector, CGSolver, QMRSolver, GMRESSolver, ArnoldiSolver, \
+    PipelinedCGSolver, SStepGMRESSolver, DeflatedCGSolver, GCROSolver, \
     Projector, IdentityMatrix, Embedding, PermutationMatrix, \
-    ConstEBEMatrix, ParallelMatrix, PARALLEL_STATUS
+    ConstEBEMatrix, ParallelMatrix, PARALLEL_STATUS, SparseMatrixSELL
 from .fem import BFI, LFI, CoefficientFunction, Parameter, ET, \
     POINT, SEGM, TRIG, QUAD, TET, PRISM, PYRAMID, HEX, CELL, FACE, EDGE, \
     VERTEX, FACET, ELEMENT, sin, cos, tan, atan, acos, asin, sinh, cosh, \
@@ -1,4 +1,4 @@
-from ngsolve.la import InnerProduct
+from ngsolve.la import InnerProduct, MultiVector
 from math import sqrt
 from ngsolve import Projector, Norm, Matrix
 
@@ -9,9 +9,8 @@ except:
     pass
 
 
-def PINVIT(mata, matm, pre, num=1, maxit=20, printrates=True):
-    """preconditioned inverse iteration"""
-
+def _PINVIT_Lists(mata, matm, pre, num, maxit, printrates):
+    # vector by vector, for complex vectors which MultiVector does not support
     r = mata.CreateRowVector()
     Av = mata.CreateRowVector()
     Mv = mata.CreateRowVector()
@@ -57,3 +56,45 @@ def PINVIT(mata, matm, pre, num=1, maxit=20, printrates=True):
                 uvecs[j].data += float(evec[k,j]) * vecs[k]
 
     return lams, uvecs
+
+
+def PINVIT(mata, matm, pre, num=1, maxit=20, printrates=True):
+    """preconditioned inverse iteration"""
+
+    r = mata.CreateRowVector()
+    if r.is_complex:
+        return _PINVIT_Lists(mata, matm, pre, num, maxit, printrates)
+
+    uvecs = MultiVector(r, num)
+    vecs = MultiVector(r, 2*num)
+    Avecs = MultiVector(r, 2*num)
+    Mvecs = MultiVector(r, 2*num)
+
+    for v in uvecs:
+        r.FV().NumPy()[:] = random.rand(len(r.FV()))
+        v.data = pre * r
+
+    coefs = Matrix(2*num, num)
+    lams = num * [1]
+
+    for i in range(maxit):
+        
+        for j in range(num):
+            vecs[j].data = uvecs[j]
+            r.data = mata * vecs[j] - lams[j] * matm * vecs[j]
+            vecs[num+j].data = pre * r
+
+        mata.Mult(vecs, Avecs)
+        matm.Mult(vecs, Mvecs)
+        asmall = Avecs.InnerProduct(vecs)
+        msmall = Mvecs.InnerProduct(vecs)
+
+        ev,evec = scipy.linalg.eigh(a=asmall, b=msmall)
+        lams[:] = ev[0:num]
+        if printrates:
+            print (i, ":", lams)
+    
+        coefs.NumPy()[:] = evec[:,0:num]
+        vecs.Mult(coefs, uvecs)
+
+    return lams, uvecs
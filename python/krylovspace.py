@@ -1,6 +1,6 @@
 
 from ngsolve import Projector, Norm, TimeFunction, BaseMatrix, Preconditioner, InnerProduct, \
-    Norm, sqrt, Vector, Matrix, BaseVector, BitArray
+    Norm, sqrt, Vector, Matrix, BaseVector, BitArray, BlockVector, MultiVector
 from typing import Optional, Callable
 import logging
 
@@ -46,22 +46,29 @@ class CGSolver(BaseMatrix):
         if wdn==0:
             return u
 
+        fused = not u.is_complex
         for it in range(maxsteps):
             self.iterations = it+1
             w.data = mat * s
             wd = wdn
             as_s = s.InnerProduct(w, conjugate=conjugate)        
             alpha = wd / as_s
-            u.data += alpha * s
-            d.data += (-alpha) * w
+            if fused:
+                u.AddAddInnerProduct(alpha, s, d, -alpha, w)
+            else:
+                u.data += alpha * s
+                d.data += (-alpha) * w
 
             w.data = pre*d if pre else d
 
             wdn = w.InnerProduct(d, conjugate=conjugate)
             beta = wdn / wd
 
-            s *= beta
-            s.data += w
+            if fused:
+                s.MultiAdd(beta, [1], [w])
+            else:
+                s *= beta
+                s.data += w
 
             err = sqrt(abs(wd))
             self.errors.append(err)
@@ -571,6 +578,11 @@ printrates : bool = True
   Print norm of preconditioned residual in each step.
 """
 
+    # real problems with the standard inner product store the Krylov
+    # basis in a MultiVector and orthogonalize block-wise
+    blockortho = not innerproduct and not b.is_complex and not isinstance(b, BlockVector)
+    # a restart gets the inner product of the caller, not the default set below
+    user_innerproduct = innerproduct
     if not innerproduct:
         innerproduct = lambda x,y: y.InnerProduct(x, conjugate=True)
         norm = Norm
@@ -601,9 +613,11 @@ printrates : bool = True
     tmp.data = b - A * x
     r.data = pre * tmp
 
-    Q = []
+    if blockortho:
+        Q = MultiVector(b, min(m, restart or m)+1)
+    else:
+        Q = [b.CreateVector()]
     H = []
-    Q.append(b.CreateVector())
     r_norm = norm(r)
     if abs(r_norm) < tol:
         return x
@@ -613,14 +627,23 @@ printrates : bool = True
     beta[0] = r_norm
 
     def arnoldi(A,Q,k):
-        q = b.CreateVector()
+        q = Q[k+1] if blockortho else b.CreateVector()
         tmp.data = A * Q[k]
         q.data = pre * tmp
         h = Vector(m+1, is_complex)
         h[:] = 0
-        for i in range(k+1):
-            h[i] = innerproduct(Q[i],q)
-            q.data += (-1)* h[i] * Q[i]
+        if blockortho:
+            # classical Gram-Schmidt, repeated once for stability
+            Qk = Q[0:k+1]
+            for it in range(2):
+                hk = Qk.InnerProduct(q)
+                Qk.MultAdd(-1, hk, q)
+                for i in range(k+1):
+                    h[i] += hk[i]
+        else:
+            for i in range(k+1):
+                h[i] = innerproduct(Q[i],q)
+                q.data += (-1)* h[i] * Q[i]
         h[k+1] = norm(q)
         if abs(h[k+1]) < 1e-12:
             return h, None
@@ -665,7 +688,8 @@ printrates : bool = True
         H.append(h)
         if q is None:
             break
-        Q.append(q)
+        if not blockortho:
+            Q.append(q)
         apply_givens_rotation(h, cs, sn, k)
         beta[k+1] = -sn[k].conjugate() * beta[k]
         beta[k] = cs[k] * beta[k]
@@ -681,7 +705,7 @@ printrates : bool = True
             calcSolution(k)
             del Q
             return GMRes(A, b, freedofs=freedofs, pre=pre, x=x, maxsteps=maxsteps-restart, callback=callback,
-                         tol=tol, innerproduct=innerproduct,
+                         tol=tol, innerproduct=user_innerproduct,
                          restart=restart, startiteration=startiteration, printrates=printrates)
     calcSolution(k)
     return x
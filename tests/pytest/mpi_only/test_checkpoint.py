@@ -0,0 +1,41 @@
+from ngsolve import *
+import os
+
+def test_checkpoint_redistribute():
+    comm = MPI_Init()
+    filename = "test_checkpoint_mpi.ckpt"
+
+    mesh = Mesh('square.vol.gz', comm)
+    # vertex dofs only, global vertex numbers don't depend on the distribution
+    fes = H1(mesh, order=1)
+    u = GridFunction(fes)
+    u.Set(x+2*y)
+    u.SaveCheckpoint(filename)
+
+    # same distribution, the values are copied into the parallel vector
+    for mmap in [True, False]:
+        u2 = GridFunction(fes)
+        u2.LoadCheckpoint(filename, mmap=mmap)
+        u2.vec.data -= u.vec
+        assert Norm(u2.vec) < 1e-14
+
+    # redistribution: load on sub-communicators, and sequentially on rank 0
+    sub_comm = comm.SubComm([p for p in range(comm.size) if p % 2 == comm.rank % 2])
+    mesh2 = Mesh('square.vol.gz', sub_comm)
+    u2 = GridFunction(H1(mesh2, order=1))
+    u2.LoadCheckpoint(filename)
+    assert Integrate((u2-x-2*y)**2, mesh2) < 1e-20
+
+    if comm.rank == 0:
+        mesh3 = Mesh('square.vol.gz', comm.SubComm([0]))
+        u3 = GridFunction(H1(mesh3, order=1))
+        u3.LoadCheckpoint(filename)
+        assert Integrate((u3-x-2*y)**2, mesh3) < 1e-20
+
+    comm.Barrier()
+    if comm.rank == 0:
+        os.remove(filename)
+
+
+if __name__ == "__main__":
+    test_checkpoint_redistribute()
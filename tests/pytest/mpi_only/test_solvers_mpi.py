@@ -0,0 +1,108 @@
+from ngsolve import *
+
+def distributed_mesh(comm, maxh=0.1):
+    import netgen.meshing
+    if comm.rank==0:
+        from netgen.geom2d import unit_square
+        ngmesh = unit_square.GenerateMesh(maxh=maxh)
+        ngmesh.Distribute(comm)
+    else:
+        ngmesh = netgen.meshing.Mesh.Receive(comm)
+    return Mesh(ngmesh)
+
+def poisson(mesh):
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx + u*v*dx
+    a.Assemble()
+    f = LinearForm(fes)
+    f += x*v*dx
+    f.Assemble()
+    return fes, a, f
+
+# the fused updates of CG without preconditioner must respect the parallel status
+def test_cg_without_preconditioner():
+    comm = MPI_Init()
+    mesh = distributed_mesh(comm)
+    fes, a, f = poisson(mesh)
+
+    inv = CGSolver(a.mat, None, printrates=False, precision=1e-12, maxsteps=2000)
+    gfu = GridFunction(fes)
+    gfu.vec.data = inv * f.vec
+
+    r = f.vec.CreateVector()
+    r.data = f.vec - a.mat * gfu.vec
+    assert Norm(r) < 1e-8 * Norm(f.vec)
+    comm.Barrier()
+
+# the coarse inverse factored on group leaders solves as the inverse on rank 0
+def test_agglomerated_inverse():
+    comm = MPI_Init()
+    mesh = distributed_mesh(comm)
+    fes, a, f = poisson(mesh)
+
+    gfu = GridFunction(fes)
+    gfu.vec.data = a.mat.Inverse(fes.FreeDofs()) * f.vec
+
+    a.mat.agglomeration = 2
+    assert a.mat.agglomeration == 2
+    inv = a.mat.Inverse(fes.FreeDofs())
+    gfu2 = GridFunction(fes)
+    gfu2.vec.data = inv * f.vec
+    # a second solve reuses the group communicators
+    gfu2.vec.data = inv * f.vec
+
+    gfu2.vec.data -= gfu.vec
+    assert Norm(gfu2.vec) < 1e-10 * Norm(gfu.vec)
+    comm.Barrier()
+
+# the Chebyshev smoother takes the Jacobi diagonal from the local matrix,
+# and estimates lambda max with parallel inner products
+def test_chebyshev_smoother():
+    comm = MPI_Init()
+    mesh = distributed_mesh(comm, maxh=0.2)
+    fes = H1(mesh, order=1, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=True)
+    a += grad(u)*grad(v)*dx
+    pre = Preconditioner(a, "multigrid", smoother="chebyshev")
+    f = LinearForm(fes)
+    f += v*dx
+    gfu = GridFunction(fes)
+    for l in range(2):
+        if l > 0:
+            mesh.Refine()
+            fes.Update()
+            gfu.Update()
+        a.Assemble()
+        f.Assemble()
+        inv = CGSolver(a.mat, pre.mat, printrates=False, precision=1e-10, maxsteps=200)
+        gfu.vec.data = inv * f.vec
+        assert inv.GetSteps() < 50
+    comm.Barrier()
+
+# local matrices without MultAddRows take the regular path, not the split-phase one
+def test_parallel_matrix_dynamic():
+    comm = MPI_Init()
+    mesh = distributed_mesh(comm)
+    fes, a, f = poisson(mesh)
+
+    from ngsolve.la import SparseMatrixDynamic
+    dyn = SparseMatrixDynamic(a.mat.local_mat)
+    pmat = ParallelMatrix(dyn, a.mat.row_pardofs, a.mat.col_pardofs, ParallelMatrix.PARALLEL_OP.C2D)
+    assert pmat.split_phase
+
+    x = a.mat.CreateRowVector()
+    x.SetRandom()
+    y = a.mat.CreateColVector()
+    y.data = a.mat * x - pmat * x
+    assert Norm(y) < 1e-12 * Norm(x)
+    comm.Barrier()
+
+
+if __name__ == "__main__":
+    test_cg_without_preconditioner()
+    test_agglomerated_inverse()
+    test_chebyshev_smoother()
+    test_parallel_matrix_dynamic()
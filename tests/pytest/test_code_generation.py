@@ -81,6 +81,61 @@ def test_code_generation_derivatives(unit_mesh_3d):
         vals -= vals_ref
         assert Norm(vals) == approx(0)
 
+@pytest.mark.slow
+def test_code_generation_kernel_cache(unit_mesh_3d, tmp_path, monkeypatch):
+    monkeypatch.setenv("NGSOLVE_KERNEL_CACHE", str(tmp_path))
+    p1 = Parameter(1)
+    p2 = Parameter(2)
+    f1 = (p1*x).Compile(True, wait=True)
+    f2 = (p2*x).Compile(True, wait=True)
+
+    # one kernel for both, the parameters are passed at runtime
+    kernels = [f for f in tmp_path.glob("kernel_*") if f.suffix in (".so", ".dll")]
+    assert len(kernels) == 1
+    assert Integrate(f1, unit_mesh_3d) == approx(0.5)
+    assert Integrate(f2, unit_mesh_3d) == approx(1)
+    p1.Set(3)
+    assert Integrate(f1, unit_mesh_3d) == approx(1.5)
+
+def test_code_generation_simplify(unit_mesh_3d):
+    a = sin(x)*y
+    b = sin(x)*y
+    cf = a*b + CoefficientFunction(1)*a + (b+0) + (2*CoefficientFunction(3))*y
+    f = cf.Compile()
+
+    # the two products are merged, x*1 and x+0 drop out, 2*3 is folded
+    steps = [line.split(": ", 1)[1].split(",")[0] for line in str(f).splitlines() if line.startswith("Step")]
+    assert steps.count("unary operation 'sin'") == 1
+    assert steps.count("binary operation '*'") == 3
+    assert not any(s.startswith("scale") for s in steps)
+    assert "1" not in steps and "0" not in steps
+    assert "6" in steps
+    for g in [f, cf.Compile(True, wait=True)]:
+        assert Integrate((cf-g)*(cf-g), unit_mesh_3d) == approx(0)
+
+def test_code_generation_bytecode(unit_mesh_3d):
+    u = CoefficientFunction((x, y*y, sin(x)))
+    functions = [InnerProduct(u,u) + 2*u[1] + x*y,
+                 x*y*z/(1+x*x) - 3*z,
+                 CoefficientFunction((u[0]*u[1]+x, u[2]-y)),
+                 y*u]
+    for cf in functions:
+        f = cf.Compile()
+        g = cf.Compile(bytecode=False)
+        assert Integrate(InnerProduct(cf-f,cf-f), unit_mesh_3d) == approx(0)
+        assert Integrate(InnerProduct(f-g,f-g), unit_mesh_3d) == approx(0)
+
+@pytest.mark.slow
+def test_code_generation_async(unit_mesh_3d):
+    cf = sin(x)*y + exp(z)
+    f = cf.Compile(True, wait=False)
+    # usable while the compiler runs
+    assert Integrate((cf-f)*(cf-f), unit_mesh_3d) == approx(0)
+    assert f.WaitCompiled()
+    assert f.IsCompiled()
+    assert not cf.Compile().IsCompiled()
+    assert Integrate((cf-f)*(cf-f), unit_mesh_3d) == approx(0)
+
 if __name__ == "__main__":
     test_code_generation_derivatives()
     test_code_generation_volume_terms()
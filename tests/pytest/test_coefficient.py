@@ -69,6 +69,21 @@ def test_evaluate(unit_mesh_2d):
     assert vals2 == approx(np.array(list(zip([0.5 + 0J] * 10, pnts*1J))))
     assert x(unit_mesh_2d(0.5,0.5)) == approx(0.5)
 
+def test_voxel_coefficient(unit_mesh_3d):
+    import numpy as np
+    # values stored as [z,y,x], trilinear interpolation is exact for linear functions
+    zs, ys, xs = np.meshgrid(np.linspace(0,1,7), np.linspace(0,1,6), np.linspace(0,1,5), indexing="ij")
+    vals = xs + 2*ys + 3*zs
+    f = x + 2*y + 3*z
+    for tiled in [False, True]:
+        for v in [vals, vals.astype(np.float32)]:
+            cf = VoxelCoefficient((0,0,0), (1,1,1), v, linear=True, tiled=tiled)
+            assert Integrate((cf-f)*(cf-f), unit_mesh_3d) == approx(0, abs=1e-10)
+            assert cf(unit_mesh_3d(0.3,0.4,0.5)) == approx(0.3+0.8+1.5, abs=1e-6)
+    nearest = VoxelCoefficient((0,0,0), (1,1,1), vals, linear=False)
+    nearest_tiled = VoxelCoefficient((0,0,0), (1,1,1), vals, linear=False, tiled=True)
+    assert Integrate((nearest-nearest_tiled)**2, unit_mesh_3d) == approx(0)
+
 if __name__ == "__main__":
     test_pow()
     test_ParameterCF()
@@ -99,6 +99,34 @@ def test_SurfaceGetFE(quads=False):
                         assert space.GetFE(el).ndof == len(space.GetDofNrs(el)), [spacename,vb,order]
     return
 
+@pytest.mark.parametrize("dim", [2, 3])
+def test_h1_tensorproduct_apply(dim):
+    from ngsolve.meshes import MakeStructured3DMesh
+    if dim == 2:
+        mesh = Mesh(unit_square.GenerateMesh(maxh=0.3, quad_dominated=True))
+        order = 6
+    else:
+        mesh = MakeStructured3DMesh(hexes=True, nx=2, mapping=lambda x,y,z: (x+0.1*y*z, y, z))
+        order = 4
+
+    mats = []
+    for tp in [False, True]:
+        fes = H1(mesh, order=order, tp=tp)
+        u,v = fes.TnT()
+        a = BilinearForm(fes, nonassemble=tp)
+        a += (grad(u)*grad(v)+(1+x)*u*v)*dx
+        a.Assemble()
+        mats.append(a.mat)
+
+    x0 = mats[0].CreateRowVector()
+    x0.SetRandom()
+    y0 = mats[0].CreateColVector()
+    y0.data = mats[0] * x0
+    y1 = y0.CreateVector()
+    y1.data = mats[1] * x0
+    y1 -= y0
+    assert y1.Norm() < 1e-10 * y0.Norm()
+
 if __name__ == "__main__":
     test_2DGetFE(quads=False)
     test_2DGetFE(quads=True)
@@ -99,6 +99,194 @@ def test_sparsematrix_access():
     a.Assemble()
     assert abs(a.mat[1,1][0,0] - (reference_values[3])) < 1e-8
 
+@pytest.mark.parametrize("symmetric", [True, False])
+def test_sparsematrix_sell(symmetric):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, dim=2, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=symmetric)
+    a += (InnerProduct(grad(u),grad(v))+InnerProduct(u,v))*dx
+    a.Assemble()
+    sell = SparseMatrixSELL(a.mat, sigma=64)
+
+    x = a.mat.CreateRowVector()
+    x.SetRandom()
+    y = a.mat.CreateColVector()
+    y.data = a.mat * x - sell * x
+    assert y.Norm() < 1e-12 * x.Norm()
+    y.data = a.mat.T * x - sell.T * x
+    assert y.Norm() < 1e-12 * x.Norm()
+
+    f = a.mat.CreateColVector()
+    f[:] = 1
+    pre = a.mat.CreateSmoother(fes.FreeDofs())
+    gfu = GridFunction(fes)
+    gfu.vec.data = CGSolver(sell, pre, tol=1e-12, maxsteps=500) * f
+    ref = f.CreateVector()
+    ref.data = a.mat.Inverse(fes.FreeDofs()) * f
+    gfu.vec.data -= ref
+    assert gfu.vec.Norm() < 1e-6 * ref.Norm()
+
+@pytest.mark.parametrize("symmetric", [True, False])
+def test_galerkin_product(symmetric):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=symmetric)
+    a += (grad(u)*grad(v)+u*v)*dx
+    a.Assemble()
+
+    n = fes.ndof
+    nc = n // 3
+    indi = [i for i in range(n) for k in range(2)]
+    indj = [(i//3 + k) % nc for i in range(n) for k in range(2)]
+    vals = [1.0 if k == 0 else 0.5 for i in range(n) for k in range(2)]
+    prol = la.SparseMatrixd.CreateFromCOO(indi, indj, vals, n, nc)
+
+    cmat = a.mat.Restrict(prol)
+    assert cmat.height == nc
+
+    def check(cmat):
+        x = cmat.CreateRowVector()
+        x.SetRandom()
+        y = cmat.CreateColVector()
+        y.data = prol.T * (a.mat * (prol * x)) - cmat * x
+        assert y.Norm() < 1e-12 * (cmat * x).Norm()
+    check(cmat)
+
+    def setups():
+        return sum(t["counts"] for t in Timers() if t["name"] == "GalerkinProduct - setup")
+
+    # values change, pattern stays: numeric phase only, P^T is reused
+    n0 = setups()
+    a.mat.AsVector().data = 2 * a.mat.AsVector()
+    cmat2 = a.mat.Restrict(prol, cmat)
+    assert cmat2.nze == cmat.nze
+    assert setups() == n0
+    check(cmat2)
+
+    # the reused P^T gets the new values of P
+    prol.AsVector().data = 3 * prol.AsVector()
+    check(a.mat.Restrict(prol, cmat))
+    assert setups() == n0
+
+@pytest.mark.parametrize("symmetric", [True, False])
+def test_compressed_indices(symmetric):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    mats = []
+    for compress in [False, True]:
+        a = BilinearForm(fes, symmetric=symmetric, compress_indices=compress)
+        a += (grad(u)*grad(v)+u*v)*dx
+        a.Assemble()
+        mats.append(a)
+
+    def index_memory(a):
+        return sum(nbytes for name, nbytes, nblocks in a.__memory__ if name.startswith("MatrixGraph"))
+
+    x = mats[0].mat.CreateRowVector()
+    x.SetRandom()
+    y = mats[0].mat.CreateColVector()
+    y.data = mats[0].mat * x - mats[1].mat * x
+    assert y.Norm() < 1e-12 * x.Norm()
+
+    # the product does not bring back the 32-bit column numbers
+    mem = [index_memory(a) for a in mats]
+    print ("index memory, 32 bit / compressed:", mem)
+    assert mem[1] < 0.7 * mem[0]
+
+    # the smoother rebuilds them
+    pre = mats[1].mat.CreateSmoother()
+    assert index_memory(mats[1]) > mem[0]
+
+@pytest.mark.parametrize("symmetric", [True, False])
+def test_multivector(symmetric):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=symmetric)
+    a += (grad(u)*grad(v)+u*v)*dx
+    a.Assemble()
+
+    x = a.mat.CreateRowVector()
+    V = MultiVector(x, 11)
+    W = MultiVector(x, 3)
+    for vec in V:
+        vec.SetRandom()
+    for vec in W:
+        vec.SetRandom()
+    Vnp = np.array([vec.FV().NumPy() for vec in V])
+    Wnp = np.array([vec.FV().NumPy() for vec in W])
+
+    assert np.allclose(V.InnerProduct(W).NumPy(), Vnp @ Wnp.T)
+    assert np.allclose(V.InnerProduct(W[1]).NumPy(), Vnp @ Wnp[1])
+
+    c = Matrix(4, 3)
+    c.NumPy()[:] = np.arange(12).reshape(4,3)
+    V[2:6].Mult(c, W)
+    assert np.allclose(np.array([vec.FV().NumPy() for vec in W]), c.NumPy().T @ Vnp[2:6])
+    V[2:6].MultAdd(-1, c, W)
+    assert max(vec.Norm() for vec in W) < 1e-12 * np.linalg.norm(Vnp)
+
+    AV = MultiVector(x, 11)
+    a.mat.Mult(V, AV)
+    y = x.CreateVector()
+    for i in range(len(V)):
+        y.data = a.mat * V[i] - AV[i]
+        assert y.Norm() < 1e-12 * AV[i].Norm()
+
+@pytest.mark.parametrize("dim", [2, 3])
+@pytest.mark.parametrize("order", [1, 2])
+def test_batch_assembly(dim, order):
+    if dim == 2:
+        mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    else:
+        mesh = Mesh(unit_cube.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=order)
+    u,v = fes.TnT()
+    b = CoefficientFunction((1,)*dim)
+    mats = []
+    for batch in [False, True]:
+        a = BilinearForm(fes, batch_assembly=batch)
+        a += ((1+x*y)*grad(u)*grad(v) + (b*grad(u))*v + x*u*v)*dx
+        a.Assemble()
+        mats.append(a.mat)
+
+    vec = mats[0].CreateRowVector()
+    vec.SetRandom()
+    res = mats[0].CreateColVector()
+    res.data = mats[0] * vec - mats[1] * vec
+    assert res.Norm() < 1e-10 * (mats[0] * vec).Norm()
+
+def test_skeleton_assembly_parallel():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = L2(mesh, order=2, dgjumps=True)
+    u,v = fes.TnT()
+    n = specialcf.normal(2)
+    jump_u = u-u.Other()
+    jump_v = v-v.Other()
+    mean_dudn = 0.5*n * (grad(u)+grad(u.Other()))
+    mean_dvdn = 0.5*n * (grad(v)+grad(v.Other()))
+    mats = []
+    for parallel in [False, True]:
+        a = BilinearForm(fes)
+        a += grad(u)*grad(v)*dx
+        a += (10*jump_u*jump_v - mean_dudn*jump_v - mean_dvdn*jump_u)*dx(element_boundary=True)
+        a += (10*u*v - n*grad(u)*v - n*grad(v)*u)*ds(skeleton=True)
+        if parallel:
+            with TaskManager():
+                a.Assemble()
+        else:
+            a.Assemble()
+        mats.append(a.mat)
+
+    vec = mats[0].CreateRowVector()
+    vec.SetRandom()
+    res = mats[0].CreateColVector()
+    res.data = mats[0] * vec - mats[1] * vec
+    assert res.Norm() < 1e-10 * (mats[0] * vec).Norm()
+
 if __name__ == "__main__":
     test_matrix()
     test_matrix_numpy()
@@ -2,6 +2,7 @@ from netgen.geom2d import *
 from netgen.csg import unit_cube
 from ngsolve import *
 import pickle
+import pytest
 import numpy
 import io
 
@@ -55,6 +56,50 @@ def test_pickle_multidim():
     assert numpy.linalg.norm(u.vec.FV().NumPy() - u2.vec.FV().NumPy()) < 1e-14
     assert Integrate(Norm(grad(u)-gradu2), mesh) < 1e-14
 
+def test_gridfunction_checkpoint(tmp_path):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = H1(mesh,order=3,dim=2,complex=True)
+    u = GridFunction(fes, multidim=2)
+    u.Set((x*y, 1j*x))
+    u.vecs[1].data = 2 * u.vecs[0]
+    filename = str(tmp_path / "u.ckpt")
+    u.SaveCheckpoint(filename)
+
+    def dist(v, v2):
+        difvec = v.CreateVector()
+        difvec.data = v - v2
+        return Norm(difvec)
+
+    for mmap in [True, False]:
+        u2 = GridFunction(fes, multidim=2)
+        u2.LoadCheckpoint(filename, mmap=mmap)
+        for v, v2 in zip(u.vecs, u2.vecs):
+            assert dist(v, v2) < 1e-14
+        # changing the loaded vector must not change the file
+        u2.vec[:] = 0
+
+    u3 = GridFunction(fes, multidim=2)
+    u3.LoadCheckpoint(filename)
+    assert dist(u.vec, u3.vec) < 1e-14
+
+    # save over the file the loaded vectors are mapped from
+    u3.vecs[1].data = 3 * u3.vecs[0]
+    u3.SaveCheckpoint(filename)
+    assert dist(u.vec, u3.vec) < 1e-14
+    u4 = GridFunction(fes, multidim=2)
+    u4.LoadCheckpoint(filename)
+    for v, v2 in zip(u3.vecs, u4.vecs):
+        assert dist(v, v2) < 1e-14
+
+    # a truncated file is rejected, not read beyond its end
+    truncated = str(tmp_path / "truncated.ckpt")
+    with open(filename, "rb") as f, open(truncated, "wb") as f2:
+        data = f.read()
+        f2.write(data[:len(data)//2])
+    for mmap in [True, False]:
+        with pytest.raises(Exception):
+            u4.LoadCheckpoint(truncated, mmap=mmap)
+
 def test_pickle_secondorder_mesh():
     m = unit_cube.GenerateMesh(maxh=0.4)
     m.SecondOrder()
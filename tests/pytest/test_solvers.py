@@ -53,6 +53,194 @@ def test_newton_with_dirichlet():
     dirichlet.Set(0)
     newton = solvers.Newton(a, gfu, dirichletvalues=dirichlet.vec)
 
+@pytest.mark.parametrize("inverse", ["sparsecholesky", "sparsecholesky_nd", "sparsecholesky_supernodal", "sparsecholesky_single"])
+def test_sparsecholesky(inverse):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=4, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=True)
+    a += (grad(u)*grad(v)+u*v)*dx
+    a.Assemble()
+
+    x = a.mat.CreateColVector()
+    x[:] = 1
+    for i, free in enumerate(fes.FreeDofs()):
+        if not free: x[i] = 0
+    f = x.CreateVector()
+    f.data = a.mat * x
+
+    inv = a.mat.Inverse(fes.FreeDofs(), inverse=inverse)
+    y = x.CreateVector()
+    y.data = inv * f
+    y -= x
+    assert y.Norm() < 1e-10 * x.Norm()
+
+def test_sparsecholesky_reuse_analysis():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=True)
+    a += (grad(u)*grad(v)+(1+x)*u*v)*dx
+    a.Assemble()
+
+    def reused():
+        return sum(t["counts"] for t in Timers() if t["name"] == "SparseCholesky - analysis reused")
+
+    n0 = reused()
+    inv1 = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky_nd")
+    a.mat.AsVector().data *= 2
+    inv2 = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky_nd")
+    assert reused() == n0+1
+
+    f = a.mat.CreateColVector()
+    f[:] = 1
+    y1 = f.CreateVector()
+    y1.data = inv1 * f
+    y2 = f.CreateVector()
+    y2.data = inv2 * f
+    y1.data -= 2 * y2
+    assert y1.Norm() < 1e-10 * y2.Norm()
+
+@pytest.mark.parametrize("inverse", ["sparsecholesky", "sparsecholesky_supernodal", "sparsecholesky_single"])
+def test_multmulti(inverse):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, dirichlet="left|bottom")
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=True)
+    a += (grad(u)*grad(v)+u*v)*dx
+    a.Assemble()
+    inv = a.mat.Inverse(fes.FreeDofs(), inverse=inverse)
+
+    gfu = GridFunction(fes)
+    fs = []
+    for k in range(5):
+        gfu.Set(x**k+y)
+        f = gfu.vec.CreateVector()
+        f.data = a.mat * gfu.vec
+        fs.append(f)
+    us = [f.CreateVector() for f in fs]
+    inv.MultMulti(fs, us)
+
+    # refinement may stop at a different step for the block solve
+    tol = 1e-8 if inverse == "sparsecholesky_single" else 1e-12
+    for f,u in zip(fs, us):
+        ref = f.CreateVector()
+        ref.data = inv * f
+        ref -= u
+        assert ref.Norm() < tol * f.Norm()
+
+@pytest.mark.parametrize("solver", ["pipelinedcg", "sstepgmres"])
+def test_communication_hiding_krylov(solver):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=True)
+    a += (grad(u)*grad(v)+u*v)*dx
+    a.Assemble()
+    f = LinearForm(fes)
+    f += (1+x)*v*dx
+    f.Assemble()
+
+    pre = a.mat.CreateSmoother()
+    if solver == "pipelinedcg":
+        inv = PipelinedCGSolver(a.mat, pre, printrates=False, precision=1e-12, maxsteps=1000)
+    else:
+        inv = SStepGMRESSolver(a.mat, pre, printrates=False, precision=1e-12, maxsteps=400, sstep=4)
+    gfu = GridFunction(fes)
+    gfu.vec.data = inv * f.vec
+
+    ref = gfu.vec.CreateVector()
+    ref.data = a.mat.Inverse(inverse="sparsecholesky") * f.vec
+    ref -= gfu.vec
+    assert inv.GetSteps() > 0
+    assert ref.Norm() < 1e-8 * gfu.vec.Norm()
+
+@pytest.mark.parametrize("solver", ["deflatedcg", "gcro"])
+def test_recycling_krylov(solver):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, dirichlet=".*")
+    u,v = fes.TnT()
+    a0 = BilinearForm(fes, symmetric=True)
+    a0 += grad(u)*grad(v)*dx
+    a0.Assemble()
+    m = BilinearForm(fes, symmetric=True)
+    m += u*v*dx
+    m.Assemble()
+    a = BilinearForm(fes, symmetric=True)
+    a += grad(u)*grad(v)*dx
+    a.Assemble()
+    f = LinearForm(fes)
+    f += (1+x)*v*dx
+    f.Assemble()
+
+    pre = Projector(fes.FreeDofs(), True)
+    if solver == "deflatedcg":
+        inv = DeflatedCGSolver(a.mat, pre, printrates=False, precision=1e-10, maxsteps=1000, nrecycle=10)
+    else:
+        inv = GCROSolver(a.mat, pre, printrates=False, precision=1e-10, maxsteps=1000, restart=30, nrecycle=10)
+
+    # slowly changing matrix, same object
+    gfu = GridFunction(fes)
+    steps = []
+    for i in range(4):
+        a.mat.AsVector().data = a0.mat.AsVector() + (0.1*i) * m.mat.AsVector()
+        gfu.vec.data = inv * f.vec
+        steps.append(inv.GetSteps())
+        ref = gfu.vec.CreateVector()
+        ref.data = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky") * f.vec
+        ref -= gfu.vec
+        assert ref.Norm() < 1e-6 * gfu.vec.Norm()
+    assert inv.nrecycled > 0
+    assert steps[-1] < steps[0]
+
+@pytest.mark.parametrize("precond", ["multigrid", "h1amg"])
+def test_chebyshev_smoother(precond):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=1, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(fes, symmetric=True)
+    a += grad(u)*grad(v)*dx
+    pre = Preconditioner(a, precond, smoother="chebyshev")
+    f = LinearForm(fes)
+    f += v*dx
+    gfu = GridFunction(fes)
+    for l in range(3):
+        if l > 0:
+            mesh.Refine()
+            fes.Update()
+            gfu.Update()
+        a.Assemble()
+        f.Assemble()
+        inv = CGSolver(a.mat, pre.mat, printrates=False, precision=1e-10, maxsteps=200)
+        gfu.vec.data = inv * f.vec
+        assert inv.GetSteps() < 50
+
+def test_elasticity_amg():
+    from netgen.csg import unit_cube
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.15))
+    fes = VectorH1(mesh, order=1, dirichlet="left")
+    u,v = fes.TnT()
+    E, nu = 210, 0.2
+    mu = E / 2 / (1+nu)
+    lam = E * nu / ((1+nu)*(1-2*nu))
+    def Stress(strain):
+        return 2*mu*strain + lam*Trace(strain)*Id(3)
+    a = BilinearForm(fes, symmetric=True)
+    a += InnerProduct(Stress(Sym(Grad(u))), Sym(Grad(v)))*dx
+    pre = Preconditioner(a, "elasticityamg")
+    a.Assemble()
+    f = LinearForm(fes)
+    f += CoefficientFunction((0,0,-1))*v*dx
+    f.Assemble()
+
+    gfu = GridFunction(fes)
+    inv = CGSolver(a.mat, pre.mat, printrates=False, precision=1e-8, maxsteps=200)
+    gfu.vec.data = inv * f.vec
+    ref = gfu.vec.CreateVector()
+    ref.data = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky") * f.vec
+    ref -= gfu.vec
+    assert inv.GetSteps() < 100
+    assert ref.Norm() < 1e-6 * gfu.vec.Norm()
 
 if __name__ == "__main__":
     test_arnoldi()
@@ -40,3 +40,29 @@ def test_vector_numpy():
     assert d[0] == c[0]
     d[1] = 1+3j
     assert d[1] == c[1]
+
+def test_fused_vector_updates():
+    n = 5000
+    x,y,z,w,v = [BaseVector(n) for i in range(5)]
+    for vec in (x,y,z,w,v):
+        vec.SetRandom()
+    x0 = x.CreateVector(); x0.data = x
+    y0 = y.CreateVector(); y0.data = y
+
+    ip = x.AddAddInnerProduct(2, z, y, -3, w, v)
+    x0.data += 2*z
+    y0.data += -3*w
+    assert abs(ip - InnerProduct(y0, v)) < 1e-10 * abs(ip)
+    x0.data -= x
+    y0.data -= y
+    assert x0.Norm() < 1e-12 and y0.Norm() < 1e-12
+
+    x0.data = x
+    nrm = x.AddL2Norm(0.5, z)
+    x0.data += 0.5*z
+    assert abs(nrm - x0.Norm()) < 1e-10 * nrm
+
+    x0.data = 2*x + 3*z - w
+    x.MultiAdd(2, [3, -1], [z, w])
+    x0.data -= x
+    assert x0.Norm() < 1e-12
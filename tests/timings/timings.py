@@ -5,6 +5,7 @@ import multiprocessing
 from ngsolve import *
 import json
 import os
+import time
 ngsglobals.msg_level=0
 
 import argparse
@@ -45,6 +46,8 @@ else:
     timings = results["timings"]
     timings["FESpace"] = []
     timings["Element"] = []
+    timings["SparseCholesky"] = []
+    timings["Assembly"] = []
 
 
 # test fespaces
@@ -81,6 +84,83 @@ for mesh in meshes:
                     timings["FESpace"].append(tim)
 
 
+# compare the sparse direct solvers
+inverses = ["sparsecholesky", "sparsecholesky_nd", "sparsecholesky_supernodal", "sparsecholesky_single"]
+
+def TimeInverse(mat, freedofs, inverse):
+    start = time.time()
+    inv = mat.Inverse(freedofs, inverse=inverse)
+    return time.time()-start
+
+for mesh in meshes:
+    for order in orders:
+        fes = H1(mesh, order=order, dirichlet=".*")
+        u,v = fes.TnT()
+        a = BilinearForm(fes, symmetric=True)
+        a += grad(u)*grad(v)*dx
+        a.Assemble()
+        for inverse in inverses:
+            tim = {}
+            tim['dimension'] = mesh.dim
+            tim['order'] = order
+            tim['ndof'] = fes.ndof
+            tim['name'] = inverse
+            if args.sequential:
+                tim['time'] = TimeInverse(a.mat, fes.FreeDofs(), inverse)
+                tim['taskmanager'] = 0
+                tim['nthreads'] = 1
+                timings.setdefault("SparseCholesky", []).append(dict(tim))
+            if args.parallel:
+                with TaskManager():
+                    tim['time'] = TimeInverse(a.mat, fes.FreeDofs(), inverse)
+                tim['taskmanager'] = 1
+                tim['nthreads'] = ngsglobals.numthreads
+                timings.setdefault("SparseCholesky", []).append(dict(tim))
+
+
+# thread scaling of coloring and skeleton assembly
+def TimeAssembly(mesh, order):
+    fes = L2(mesh, order=order, dgjumps=True)
+    u,v = fes.TnT()
+    n = specialcf.normal(mesh.dim)
+    h = specialcf.mesh_size
+    jump_u = u-u.Other()
+    jump_v = v-v.Other()
+    mean_dudn = 0.5*n * (grad(u)+grad(u.Other()))
+    mean_dvdn = 0.5*n * (grad(v)+grad(v.Other()))
+    a = BilinearForm(fes)
+    a += grad(u)*grad(v)*dx
+    a += (10*order**2/h*jump_u*jump_v - mean_dudn*jump_v - mean_dvdn*jump_u)*dx(element_boundary=True)
+    a += (10*order**2/h*u*v - n*grad(u)*v - n*grad(v)*u)*ds(skeleton=True)
+    start = time.time()
+    fes.Update()
+    tcol = time.time()-start
+    start = time.time()
+    a.Assemble()
+    return tcol, time.time()-start
+
+if args.parallel:
+    nthreads = [1]
+    while 2*nthreads[-1] <= multiprocessing.cpu_count():
+        nthreads.append(2*nthreads[-1])
+    for mesh in meshes:
+        for order in orders:
+            for nt in nthreads:
+                SetNumThreads(nt)
+                with TaskManager():
+                    tcol, tass = TimeAssembly(mesh, order)
+                for name, t in [("coloring", tcol), ("assemble skeleton", tass)]:
+                    tim = {}
+                    tim['dimension'] = mesh.dim
+                    tim['order'] = order
+                    tim['name'] = name
+                    tim['time'] = t
+                    tim['taskmanager'] = 1
+                    tim['nthreads'] = nt
+                    timings.setdefault("Assembly", []).append(tim)
+    SetNumThreads(multiprocessing.cpu_count())
+
+
 orders = [1,2,4,8]
 mesh2 = Mesh(unit_square.GenerateMesh(maxh=3))
 mesh3 = Mesh(unit_cube.GenerateMesh(maxh=1))